@@ -0,0 +1,301 @@
+#include "alert_queue.h"
+
+#include <stdio.h>
+#include <string.h>
+#include <time.h>
+
+#include "diagnostics.h"
+#include "monitor_config.h"
+#include "monitor_hal.h"
+#include "text_util.h"
+#include "uptime_stats.h"
+#include "web_log.h"
+
+struct QueuedAlert {
+    uint32_t sequence;
+    uint32_t url_key;     // hashString(weburl) when queued: a reused slot is not alerted
+    uint32_t millis;      // hal_millis() when queued; 0 once reloaded after a reboot
+    uint16_t target;
+    uint8_t kind;         // AlertKind (0/1: the bool "online" of older files)
+    uint8_t channels;     // AlertChannel bits still owed
+    char event_time[20];  // Local time of the transition ("" = clock not set)
+    char message[NOTIFICATION_MESSAGE_SIZE];  // Plain text, escaped per channel on replay
+};
+
+// /alerts.q: this header, then `count` entries oldest first
+const uint32_t ALERT_QUEUE_MAGIC = 0x41515531;  // "AQU1"
+struct AlertQueueHeader {
+    uint32_t magic;
+    uint32_t next_sequence;
+    uint8_t count;
+    uint8_t reserved[3];
+};
+
+static QueuedAlert entries[ALERT_QUEUE_CAPACITY];
+static uint8_t count = 0;
+static uint32_t nextSequence = 1;
+
+static unsigned long retryAt = 0;  // hal_millis() before which nothing is replayed
+static uint32_t backoffMs = 0;
+static unsigned long lastReplay = 0;
+static bool wasConnected = false;
+static int lastStatus = 0;
+static bool saveDue = false;           // Entries changed since /alerts.q was written
+static unsigned long changedAt = 0;    // hal_millis() of the first of those changes
+static uint32_t deferredSequence[ALERT_CHANNEL_COUNT];  // Last alert counted as paced, per channel
+
+static uint32_t alertsQueued = 0;
+static uint32_t alertsDelivered = 0;
+static uint32_t channelsSuperseded = 0;
+static uint32_t channelsRejected = 0;
+static uint32_t alertsDropped = 0;
+
+static void saveQueue() {
+    if (count == 0) {
+        hal_fs_remove("/alerts.q");
+        return;
+    }
+    HalFile* file = hal_fs_open("/alerts.q", "w");
+    if (!file) {
+        web_log_printf("[Alert queue] Cannot write /alerts.q");
+        return;
+    }
+    AlertQueueHeader header = {ALERT_QUEUE_MAGIC, nextSequence, count, {0, 0, 0}};
+    hal_fs_write(file, &header, sizeof(header));
+    hal_fs_write(file, entries, count * sizeof(QueuedAlert));
+    hal_fs_close(file);
+}
+
+// Written by alertQueuePoll() once ALERT_QUEUE_SAVE_DELAY_MS have passed,
+// together with whatever else changes meanwhile
+static void queueChanged() {
+    if (saveDue) return;
+    saveDue = true;
+    changedAt = hal_millis();
+}
+
+void alertQueueFlush() {
+    if (!saveDue) return;
+    saveDue = false;
+    saveQueue();
+}
+
+static void removeEntry(int k) {
+    memmove(&entries[k], &entries[k + 1], (count - k - 1) * sizeof(QueuedAlert));
+    count--;
+}
+
+void alertQueueBegin() {
+    HalFile* file = hal_fs_open("/alerts.q", "r");
+    if (!file) return;
+    AlertQueueHeader header;
+    bool valid = hal_fs_read(file, &header, sizeof(header)) == sizeof(header) && header.magic == ALERT_QUEUE_MAGIC &&
+                 header.count <= ALERT_QUEUE_CAPACITY &&
+                 hal_fs_read(file, entries, header.count * sizeof(QueuedAlert)) == header.count * sizeof(QueuedAlert);
+    hal_fs_close(file);
+    if (!valid) {
+        hal_fs_remove("/alerts.q");
+        return;
+    }
+    count = header.count;
+    nextSequence = header.next_sequence;
+    for (int k = 0; k < count; k++) {
+        entries[k].millis = 0;  // hal_millis() of another boot
+        entries[k].message[sizeof(entries[k].message) - 1] = '\0';
+        entries[k].event_time[sizeof(entries[k].event_time) - 1] = '\0';
+        if (entries[k].kind >= ALERT_KIND_COUNT) entries[k].kind = ALERT_OFFLINE;
+    }
+    if (count) web_log_printf("[Alert queue] %d undelivered alert(s) from before the reboot", count);
+}
+
+void alertQueueClear() {
+    count = 0;
+    saveDue = false;
+    retryAt = 0;
+    backoffMs = 0;
+    hal_fs_remove("/alerts.q");
+}
+
+int alertQueuePending() {
+    return count;
+}
+
+static void backOff() {
+    backoffMs = backoffMs ? backoffMs * 2 : ALERT_QUEUE_RETRY_MS;
+    if (backoffMs > ALERT_QUEUE_MAX_BACKOFF_MS) backoffMs = ALERT_QUEUE_MAX_BACKOFF_MS;
+    retryAt = hal_millis() + backoffMs;
+}
+
+void alertQueuePush(int index, uint8_t kind, uint8_t channels, uint32_t retryInMs) {
+    uint32_t key = hashString(targets[index].weburl);
+
+    // Whatever an older transition of the target (availability or latency,
+    // like this one) still owes these channels is out of date now
+    for (int k = count - 1; k >= 0; k--) {
+        QueuedAlert& older = entries[k];
+        if (older.target != index || older.url_key != key || !(older.channels & channels)) continue;
+        if (alertIsLatency(older.kind) != alertIsLatency(kind)) continue;
+        for (int c = 0; c < ALERT_CHANNEL_COUNT; c++) {
+            if (older.channels & channels & (1 << c)) channelsSuperseded++;
+        }
+        older.channels &= (uint8_t)~channels;
+        if (!older.channels) removeEntry(k);
+    }
+    if (count >= ALERT_QUEUE_CAPACITY) {
+        web_log_printf("[Alert queue] Full; alert #%lu for server %d dropped", (unsigned long)entries[0].sequence,
+                       entries[0].target + 1);
+        removeEntry(0);
+        alertsDropped++;
+    }
+
+    QueuedAlert& e = entries[count++];
+    e.sequence = nextSequence++;
+    e.url_key = key;
+    e.millis = hal_millis();
+    e.target = (uint16_t)index;
+    e.kind = kind;
+    e.channels = channels;
+    char eventTime[sizeof(e.event_time)] = "";
+    struct tm timeinfo;
+    if (time(nullptr) >= UPTIME_MIN_VALID_EPOCH && hal_local_time(&timeinfo)) {
+        strftime(eventTime, sizeof(eventTime), "%Y-%m-%d %H:%M:%S", &timeinfo);
+    }
+    memcpy(e.event_time, eventTime, sizeof(eventTime));
+    // Leave room for " (<event time>)" so it survives a long template
+    size_t room = eventTime[0] ? sizeof(e.message) - sizeof(eventTime) - 3 : sizeof(e.message);
+    size_t len = renderNotificationMessage(e.message, room, index, kind, ESCAPE_NONE);
+    if (eventTime[0]) snprintf(e.message + len, sizeof(e.message) - len, " (%s)", eventTime);
+
+    alertsQueued++;
+    queueChanged();
+    if (retryInMs == ALERT_QUEUE_BACK_OFF) {
+        if (!retryAt) backOff();  // A channel just failed: give it time (a reconnect skips the wait)
+    } else if (retryInMs) {
+        // Paced by the governor: sendNotifications() already counted the deferral
+        for (int c = 0; c < ALERT_CHANNEL_COUNT; c++) {
+            if (channels & (1 << c)) deferredSequence[c] = e.sequence;
+        }
+        unsigned long at = hal_millis() + retryInMs;
+        if (!retryAt || (long)(at - retryAt) > 0) retryAt = at;
+    }
+    web_log_printf("[Server %d] %s alert #%lu queued (%d pending)", index + 1, ALERT_KIND_NAMES[kind],
+                   (unsigned long)e.sequence, count);
+}
+
+// Send the oldest message still owed on any channel that is ready
+static void replayNext() {
+    HeapScope heapScope(HEAP_NOTIFY);
+    lastReplay = hal_millis();
+    uint8_t held = 0;  // Paced channels: their later alerts wait behind the oldest
+    uint32_t wait = 0;
+    for (int k = 0; k < count; k++) {
+        QueuedAlert& e = entries[k];
+        if (e.target >= NUM_TARGETS || hashString(targets[e.target].weburl) != e.url_key) {
+            web_log_printf("[Alert queue] Server %d was replaced; alert #%lu dropped", e.target + 1, (unsigned long)e.sequence);
+            alertsDropped++;
+            removeEntry(k);
+            queueChanged();
+            return;
+        }
+        bool online = alertIsRecovery(e.kind);
+        for (int c = 0; c < ALERT_CHANNEL_COUNT; c++) {
+            uint8_t bit = (uint8_t)(1 << c);
+            if (!(e.channels & bit) || (held & bit)) continue;
+            uint32_t paced = governorAcquire(e.target, online, c);
+            if (paced) {
+                if (deferredSequence[c] != e.sequence) {
+                    deferredSequence[c] = e.sequence;
+                    governorDeferred(e.target, online, c);
+                }
+                held |= bit;
+                if (!wait || paced < wait) wait = paced;
+                continue;
+            }
+
+            int code = sendAlertChannel(e.target, e.kind, c, e.message);
+            heapScope.sample();
+            lastStatus = code;
+            if (code == 429) {
+                // The governor now holds the endpoint; the other channels go on
+                web_log_printf("[Alert queue] %s answered 429; alert #%lu waits %lus", ALERT_CHANNEL_NAMES[c],
+                               (unsigned long)e.sequence, (unsigned long)(governorWait(e.target, online, c) / 1000));
+                return;
+            }
+            if (alertShouldRetry(code)) {
+                backOff();
+                web_log_printf("[Alert queue] %s answered %d; retrying alert #%lu in %lus", ALERT_CHANNEL_NAMES[c], code,
+                               (unsigned long)e.sequence, (unsigned long)(backoffMs / 1000));
+                return;
+            }
+            if (code >= 400) {
+                channelsRejected++;
+                web_log_printf("[Alert queue] %s refused alert #%lu (%d); dropped", ALERT_CHANNEL_NAMES[c],
+                               (unsigned long)e.sequence, code);
+            }
+            e.channels &= (uint8_t)~bit;
+            if (!e.channels) {
+                alertsDelivered++;
+                removeEntry(k);
+            }
+            queueChanged();
+            backoffMs = 0;
+            retryAt = 0;
+            if (count == 0) web_log_printf("[Alert queue] All queued alerts delivered");
+            return;
+        }
+    }
+    // Every owed channel is paced: come back when the first endpoint frees up
+    if (wait) retryAt = hal_millis() + wait;
+}
+
+void alertQueuePoll() {
+    if (saveDue && hal_millis() - changedAt >= ALERT_QUEUE_SAVE_DELAY_MS) alertQueueFlush();
+    bool connected = hal_network_connected();
+    if (connected && !wasConnected) {
+        retryAt = 0;  // Back online: replay right away
+        backoffMs = 0;
+    }
+    wasConnected = connected;
+    if (count == 0 || !connected) return;
+    if (retryAt && (long)(hal_millis() - retryAt) < 0) return;
+    if (hal_millis() - lastReplay < ALERT_QUEUE_REPLAY_SPACING_MS) return;
+    replayNext();
+}
+
+// --- Status ---
+
+void buildAlertQueueJson(JsonObject root) {
+    root["pending"] = count;
+    root["capacity"] = ALERT_QUEUE_CAPACITY;
+    root["last_status"] = lastStatus;
+    long wait = retryAt ? (long)(retryAt - hal_millis()) : 0;
+    root["retry_in_seconds"] = wait > 0 ? wait / 1000 : 0;
+
+    JsonObject counters = root.createNestedObject("counters");
+    counters["queued"] = alertsQueued;
+    counters["delivered"] = alertsDelivered;
+    counters["superseded"] = channelsSuperseded;
+    counters["rejected"] = channelsRejected;
+    counters["dropped"] = alertsDropped;
+
+    buildGovernorJson(root.createNestedObject("governor"));
+
+    JsonArray list = root.createNestedArray("alerts");
+    for (int k = 0; k < count; k++) {
+        const QueuedAlert& e = entries[k];
+        JsonObject obj = list.createNestedObject();
+        obj["sequence"] = e.sequence;
+        obj["id"] = e.target;
+        obj["kind"] = ALERT_KIND_NAMES[e.kind];
+        obj["online"] = e.kind == ALERT_ONLINE;
+        if (e.event_time[0]) obj["event_time"] = (char*)e.event_time;
+        else obj["event_time"] = nullptr;
+        if (e.millis) obj["age_seconds"] = (hal_millis() - e.millis) / 1000;
+        else obj["age_seconds"] = nullptr;
+        JsonArray channels = obj.createNestedArray("channels");
+        for (int c = 0; c < ALERT_CHANNEL_COUNT; c++) {
+            if (e.channels & (1 << c)) channels.add(ALERT_CHANNEL_NAMES[c]);
+        }
+        obj["message"] = (char*)e.message;
+    }
+}
@@ -0,0 +1,64 @@
+#pragma once
+
+#include <stdint.h>
+#include <ArduinoJson.h>
+
+#include "notifications.h"
+#include "notify_governor.h"
+
+// --- Store-and-forward alert queue ---
+// An alert that cannot be delivered (WiFi down, channel unreachable or
+// answering 408/429/5xx) is kept here, one entry per transition with a bit
+// per channel still owed, and mirrored to /alerts.q so it survives a reboot.
+// The message is rendered when the transition happens, with the event time
+// appended, so a replay minutes later still says when it happened.
+//
+// Once the network is back the queue is replayed oldest first, one message
+// per ALERT_QUEUE_REPLAY_SPACING_MS. A channel whose oldest owed alert is
+// paced by the rate governor (notify_governor.h) is skipped until its
+// endpoint accepts again, with its later alerts behind it, while the other
+// channels carry on; a failure backs the whole replay off. Alerts never
+// overtake each other on a channel. A channel's bit is cleared as soon as it
+// is delivered. The file is rewritten at most once per
+// ALERT_QUEUE_SAVE_DELAY_MS, so an alert and the acknowledgements of all its
+// channels usually cost one flash write, and a flapping target cannot wear
+// the flash; a reboot inside that window may repeat a delivered channel or
+// lose the newest alert.
+//
+// A newer transition of the same target supersedes the channels an older,
+// undelivered one still owes: after an outage that started and ended while
+// offline only the recovery (with its {DOWNTIME}) is sent. Latency alerts
+// only supersede latency alerts. When the queue is full the oldest entry is
+// dropped.
+
+const uint8_t ALERT_QUEUE_CAPACITY = 16;
+const uint32_t ALERT_QUEUE_REPLAY_SPACING_MS = 250;  // Endpoints are paced by the governor
+const uint32_t ALERT_QUEUE_RETRY_MS = 10000;      // First back-off after a failed replay
+const uint32_t ALERT_QUEUE_MAX_BACKOFF_MS = 300000;
+const uint32_t ALERT_QUEUE_SAVE_DELAY_MS = 2000;  // First change to /alerts.q write
+
+// Queue the alert (AlertKind) for the given channels (bits of AlertChannel).
+// The replay waits at least retryInMs; ALERT_QUEUE_BACK_OFF after a failed
+// delivery starts the exponential back-off.
+const uint32_t ALERT_QUEUE_BACK_OFF = 0xFFFFFFFF;
+void alertQueuePush(int index, uint8_t kind, uint8_t channels, uint32_t retryInMs);
+
+// Entries still owed to at least one channel
+int alertQueuePending();
+
+// Replay the oldest entry when due; called from monitorLoop() whether or not
+// the network is up (a reconnect resets the back-off)
+void alertQueuePoll();
+
+// Pick up the queue left on flash by a previous boot (after loadConfig())
+void alertQueueBegin();
+
+// Write a change not saved yet to /alerts.q now (before a restart)
+void alertQueueFlush();
+
+// Forget every queued alert and delete /alerts.q (resetToDefault())
+void alertQueueClear();
+
+// GET /api/alerts/queue
+void buildAlertQueueJson(JsonObject root);
+const size_t ALERT_QUEUE_JSON_CAPACITY = 1024 + 512UL * ALERT_QUEUE_CAPACITY + GOVERNOR_JSON_CAPACITY;
@@ -0,0 +1,68 @@
+#include "api_encoding.h"
+
+#include <ctype.h>
+
+struct MediaType {
+    const char* name;
+    ApiFormat format;
+};
+
+static const MediaType MEDIA_TYPES[] = {
+    {"application/json", API_FORMAT_JSON},
+    {"application/cbor", API_FORMAT_CBOR},
+    {"application/msgpack", API_FORMAT_MSGPACK},
+    {"application/x-msgpack", API_FORMAT_MSGPACK},
+    {"application/vnd.msgpack", API_FORMAT_MSGPACK},
+};
+
+static bool equalsIgnoreCase(const char* a, size_t len, const char* b) {
+    if (strlen(b) != len) return false;
+    for (size_t k = 0; k < len; k++) {
+        if (tolower((unsigned char)a[k]) != b[k]) return false;
+    }
+    return true;
+}
+
+ApiFormat negotiateApiFormat(const char* accept, const char* formatParam) {
+    if (formatParam) {
+        if (strcmp(formatParam, "cbor") == 0) return API_FORMAT_CBOR;
+        if (strcmp(formatParam, "msgpack") == 0) return API_FORMAT_MSGPACK;
+        return API_FORMAT_JSON;
+    }
+    // "application/cbor, application/json;q=0.5"
+    for (const char* p = accept; p && *p; ) {
+        while (*p == ' ' || *p == ',') p++;
+        size_t len = strcspn(p, ",;");
+        while (len > 0 && p[len - 1] == ' ') len--;
+        for (size_t m = 0; m < sizeof(MEDIA_TYPES) / sizeof(MEDIA_TYPES[0]); m++) {
+            if (equalsIgnoreCase(p, len, MEDIA_TYPES[m].name)) return MEDIA_TYPES[m].format;
+        }
+        p += strcspn(p, ",");
+    }
+    return API_FORMAT_JSON;
+}
+
+const char* apiFormatContentType(ApiFormat format) {
+    switch (format) {
+        case API_FORMAT_CBOR: return "application/cbor";
+        case API_FORMAT_MSGPACK: return "application/msgpack";
+        default: return "application/json";
+    }
+}
+
+// Counts bytes without storing them
+struct CountingWriter {
+    size_t write(uint8_t) { return 1; }
+    size_t write(const uint8_t*, size_t n) { return n; }
+};
+
+size_t measureApiDocument(JsonVariantConst root, ApiFormat format) {
+    switch (format) {
+        case API_FORMAT_CBOR: {
+            CountingWriter counter;
+            return serializeCbor(root, counter);
+        }
+        case API_FORMAT_MSGPACK: return measureMsgPack(root);
+        default: return measureJson(root);
+    }
+}
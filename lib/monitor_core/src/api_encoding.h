@@ -0,0 +1,123 @@
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+#include <ArduinoJson.h>
+
+// --- Binary encodings for the JSON API ---
+// Machine clients can ask for CBOR (RFC 8949) or MessagePack instead of JSON
+// text with an Accept header (or ?format=cbor / ?format=msgpack). The
+// document the endpoint builds is the same; only the last step differs, so
+// the schema is identical in every format. Binary encoding skips number
+// formatting and string escaping, and keys, small integers and floats take
+// a few bytes instead of their decimal text.
+
+enum ApiFormat {
+    API_FORMAT_JSON,
+    API_FORMAT_CBOR,
+    API_FORMAT_MSGPACK
+};
+
+// ?format= wins over Accept (either may be nullptr). Within Accept the first
+// supported media type listed is used; q-values are not weighed.
+ApiFormat negotiateApiFormat(const char* accept, const char* formatParam);
+
+const char* apiFormatContentType(ApiFormat format);
+
+// Encoded size of the document, for Content-Length
+size_t measureApiDocument(JsonVariantConst root, ApiFormat format);
+
+// --- CBOR ---
+// Writer needs write(uint8_t) and write(const uint8_t*, size_t), like the
+// ArduinoJson writers. Integers use the shortest head, floats are written as
+// single precision when that is lossless.
+
+template <typename Writer>
+size_t cborWriteHead(Writer& out, uint8_t major, uint64_t value) {
+    uint8_t buf[9];
+    size_t len;
+    if (value < 24) {
+        buf[0] = (uint8_t)(major << 5 | value);
+        len = 1;
+    } else {
+        int bytes = value <= 0xFF ? 1 : value <= 0xFFFF ? 2 : value <= 0xFFFFFFFFUL ? 4 : 8;
+        buf[0] = (uint8_t)(major << 5 | (bytes == 1 ? 24 : bytes == 2 ? 25 : bytes == 4 ? 26 : 27));
+        for (int k = 0; k < bytes; k++) buf[1 + k] = (uint8_t)(value >> (8 * (bytes - 1 - k)));
+        len = 1 + bytes;
+    }
+    out.write(buf, len);
+    return len;
+}
+
+template <typename Writer>
+size_t cborWriteFloat(Writer& out, double value) {
+    uint8_t buf[9];
+    float single = (float)value;
+    size_t len;
+    if ((double)single == value || value != value) {
+        uint32_t bits;
+        memcpy(&bits, &single, sizeof(bits));
+        buf[0] = 0xFA;
+        for (int k = 0; k < 4; k++) buf[1 + k] = (uint8_t)(bits >> (24 - 8 * k));
+        len = 5;
+    } else {
+        uint64_t bits;
+        memcpy(&bits, &value, sizeof(bits));
+        buf[0] = 0xFB;
+        for (int k = 0; k < 8; k++) buf[1 + k] = (uint8_t)(bits >> (56 - 8 * k));
+        len = 9;
+    }
+    out.write(buf, len);
+    return len;
+}
+
+template <typename Writer>
+size_t cborWriteString(Writer& out, const char* s) {
+    size_t len = strlen(s);
+    size_t n = cborWriteHead(out, 3, len);
+    out.write((const uint8_t*)s, len);
+    return n + len;
+}
+
+template <typename Writer>
+size_t serializeCbor(JsonVariantConst value, Writer& out) {
+    if (value.is<JsonObjectConst>()) {
+        JsonObjectConst obj = value.as<JsonObjectConst>();
+        size_t n = cborWriteHead(out, 5, obj.size());
+        for (JsonPairConst kv : obj) {
+            n += cborWriteString(out, kv.key().c_str());
+            n += serializeCbor(kv.value(), out);
+        }
+        return n;
+    }
+    if (value.is<JsonArrayConst>()) {
+        JsonArrayConst arr = value.as<JsonArrayConst>();
+        size_t n = cborWriteHead(out, 4, arr.size());
+        for (JsonVariantConst item : arr) n += serializeCbor(item, out);
+        return n;
+    }
+    if (value.is<const char*>()) return cborWriteString(out, value.as<const char*>());
+    if (value.is<bool>()) {
+        out.write((uint8_t)(value.as<bool>() ? 0xF5 : 0xF4));
+        return 1;
+    }
+    if (value.is<long>()) {
+        long v = value.as<long>();
+        return v < 0 ? cborWriteHead(out, 1, (uint64_t)(-1 - v)) : cborWriteHead(out, 0, (uint64_t)v);
+    }
+    if (value.is<unsigned long>()) return cborWriteHead(out, 0, value.as<unsigned long>());
+    if (value.is<double>()) return cborWriteFloat(out, value.as<double>());
+    out.write((uint8_t)0xF6);  // null
+    return 1;
+}
+
+// Serialize the document in the negotiated format
+template <typename Writer>
+size_t serializeApiDocument(JsonVariantConst root, ApiFormat format, Writer& out) {
+    switch (format) {
+        case API_FORMAT_CBOR: return serializeCbor(root, out);
+        case API_FORMAT_MSGPACK: return serializeMsgPack(root, out);
+        default: return serializeJson(root, out);
+    }
+}
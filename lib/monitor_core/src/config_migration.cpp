@@ -0,0 +1,38 @@
+#include "config_migration.h"
+
+typedef void (*ConfigMigration)(JsonDocument& json);
+
+// v13 -> v14: per-server retry_interval, max_check_interval and parent.
+// v13 only knew the fixed check interval and had no dependencies.
+static void migrate13To14(JsonDocument& json) {
+    JsonArray servers = json["servers"];
+    for (JsonObject server : servers) {
+        if (!server.containsKey("retry_interval")) server["retry_interval"] = DEFAULT_RETRY_INTERVAL;
+        if (!server.containsKey("max_check_interval")) server["max_check_interval"] = server["check_interval"] | 20;
+        if (!server.containsKey("parent")) server["parent"] = -1;
+    }
+}
+
+// MIGRATIONS[i] upgrades CONFIG_OLDEST_MIGRATABLE_VERSION + i by one version
+static const ConfigMigration MIGRATIONS[] = {
+    migrate13To14,
+};
+
+static_assert(sizeof(MIGRATIONS) / sizeof(MIGRATIONS[0]) == CONFIG_VERSION - CONFIG_OLDEST_MIGRATABLE_VERSION,
+              "Every CONFIG_VERSION bump needs a migration step");
+
+bool configVersionMigratable(int version) {
+    return version >= CONFIG_OLDEST_MIGRATABLE_VERSION && version <= CONFIG_VERSION;
+}
+
+const char* migrateConfig(JsonDocument& json, int fromVersion) {
+    if (fromVersion == CONFIG_VERSION) return nullptr;
+    if (fromVersion > CONFIG_VERSION) return "Written by newer firmware";
+    if (!configVersionMigratable(fromVersion)) return "No migration from this version";
+    for (int version = fromVersion; version < CONFIG_VERSION; version++) {
+        MIGRATIONS[version - CONFIG_OLDEST_MIGRATABLE_VERSION](json);
+        if (json.overflowed()) return "Config too large to migrate";
+    }
+    json["config_version"] = CONFIG_VERSION;
+    return nullptr;
+}
@@ -0,0 +1,22 @@
+#pragma once
+
+#include <ArduinoJson.h>
+
+#include "monitor_config.h"
+
+// --- Config schema migrations ---
+// A firmware that bumps CONFIG_VERSION adds one step here that rewrites the
+// previous schema into the new one. loadConfig() parses /config.json once,
+// runs every step from the file's "config_version" up to CONFIG_VERSION on
+// the parsed document, loads the targets from it and streams the result back
+// with saveConfig(), so an upgrade keeps its settings and needs no reboot.
+
+// v13 was the first LittleFS JSON schema; v12 and older kept settings in EEPROM
+const int CONFIG_OLDEST_MIGRATABLE_VERSION = 13;
+
+// True if a config written with this version can be brought up to CONFIG_VERSION
+bool configVersionMigratable(int version);
+
+// Upgrade a parsed config in place. Returns an error message or nullptr
+// (also when there was nothing to do).
+const char* migrateConfig(JsonDocument& json, int fromVersion);
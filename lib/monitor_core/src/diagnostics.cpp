@@ -0,0 +1,143 @@
+#include "diagnostics.h"
+
+#include "monitor_hal.h"
+#include "monitor_config.h"
+#include "status_snapshot.h"
+
+struct HeapAccount {
+    uint32_t calls;
+    uint32_t last_peak_bytes;
+    uint32_t max_peak_bytes;
+    int32_t last_retained_bytes;  // Free heap at entry minus free heap at exit
+    uint32_t buffer_capacity;
+    uint32_t buffer_max_used;
+};
+
+struct HeapTrendSample {
+    uint32_t uptime_seconds;
+    uint32_t free_bytes;
+    uint32_t max_alloc_bytes;
+};
+
+static const char* const HEAP_SUBSYSTEM_NAMES[HEAP_SUBSYSTEM_COUNT] = {
+    "status_json", "config", "probe", "notify", "api", "metrics_push", "ota"
+};
+static const char* const STACK_TASK_NAMES[STACK_TASK_COUNT] = {"loop", "async_tcp"};
+
+static HeapAccount heapAccounts[HEAP_SUBSYSTEM_COUNT];
+static uint32_t stackMinFree[STACK_TASK_COUNT];
+static HeapTrendSample heapTrend[HEAP_TREND_SIZE];
+static int heapTrendCount = 0;
+static int heapTrendNext = 0;
+
+// Innermost open scope per task; loop and AsyncTCP handlers run concurrently
+static __thread HeapScope* innermostScope = nullptr;
+
+static uint32_t currentFreeHeap() {
+    HalHeapStats heap;
+    hal_heap_stats(&heap);
+    return heap.free_bytes;
+}
+
+static int fragmentationPercent(uint32_t freeBytes, uint32_t maxAlloc) {
+    if (freeBytes == 0) return 0;
+    return 100 - (int)(((uint64_t)maxAlloc * 100) / freeBytes);
+}
+
+HeapScope::HeapScope(HeapSubsystem subsystem)
+    : subsystem_(subsystem), parent_(innermostScope) {
+    entryFree_ = minFree_ = currentFreeHeap();
+    innermostScope = this;
+}
+
+HeapScope::~HeapScope() {
+    sample();
+    innermostScope = parent_;
+
+    HeapAccount& account = heapAccounts[subsystem_];
+    uint32_t peak = entryFree_ > minFree_ ? entryFree_ - minFree_ : 0;
+    account.calls++;
+    account.last_peak_bytes = peak;
+    if (peak > account.max_peak_bytes) account.max_peak_bytes = peak;
+    account.last_retained_bytes = (int32_t)(entryFree_ - currentFreeHeap());
+}
+
+void HeapScope::sample() {
+    uint32_t freeBytes = currentFreeHeap();
+    if (freeBytes < minFree_) minFree_ = freeBytes;
+}
+
+void HeapScope::noteBuffer(size_t capacity, size_t used) {
+    HeapAccount& account = heapAccounts[subsystem_];
+    account.buffer_capacity = capacity;
+    if (used > account.buffer_max_used) account.buffer_max_used = used;
+}
+
+void heapScopeSample() {
+    for (HeapScope* scope = innermostScope; scope; scope = scope->parent_) scope->sample();
+}
+
+void recordStackFree(StackTask task) {
+    stackMinFree[task] = hal_stack_min_free_bytes();
+}
+
+void recordHeapTrendSample() {
+    HalHeapStats heap;
+    hal_heap_stats(&heap);
+    HeapTrendSample& s = heapTrend[heapTrendNext];
+    s.uptime_seconds = hal_millis() / 1000;
+    s.free_bytes = heap.free_bytes;
+    s.max_alloc_bytes = heap.max_alloc_bytes;
+    heapTrendNext = (heapTrendNext + 1) % HEAP_TREND_SIZE;
+    if (heapTrendCount < HEAP_TREND_SIZE) heapTrendCount++;
+}
+
+void buildDiagnosticsJson(JsonObject root) {
+    HalHeapStats heap;
+    hal_heap_stats(&heap);
+
+    root["uptime_seconds"] = hal_millis() / 1000;
+    root["num_targets"] = NUM_TARGETS;
+
+    JsonObject heapJson = root.createNestedObject("heap");
+    heapJson["free_bytes"] = heap.free_bytes;
+    heapJson["min_free_bytes"] = heap.min_free_bytes;
+    heapJson["max_alloc_bytes"] = heap.max_alloc_bytes;
+    heapJson["fragmentation_percent"] = fragmentationPercent(heap.free_bytes, heap.max_alloc_bytes);
+
+    JsonObject subsystems = root.createNestedObject("subsystems");
+    for (int i = 0; i < HEAP_SUBSYSTEM_COUNT; i++) {
+        const HeapAccount& account = heapAccounts[i];
+        JsonObject s = subsystems.createNestedObject(HEAP_SUBSYSTEM_NAMES[i]);
+        s["calls"] = account.calls;
+        s["last_peak_bytes"] = account.last_peak_bytes;
+        s["max_peak_bytes"] = account.max_peak_bytes;
+        s["last_retained_bytes"] = account.last_retained_bytes;
+        if (account.buffer_capacity > 0) {
+            s["buffer_capacity"] = account.buffer_capacity;
+            s["buffer_max_used"] = account.buffer_max_used;
+        }
+    }
+
+    JsonObject stacks = root.createNestedObject("stacks");
+    for (int i = 0; i < STACK_TASK_COUNT; i++) {
+        JsonObject s = stacks.createNestedObject(STACK_TASK_NAMES[i]);
+        s["min_free_bytes"] = stackMinFree[i];
+    }
+
+    JsonObject trend = root.createNestedObject("heap_trend");
+    trend["interval_seconds"] = 60;
+    JsonArray samples = trend.createNestedArray("samples");
+    // Oldest first
+    int start = (heapTrendNext - heapTrendCount + HEAP_TREND_SIZE) % HEAP_TREND_SIZE;
+    for (int n = 0; n < heapTrendCount; n++) {
+        const HeapTrendSample& s = heapTrend[(start + n) % HEAP_TREND_SIZE];
+        JsonObject sample = samples.createNestedObject();
+        sample["uptime_seconds"] = s.uptime_seconds;
+        sample["free_bytes"] = s.free_bytes;
+        sample["max_alloc_bytes"] = s.max_alloc_bytes;
+        sample["fragmentation_percent"] = fragmentationPercent(s.free_bytes, s.max_alloc_bytes);
+    }
+
+    buildStatusSnapshotJson(root.createNestedObject("status_snapshot"));
+}
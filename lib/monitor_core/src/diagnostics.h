@@ -0,0 +1,65 @@
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+#include <ArduinoJson.h>
+
+// --- Runtime diagnostics (/api/diagnostics) ---
+// Heap use per subsystem, task stack watermarks and a fragmentation trend,
+// so NUM_TARGETS and the JSON buffer sizes can be chosen from measurements.
+
+enum HeapSubsystem {
+    HEAP_STATUS_JSON,  // /api/status document
+    HEAP_CONFIG,       // loadConfig() / saveConfig()
+    HEAP_PROBE,        // Target checks (HTTPClient, TLS)
+    HEAP_NOTIFY,       // Discord / ntfy / Telegram / custom actions
+    HEAP_API,          // Other API handlers (server CRUD, settings)
+    HEAP_METRICS_PUSH, // Line protocol batches and backlog segments
+    HEAP_OTA,          // Pull OTA chunk buffer, manifest, HTTP stream
+    HEAP_SUBSYSTEM_COUNT
+};
+
+// Measures the heap footprint of one operation. Peak use is the drop in free
+// heap between construction and the lowest sample() taken while the scope is
+// alive; the destructor takes a final sample and updates the subsystem totals.
+// Heap figures come from the whole system, so concurrent work on the other
+// core shows up too; treat single readings as upper bounds.
+class HeapScope {
+public:
+    explicit HeapScope(HeapSubsystem subsystem);
+    ~HeapScope();
+
+    void sample();
+    // Record a fixed-capacity buffer (e.g. a JSON document) and how much of it was used
+    void noteBuffer(size_t capacity, size_t used);
+
+private:
+    friend void heapScopeSample();
+
+    HeapScope(const HeapScope&);
+    HeapScope& operator=(const HeapScope&);
+
+    HeapSubsystem subsystem_;
+    uint32_t entryFree_;
+    uint32_t minFree_;
+    HeapScope* parent_;
+};
+
+// Sample every open HeapScope of the calling task (called by the HAL at the
+// point of highest use, e.g. while a TLS session is still allocated)
+void heapScopeSample();
+
+enum StackTask {
+    STACK_LOOP,       // Arduino loop() task
+    STACK_ASYNC_TCP,  // AsyncTCP task running the web handlers
+    STACK_TASK_COUNT
+};
+
+// Record the stack high-water mark of the calling task under the given name
+void recordStackFree(StackTask task);
+
+// Append a heap sample to the fragmentation trend (monitorLoop(), every 60 s)
+const int HEAP_TREND_SIZE = 60;  // One hour of history
+void recordHeapTrendSample();
+
+void buildDiagnosticsJson(JsonObject root);
@@ -0,0 +1,483 @@
+#include "federation.h"
+
+#include <stdlib.h>
+#include <string.h>
+
+#include "monitor_hal.h"
+#include "monitor_state.h"
+#include "text_util.h"
+#include "web_log.h"
+
+FederationConfig federation = {0, FEDERATION_DEFAULT_PORT, 1, 0, {}};
+
+// Written by the API handler only while no change is pending, then handed
+// over by setting configPending; from there on only federationBegin() (loop
+// task) touches it
+static FederationConfig pendingConfig;
+static volatile bool configPending = false;
+
+// Datagram: "UMF1", sender node id, flags, entry count (big endian), then
+// per target a 32-bit URL key (big endian) and the sender's vote
+static const uint8_t PACKET_MAGIC[4] = {'U', 'M', 'F', '1'};
+const size_t PACKET_HEADER = 8;
+const size_t PACKET_ENTRY = 5;
+const size_t PACKET_MAX_ENTRIES = 200;  // 1008-byte datagrams stay under the MTU
+const uint8_t FLAG_SNAPSHOT_START = 1;  // First datagram of a full snapshot
+
+enum Vote : uint8_t {
+    VOTE_UNKNOWN = 0,  // Not monitored (or not checked yet) by that node
+    VOTE_UP = 1,
+    VOTE_DOWN = 2
+};
+
+struct Peer {
+    uint8_t node_id;  // 0 = slot unused
+    bool alive;
+    unsigned long last_heard;
+    char address[24];  // Sender of the last datagram
+    uint8_t votes[NUM_TARGETS];
+    uint8_t seen[(NUM_TARGETS + 7) / 8];  // Voted on since its current snapshot started
+};
+
+static Peer peers[FEDERATION_MAX_PEERS];
+// Each configured peer's address and port, which is also its source port
+struct PeerSource {
+    char ip[16];  // "" = not resolved
+    uint16_t port;
+};
+static PeerSource peerSources[FEDERATION_MAX_PEERS];
+static uint8_t dirty[(NUM_TARGETS + 7) / 8];  // Own verdicts changed since the last send
+static bool anyDirty = false;
+static bool socketOpen = false;
+static bool snapshotDue = false;
+static unsigned long lastHeartbeat = 0;
+static uint8_t lastQuorum = 0;  // effectiveQuorum() as last logged
+static uint32_t packetsSent = 0;
+static uint32_t packetsReceived = 0;
+static uint32_t packetsRejected = 0;
+
+static inline bool testBit(const uint8_t* bits, int i) {
+    return bits[i / 8] & (1 << (i % 8));
+}
+
+static inline void setBit(uint8_t* bits, int i) {
+    bits[i / 8] |= (uint8_t)(1 << (i % 8));
+}
+
+// FNV-1a: the same URL gives the same key on every node, whatever its slot
+static uint32_t urlKey(const char* url) {
+    return hashString(url);
+}
+
+// Same skip rule as runMonitorCycle()
+static bool isMonitored(int i) {
+    return targets[i].enabled && strcmp(targets[i].weburl, "0") != 0 && strlen(targets[i].weburl) >= 10;
+}
+
+static uint8_t ownVote(int i) {
+    if (!isMonitored(i) || last_check_time[i] == 0) return VOTE_UNKNOWN;
+    return local_down[i] ? VOTE_DOWN : VOTE_UP;
+}
+
+static const char* voteName(uint8_t vote) {
+    return vote == VOTE_DOWN ? "down" : vote == VOTE_UP ? "up" : "unknown";
+}
+
+// --- Configuration ---
+
+static void parsePeerAddress(const char* address, char* host, size_t hostSize, uint16_t* port) {
+    safeStrcpy(host, address, hostSize);
+    *port = federation.port;
+    char* colon = strrchr(host, ':');
+    if (colon) {
+        *colon = '\0';
+        *port = (uint16_t)atoi(colon + 1);
+    }
+}
+
+static bool validPeerAddress(const char* address) {
+    size_t len = strlen(address);
+    if (len == 0 || len >= sizeof(federation.peers[0])) return false;
+    const char* colon = strrchr(address, ':');
+    if (!colon) return true;
+    int port = atoi(colon + 1);
+    return colon != address && port > 0 && port <= 65535;
+}
+
+static void readConfig(FederationConfig& config, JsonObjectConst json) {
+    config.node_id = json["node_id"] | 0;
+    config.port = json["port"] | FEDERATION_DEFAULT_PORT;
+    config.peer_count = 0;
+    JsonArrayConst list = json["peers"];
+    for (JsonVariantConst peer : list) {
+        if (config.peer_count >= FEDERATION_MAX_PEERS) break;
+        safeStrcpy(config.peers[config.peer_count++], peer | "", sizeof(config.peers[0]));
+    }
+    // Default: a majority of the configured vantage points
+    config.quorum = json["quorum"] | ((config.peer_count + 1) / 2 + 1);
+}
+
+void federationConfigFromJson(JsonObjectConst json) {
+    readConfig(federation, json);
+}
+
+// A change not applied yet is what gets saved
+static const FederationConfig& savedConfig() {
+    return configPending ? pendingConfig : federation;
+}
+
+bool federationConfigured() {
+    return savedConfig().node_id != 0 || savedConfig().peer_count > 0;
+}
+
+void federationConfigToJson(JsonObject json) {
+    const FederationConfig& config = savedConfig();
+    json["node_id"] = config.node_id;
+    json["port"] = config.port;
+    json["quorum"] = config.quorum;
+    JsonArray list = json.createNestedArray("peers");
+    for (int p = 0; p < config.peer_count; p++) list.add(config.peers[p]);
+}
+
+const char* setFederationFromJson(JsonObjectConst json) {
+    if (configPending) return "Previous change not applied yet";
+    int nodeId = json["node_id"] | 0;
+    int port = json["port"] | (int)FEDERATION_DEFAULT_PORT;
+    if (nodeId < 0 || nodeId > 255) return "Invalid node_id";
+    if (port <= 0 || port > 65535) return "Invalid port";
+    JsonArrayConst list = json["peers"];
+    if (list.size() > FEDERATION_MAX_PEERS) return "Too many peers";
+    for (JsonVariantConst peer : list) {
+        if (!validPeerAddress(peer | "")) return "Invalid peer address";
+    }
+
+    FederationConfig config;
+    readConfig(config, json);
+    int quorum = json["quorum"] | (int)config.quorum;
+    if (quorum < 1 || quorum > config.peer_count + 1) return "Invalid quorum";
+
+    pendingConfig = config;
+    configPending = true;
+    return nullptr;
+}
+
+// --- Votes ---
+
+static void setVote(Peer& peer, int i, uint8_t vote) {
+    if (peer.votes[i] == vote) return;
+    peer.votes[i] = vote;
+    reevaluateTarget(i);
+}
+
+// Stop counting a peer; its down votes may have been holding targets offline
+static void forgetPeer(Peer& peer) {
+    peer.alive = false;
+    for (int i = 0; i < NUM_TARGETS; i++) setVote(peer, i, VOTE_UNKNOWN);
+}
+
+static Peer* peerSlot(uint8_t nodeId) {
+    Peer* free = nullptr;
+    for (Peer& peer : peers) {
+        if (peer.node_id == nodeId) return &peer;
+        if (!free && (peer.node_id == 0 || !peer.alive)) free = &peer;
+    }
+    if (free) {
+        memset(free, 0, sizeof(*free));
+        free->node_id = nodeId;
+    }
+    return free;
+}
+
+// The configured quorum, capped at the vantage points still alive
+static uint8_t effectiveQuorum() {
+    int alive = 1;
+    for (const Peer& peer : peers) {
+        if (peer.alive) alive++;
+    }
+    return federation.quorum < alive ? federation.quorum : (uint8_t)alive;
+}
+
+// Log a change of the effective quorum. A lower one can confirm outages the
+// dead peers were needed for, so every target is re-decided; a higher one
+// takes effect as the returning peer's votes arrive.
+static void updateQuorum() {
+    uint8_t quorum = effectiveQuorum();
+    if (quorum == lastQuorum) return;
+    bool lowered = quorum < lastQuorum;
+    lastQuorum = quorum;
+    if (quorum < federation.quorum) {
+        web_log_printf("[Federation] Only %d vantage point(s) alive; quorum lowered from %d to %d",
+            quorum, federation.quorum, quorum);
+    } else {
+        web_log_printf("[Federation] Quorum back to %d", quorum);
+    }
+    if (lowered) {
+        for (int i = 0; i < NUM_TARGETS; i++) reevaluateTarget(i);
+    }
+}
+
+bool federationTargetDown(int index, bool localDown) {
+    if (federation.node_id == 0) return localDown;
+    int down = localDown ? 1 : 0;
+    for (const Peer& peer : peers) {
+        if (peer.alive && peer.votes[index] == VOTE_DOWN) down++;
+    }
+    return down >= effectiveQuorum();
+}
+
+uint8_t federationNotifier() {
+    uint8_t lowest = federation.node_id;
+    if (lowest == 0) return 0;
+    for (const Peer& peer : peers) {
+        if (peer.alive && peer.node_id < lowest) lowest = peer.node_id;
+    }
+    return lowest;
+}
+
+bool federationIsNotifier() {
+    return federationNotifier() == federation.node_id;
+}
+
+void federationNoteLocalVerdict(int index) {
+    if (federation.node_id == 0) return;
+    setBit(dirty, index);
+    anyDirty = true;
+}
+
+// --- Transport ---
+
+static void resolvePeers() {
+    for (int p = 0; p < federation.peer_count; p++) {
+        char host[sizeof(federation.peers[0])];
+        PeerSource& source = peerSources[p];
+        parsePeerAddress(federation.peers[p], host, sizeof(host), &source.port);
+        if (!hal_resolve_ipv4(host, source.ip, sizeof(source.ip))) source.ip[0] = '\0';
+    }
+}
+
+static bool isConfiguredPeer(const char* from) {
+    for (int p = 0; p < federation.peer_count; p++) {
+        const PeerSource& source = peerSources[p];
+        size_t len = strlen(source.ip);
+        if (len && strncmp(from, source.ip, len) == 0 && from[len] == ':' && atoi(from + len + 1) == source.port) {
+            return true;
+        }
+    }
+    return false;
+}
+
+static void sendToPeers(uint8_t* packet, size_t count, uint8_t flags) {
+    memcpy(packet, PACKET_MAGIC, sizeof(PACKET_MAGIC));
+    packet[4] = federation.node_id;
+    packet[5] = flags;
+    packet[6] = (uint8_t)(count >> 8);
+    packet[7] = (uint8_t)count;
+    size_t len = PACKET_HEADER + count * PACKET_ENTRY;
+    // Names are looked up again with every snapshot, in case an address changed
+    if (flags & FLAG_SNAPSHOT_START) resolvePeers();
+    for (int p = 0; p < federation.peer_count; p++) {
+        const PeerSource& source = peerSources[p];
+        if (source.ip[0] && hal_udp_send(source.ip, source.port, packet, len)) packetsSent++;
+    }
+}
+
+// Every own verdict (snapshot) or only the changed ones, in as many
+// datagrams as needed
+static void sendVerdicts(bool snapshot) {
+    uint8_t packet[PACKET_HEADER + PACKET_ENTRY * PACKET_MAX_ENTRIES];
+    uint8_t flags = snapshot ? FLAG_SNAPSHOT_START : 0;
+    size_t count = 0;
+    for (int i = 0; i < NUM_TARGETS; i++) {
+        if (!snapshot && !testBit(dirty, i)) continue;
+        uint8_t vote = ownVote(i);
+        if (vote == VOTE_UNKNOWN) continue;
+        uint8_t* entry = packet + PACKET_HEADER + count * PACKET_ENTRY;
+        uint32_t key = urlKey(targets[i].weburl);
+        entry[0] = (uint8_t)(key >> 24);
+        entry[1] = (uint8_t)(key >> 16);
+        entry[2] = (uint8_t)(key >> 8);
+        entry[3] = (uint8_t)key;
+        entry[4] = vote;
+        if (++count == PACKET_MAX_ENTRIES) {
+            sendToPeers(packet, count, flags);
+            flags = 0;
+            count = 0;
+        }
+    }
+    // An empty snapshot still tells peers this node is alive
+    if (count > 0 || flags) sendToPeers(packet, count, flags);
+    memset(dirty, 0, sizeof(dirty));
+    anyDirty = false;
+}
+
+static void receivePacket(const uint8_t* data, size_t len, const char* from) {
+    size_t count = len >= PACKET_HEADER ? (size_t)(data[6] << 8 | data[7]) : 0;
+    uint8_t nodeId = len >= PACKET_HEADER ? data[4] : 0;
+    if (len < PACKET_HEADER + count * PACKET_ENTRY || memcmp(data, PACKET_MAGIC, sizeof(PACKET_MAGIC)) != 0 ||
+        nodeId == 0 || nodeId == federation.node_id) {
+        packetsRejected++;
+        return;
+    }
+    // Only configured peers vote, or a stray node could take over as notifier
+    if (!isConfiguredPeer(from)) {
+        packetsRejected++;
+        return;
+    }
+    Peer* peer = peerSlot(nodeId);
+    if (!peer) {
+        packetsRejected++;  // More nodes than FEDERATION_MAX_PEERS
+        return;
+    }
+    packetsReceived++;
+    if (!peer->alive) {
+        web_log_printf("[Federation] Node %d is up (%s)", nodeId, from);
+        snapshotDue = true;  // It may have missed ours while starting
+    }
+    peer->alive = true;
+    peer->last_heard = hal_millis();
+    safeStrcpy(peer->address, from, sizeof(peer->address));
+
+    if (data[5] & FLAG_SNAPSHOT_START) {
+        // Targets left out of the whole previous snapshot are no longer monitored there
+        for (int i = 0; i < NUM_TARGETS; i++) {
+            if (!testBit(peer->seen, i)) setVote(*peer, i, VOTE_UNKNOWN);
+        }
+        memset(peer->seen, 0, sizeof(peer->seen));
+    }
+
+    uint32_t keys[NUM_TARGETS];
+    for (int i = 0; i < NUM_TARGETS; i++) keys[i] = isMonitored(i) ? urlKey(targets[i].weburl) : 0;
+    for (size_t e = 0; e < count; e++) {
+        const uint8_t* entry = data + PACKET_HEADER + e * PACKET_ENTRY;
+        uint32_t key = (uint32_t)entry[0] << 24 | (uint32_t)entry[1] << 16 | (uint32_t)entry[2] << 8 | entry[3];
+        uint8_t vote = entry[4];
+        if (vote != VOTE_UP && vote != VOTE_DOWN) continue;
+        for (int i = 0; i < NUM_TARGETS; i++) {
+            if (keys[i] != key || !isMonitored(i)) continue;
+            setBit(peer->seen, i);
+            setVote(*peer, i, vote);
+        }
+    }
+    updateQuorum();
+}
+
+void federationBegin() {
+    if (configPending) {
+        federation = pendingConfig;
+        configPending = false;
+    }
+    for (Peer& peer : peers) {
+        if (peer.alive) forgetPeer(peer);
+        peer.node_id = 0;
+    }
+    memset(dirty, 0, sizeof(dirty));
+    anyDirty = false;
+
+    if (federation.node_id == 0) {
+        if (socketOpen) web_log_printf("[Federation] Off");
+        hal_udp_end();
+        socketOpen = false;
+    } else {
+        socketOpen = hal_udp_begin(federation.port);
+        snapshotDue = true;
+        resolvePeers();
+        if (socketOpen) {
+            web_log_printf("[Federation] Node %d on UDP port %u, %d peer(s), quorum %d",
+                federation.node_id, federation.port, federation.peer_count, federation.quorum);
+        } else {
+            web_log_printf("[Federation] Cannot open UDP port %u", federation.port);
+        }
+    }
+
+    // No peer has been heard yet: until they are, this node decides alone
+    lastQuorum = effectiveQuorum();
+    if (federation.node_id != 0 && lastQuorum < federation.quorum) {
+        web_log_printf("[Federation] Quorum %d until peers are heard from", lastQuorum);
+    }
+
+    // The quorum (or its absence) may change verdicts already reached
+    for (int i = 0; i < NUM_TARGETS; i++) reevaluateTarget(i);
+}
+
+void federationPoll() {
+    if (configPending) federationBegin();
+    if (!socketOpen) return;
+
+    uint8_t packet[PACKET_HEADER + PACKET_ENTRY * PACKET_MAX_ENTRIES];
+    char from[24];
+    size_t len;
+    // Bounded so a flood cannot starve the checks
+    for (int budget = 4 * FEDERATION_MAX_PEERS; budget > 0; budget--) {
+        len = hal_udp_receive(packet, sizeof(packet), from, sizeof(from));
+        if (len == 0) break;
+        receivePacket(packet, len, from);
+    }
+
+    for (Peer& peer : peers) {
+        if (!peer.alive || hal_millis() - peer.last_heard < FEDERATION_PEER_TIMEOUT_MS) continue;
+        web_log_printf("[Federation] Node %d silent for %lus; its votes no longer count",
+            peer.node_id, (hal_millis() - peer.last_heard) / 1000);
+        forgetPeer(peer);
+    }
+    updateQuorum();
+
+    if (snapshotDue || hal_millis() - lastHeartbeat >= FEDERATION_HEARTBEAT_MS) {
+        sendVerdicts(true);
+        lastHeartbeat = hal_millis();
+        snapshotDue = false;
+    } else if (anyDirty) {
+        sendVerdicts(false);
+    }
+}
+
+// --- Status ---
+
+void buildFederationJson(JsonObject root) {
+    root["enabled"] = federation.node_id != 0;
+    root["node_id"] = federation.node_id;
+    root["port"] = federation.port;
+    root["quorum"] = federation.quorum;
+    root["effective_quorum"] = federation.node_id ? effectiveQuorum() : 1;
+    root["listening"] = socketOpen;
+    root["notifier"] = federationNotifier();
+    root["is_notifier"] = federationIsNotifier();
+
+    JsonArray configured = root.createNestedArray("configured_peers");
+    for (int p = 0; p < federation.peer_count; p++) configured.add(federation.peers[p]);
+
+    int vantagePoints = 1;
+    JsonArray peerList = root.createNestedArray("peers");
+    for (Peer& peer : peers) {
+        if (peer.node_id == 0) continue;
+        if (peer.alive) vantagePoints++;
+        JsonObject obj = peerList.createNestedObject();
+        obj["node_id"] = peer.node_id;
+        obj["address"] = peer.address;
+        obj["alive"] = peer.alive;
+        obj["last_heard_seconds_ago"] = (hal_millis() - peer.last_heard) / 1000;
+    }
+    root["vantage_points"] = vantagePoints;
+
+    JsonObject packets = root.createNestedObject("packets");
+    packets["sent"] = packetsSent;
+    packets["received"] = packetsReceived;
+    packets["rejected"] = packetsRejected;
+
+    JsonArray list = root.createNestedArray("targets");
+    for (int i = 0; i < NUM_TARGETS; i++) {
+        if (!isMonitored(i)) continue;
+        int votes = ownVote(i) != VOTE_UNKNOWN ? 1 : 0;
+        int down = ownVote(i) == VOTE_DOWN ? 1 : 0;
+        for (const Peer& peer : peers) {
+            if (!peer.alive || peer.votes[i] == VOTE_UNKNOWN) continue;
+            votes++;
+            if (peer.votes[i] == VOTE_DOWN) down++;
+        }
+        JsonObject obj = list.createNestedObject();
+        obj["id"] = i;
+        obj["local"] = voteName(ownVote(i));
+        obj["votes"] = votes;
+        obj["down_votes"] = down;
+        obj["confirmed"] = confirmed_online_state[i] ? "up" : "down";
+    }
+}
@@ -0,0 +1,75 @@
+#pragma once
+
+#include <stdint.h>
+#include <ArduinoJson.h>
+
+#include "monitor_config.h"
+
+// --- Multi-vantage federation ---
+// Several monitors watching the same URLs exchange their own up/down verdict
+// per target over UDP, and a target is confirmed offline only while at least
+// `quorum` vantage points (this node included) see it down. A single device
+// with a bad uplink then no longer raises alerts on its own. Every node still
+// keeps its own state and logs; only the notifier (the lowest node id heard
+// from recently) sends notifications and custom HTTP actions.
+//
+// Targets are matched across nodes by URL. Each node sends a full snapshot
+// of its verdicts every FEDERATION_HEARTBEAT_MS and a delta as soon as one
+// of them changes. A peer not heard from for FEDERATION_PEER_TIMEOUT_MS no
+// longer votes. While fewer than `quorum` vantage points are alive the
+// quorum is lowered to the ones that are (logged), so losing peers degrades
+// to the local verdict instead of silently suppressing every outage.
+//
+// Only datagrams from a configured peer's address and port (the port it
+// listens on) are accepted; names are resolved again with every snapshot.
+
+const uint8_t FEDERATION_MAX_PEERS = 4;
+const uint16_t FEDERATION_DEFAULT_PORT = 4210;
+const uint32_t FEDERATION_HEARTBEAT_MS = 10000;
+const uint32_t FEDERATION_PEER_TIMEOUT_MS = 3 * FEDERATION_HEARTBEAT_MS;
+
+struct FederationConfig {
+    uint8_t node_id;   // 1-255, unique per node; 0 = federation off
+    uint16_t port;     // UDP port this node listens on
+    uint8_t quorum;    // Vantage points that must see a target down (1 = own verdict suffices)
+    uint8_t peer_count;
+    char peers[FEDERATION_MAX_PEERS][64];  // "host" or "host:port" (port defaults to ours)
+};
+
+extern FederationConfig federation;
+
+// "federation" object of config.json (missing object = off)
+void federationConfigFromJson(JsonObjectConst json);
+void federationConfigToJson(JsonObject json);
+bool federationConfigured();  // Whether there is anything to save (a staged change included)
+
+// POST /api/federation: validate a new configuration and hand it to the loop
+// task, which applies it in the next federationPoll() (the socket and the
+// re-evaluated targets belong to that task). Not persisted; the caller runs
+// saveConfig(), which already stores the new configuration. Returns an
+// error message or nullptr.
+const char* setFederationFromJson(JsonObjectConst json);
+
+// Apply a configuration handed over by setFederationFromJson(), open (or
+// close) the UDP socket for it and re-evaluate every target. Loop task only.
+void federationBegin();
+
+// Apply a pending configuration, receive peer verdicts, expire silent peers,
+// send deltas and heartbeats. Called from monitorLoop().
+void federationPoll();
+
+// This node's own verdict for a target changed (processCheckResult)
+void federationNoteLocalVerdict(int index);
+
+// Quorum decision for a target given this node's own verdict
+bool federationTargetDown(int index, bool localDown);
+
+// Whether this node sends notifications and custom HTTP actions
+bool federationIsNotifier();
+
+// Node id of the current notifier (0 when federation is off)
+uint8_t federationNotifier();
+
+// GET /api/federation
+void buildFederationJson(JsonObject root);
+const size_t FEDERATION_JSON_CAPACITY = 1024 + 160UL * NUM_TARGETS;
@@ -0,0 +1,157 @@
+#include "group_index.h"
+
+#include <string.h>
+
+#include "monitor_hal.h"
+#include "monitor_state.h"
+#include "text_util.h"
+
+struct GroupEntry {
+    char name[32];
+    int16_t first;   // Lowest member slot; -1 = entry unused
+    uint16_t members;
+    bool stale;      // A member was checked or re-filed since the aggregates were computed
+    uint16_t up;
+    uint16_t down;
+    uint32_t worst_latency_ms;
+    uint32_t median_latency_ms;
+    unsigned long last_change;
+};
+
+// One entry per possible group (every enabled slot in its own group at most)
+static GroupEntry groups[NUM_TARGETS];
+static int16_t groupOf[NUM_TARGETS];      // Entry of each slot, -1 = not indexed
+static int16_t nextInGroup[NUM_TARGETS];  // Member lists, ascending slot order
+
+// Nothing is indexed until the config is loaded
+static bool initGroupIndex() {
+    groupIndexRebuild();
+    return true;
+}
+static const bool groupIndexInitialized = initGroupIndex();
+
+static int findGroup(const char* name) {
+    for (int g = 0; g < NUM_TARGETS; g++) {
+        if (groups[g].first >= 0 && strcmp(groups[g].name, name) == 0) return g;
+    }
+    return -1;
+}
+
+static int allocGroup(const char* name) {
+    for (int g = 0; g < NUM_TARGETS; g++) {
+        if (groups[g].first >= 0) continue;
+        memset(&groups[g], 0, sizeof(groups[g]));
+        safeStrcpy(groups[g].name, name, sizeof(groups[g].name));
+        groups[g].first = -1;
+        return g;
+    }
+    return -1;  // Unreachable: there are as many entries as slots
+}
+
+static void addMember(int index, int g) {
+    int16_t* at = &groups[g].first;
+    while (*at >= 0 && *at < index) at = &nextInGroup[*at];
+    nextInGroup[index] = *at;
+    *at = index;
+    groupOf[index] = g;
+    groups[g].members++;
+    groups[g].stale = true;
+}
+
+static void removeMember(int index) {
+    int g = groupOf[index];
+    int16_t* at = &groups[g].first;
+    while (*at >= 0 && *at != index) at = &nextInGroup[*at];
+    if (*at == index) *at = nextInGroup[index];
+    groupOf[index] = -1;
+    groups[g].members--;
+    groups[g].stale = true;
+    // An empty entry is free again (first is already -1)
+}
+
+void groupIndexRebuild() {
+    for (int g = 0; g < NUM_TARGETS; g++) groups[g].first = -1;
+    for (int i = 0; i < NUM_TARGETS; i++) groupOf[i] = -1;
+    for (int i = 0; i < NUM_TARGETS; i++) groupIndexUpdate(i);
+}
+
+void groupIndexUpdate(int index) {
+    int current = groupOf[index];
+    bool indexed = targets[index].enabled;
+    if (current >= 0 && indexed && strcmp(groups[current].name, targets[index].group_name) == 0) {
+        groups[current].stale = true;
+        return;
+    }
+    if (current >= 0) removeMember(index);
+    if (!indexed) return;
+
+    int g = findGroup(targets[index].group_name);
+    if (g < 0) g = allocGroup(targets[index].group_name);
+    if (g >= 0) addMember(index, g);
+}
+
+void groupIndexRename(const char* oldName, const char* newName) {
+    int from = findGroup(oldName);
+    if (from < 0) return;
+    int to = findGroup(newName);
+    if (to < 0) {
+        safeStrcpy(groups[from].name, newName, sizeof(groups[from].name));
+        return;
+    }
+    if (to == from) return;
+    unsigned long lastChange = groups[from].last_change;
+    while (groups[from].first >= 0) {
+        int index = groups[from].first;
+        removeMember(index);
+        addMember(index, to);
+    }
+    if (lastChange > groups[to].last_change) groups[to].last_change = lastChange;
+}
+
+void groupIndexNoteResult(int index, bool transition) {
+    int g = groupOf[index];
+    if (g < 0) return;
+    groups[g].stale = true;
+    if (transition) groups[g].last_change = hal_millis();
+}
+
+int groupLedBy(int index) {
+    int g = groupOf[index];
+    return (g >= 0 && groups[g].first == index) ? g : -1;
+}
+
+static void refreshAggregates(GroupEntry& group) {
+    uint32_t latencies[NUM_TARGETS];
+    int count = 0;
+    group.up = 0;
+    group.down = 0;
+    for (int i = group.first; i >= 0; i = nextInGroup[i]) {
+        if (confirmed_online_state[i]) group.up++;
+        else group.down++;
+        if (!isOnlineCode(httpCode[i])) continue;
+
+        // Insertion sort; groups are small
+        uint32_t latency = pingTime[i];
+        int pos = count++;
+        while (pos > 0 && latencies[pos - 1] > latency) {
+            latencies[pos] = latencies[pos - 1];
+            pos--;
+        }
+        latencies[pos] = latency;
+    }
+    group.worst_latency_ms = count ? latencies[count - 1] : 0;
+    group.median_latency_ms = count ? (latencies[(count - 1) / 2] + latencies[count / 2]) / 2 : 0;
+    group.stale = false;
+}
+
+void getGroupSummary(int g, GroupSummary& out) {
+    GroupEntry& group = groups[g];
+    if (group.stale) refreshAggregates(group);
+    out.name = group.name;
+    out.members = group.members;
+    out.up = group.up;
+    out.down = group.down;
+    out.worst_latency_ms = group.worst_latency_ms;
+    out.median_latency_ms = group.median_latency_ms;
+    out.last_change = group.last_change;
+}
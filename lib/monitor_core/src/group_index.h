@@ -0,0 +1,42 @@
+#pragma once
+
+#include <stdint.h>
+
+#include "monitor_config.h"
+
+// --- Group index ---
+// Enabled targets are kept in one member list per group_name, so listing
+// groups or summarizing one does not rescan and compare every slot. The
+// config mutations in monitor_config.cpp keep it current (add, update,
+// delete, rename, load); processCheckResult() marks a group's aggregates
+// stale, and they are recomputed from its members on the next read.
+
+struct GroupSummary {
+    const char* name;
+    uint16_t members;            // Enabled targets in the group
+    uint16_t up;                 // Confirmed online
+    uint16_t down;               // Confirmed offline
+    uint32_t worst_latency_ms;   // Slowest last check among members whose last check succeeded
+    uint32_t median_latency_ms;  // Median of the same (0 when none)
+    unsigned long last_change;   // hal_millis() of the last confirmed transition, 0 = none since boot
+};
+
+// Rebuild from targets[] (after loading the config or filling slots directly)
+void groupIndexRebuild();
+
+// Re-file one slot after its group, enabled flag or slot assignment changed
+void groupIndexUpdate(int index);
+
+// Move every member of oldName to newName (merging if newName exists)
+void groupIndexRename(const char* oldName, const char* newName);
+
+// A check of the target finished; transition = its confirmed state flipped
+void groupIndexNoteResult(int index, bool transition);
+
+// Group whose lowest member is slot index, or -1. Walking index from 0 to
+// NUM_TARGETS - 1 visits every group once, in the order /api/groups has
+// always used (first appearance in the slot list).
+int groupLedBy(int index);
+
+// Current aggregates of a group (recomputed if a member was checked since)
+void getGroupSummary(int group, GroupSummary& out);
@@ -0,0 +1,102 @@
+#include "latency.h"
+
+#include <string.h>
+
+#include "monitor_hal.h"
+
+LatencyHistogram loopLatency;
+LatencyHistogram probeLatency;
+LatencyHistogram schedulingLag[NUM_TARGETS];
+LatencyHistogram endpointLatency[API_ENDPOINT_COUNT];
+
+static const char* const ENDPOINT_NAMES[API_ENDPOINT_COUNT] = {
+    "index", "status", "logs", "metrics", "diagnostics", "latency", "groups",
+    "groups_summary", "settings", "server_add", "server_update", "server_delete",
+    "group_rename", "targets_batch", "targets_export", "federation", "federation_update",
+    "metrics_push", "metrics_push_update", "alert_queue", "ota", "ota_start", "ota_cancel"
+};
+
+void latencyRecord(LatencyHistogram& histogram, uint32_t us) {
+    int bucket = us == 0 ? 0 : 31 - __builtin_clz(us);
+    if (bucket >= LATENCY_BUCKETS) bucket = LATENCY_BUCKETS - 1;
+    histogram.buckets[bucket]++;
+    histogram.count++;
+    histogram.sum_us += us;
+    if (us > histogram.max_us) histogram.max_us = us;
+}
+
+LatencyTimer latencyStart() {
+    LatencyTimer timer;
+    timer.start_cycles = hal_cycle_count();
+    timer.start_ms = hal_millis();
+    return timer;
+}
+
+uint32_t latencyElapsedUs(const LatencyTimer& timer) {
+    // The 32-bit cycle counter wraps (every ~17.9 s at 240 MHz); fall back to
+    // the millisecond clock for anything that may have come close to that
+    uint32_t cyclesPerUs = hal_cycles_per_us();
+    uint32_t elapsedMs = hal_millis() - timer.start_ms;
+    uint32_t wrapMs = (uint32_t)(0xFFFFFFFFUL / cyclesPerUs / 1000);
+    if (elapsedMs >= wrapMs / 2) return elapsedMs * 1000;
+    return (hal_cycle_count() - timer.start_cycles) / cyclesPerUs;
+}
+
+// Upper bound of the bucket holding the given quantile, capped at the maximum
+static uint32_t percentileUs(const LatencyHistogram& h, uint32_t permille) {
+    uint64_t rank = ((uint64_t)h.count * permille + 999) / 1000;
+    uint64_t seen = 0;
+    for (int k = 0; k < LATENCY_BUCKETS; k++) {
+        seen += h.buckets[k];
+        if (seen >= rank) {
+            uint64_t upper = (k == LATENCY_BUCKETS - 1) ? h.max_us : ((uint64_t)2 << k);
+            return upper < h.max_us ? (uint32_t)upper : h.max_us;
+        }
+    }
+    return h.max_us;
+}
+
+static void addHistogram(JsonObject obj, const LatencyHistogram& h, bool includeBuckets) {
+    obj["count"] = h.count;
+    obj["mean_us"] = h.count ? (uint32_t)(h.sum_us / h.count) : 0;
+    obj["max_us"] = h.max_us;
+    obj["p50_us"] = percentileUs(h, 500);
+    obj["p95_us"] = percentileUs(h, 950);
+    obj["p99_us"] = percentileUs(h, 990);
+    if (includeBuckets) {
+        JsonArray buckets = obj.createNestedArray("buckets");
+        for (int k = 0; k < LATENCY_BUCKETS; k++) buckets.add(h.buckets[k]);
+    }
+}
+
+void buildLatencyJson(JsonObject root, bool includeBuckets) {
+    root["unit"] = "us";
+    if (includeBuckets) {
+        // Bucket k holds [2^k, 2^(k+1)) us; the last bucket is open-ended
+        JsonArray bounds = root.createNestedArray("bucket_upper_bounds_us");
+        for (int k = 0; k < LATENCY_BUCKETS - 1; k++) bounds.add((uint32_t)2 << k);
+    }
+
+    addHistogram(root.createNestedObject("loop"), loopLatency, includeBuckets);
+    addHistogram(root.createNestedObject("probe"), probeLatency, includeBuckets);
+
+    JsonObject endpoints = root.createNestedObject("endpoints");
+    for (int i = 0; i < API_ENDPOINT_COUNT; i++) {
+        if (endpointLatency[i].count == 0) continue;
+        addHistogram(endpoints.createNestedObject(ENDPOINT_NAMES[i]), endpointLatency[i], includeBuckets);
+    }
+
+    JsonArray lag = root.createNestedArray("scheduling_lag");
+    for (int i = 0; i < NUM_TARGETS; i++) {
+        if (schedulingLag[i].count == 0) continue;
+        JsonObject target = lag.createNestedObject();
+        target["id"] = i;
+        addHistogram(target, schedulingLag[i], includeBuckets);
+    }
+}
+
+size_t latencyJsonCapacity(bool includeBuckets) {
+    // ~8 members per histogram, plus the bucket array when requested
+    size_t perHistogram = includeBuckets ? 640 : 192;
+    return 1024 + perHistogram * (2 + API_ENDPOINT_COUNT + NUM_TARGETS);
+}
@@ -0,0 +1,83 @@
+#pragma once
+
+#include <stdint.h>
+#include <ArduinoJson.h>
+
+#include "monitor_config.h"
+
+// --- Hot-path latency histograms (/api/latency) ---
+// Durations are taken from the CPU cycle counter and recorded into fixed
+// power-of-two buckets, so timing costs a few instructions and no heap.
+
+// Bucket k counts durations in [2^k, 2^(k+1)) microseconds; the last bucket
+// also takes everything longer (>= ~16.8 s)
+const int LATENCY_BUCKETS = 25;
+
+struct LatencyHistogram {
+    uint32_t count;
+    uint32_t max_us;
+    uint64_t sum_us;
+    uint32_t buckets[LATENCY_BUCKETS];
+};
+
+void latencyRecord(LatencyHistogram& histogram, uint32_t us);
+
+struct LatencyTimer {
+    uint32_t start_cycles;
+    uint32_t start_ms;
+};
+
+LatencyTimer latencyStart();
+uint32_t latencyElapsedUs(const LatencyTimer& timer);
+
+// Records the lifetime of the scope into a histogram
+class LatencyScope {
+public:
+    explicit LatencyScope(LatencyHistogram& histogram) : histogram_(histogram), timer_(latencyStart()) {}
+    ~LatencyScope() { latencyRecord(histogram_, latencyElapsedUs(timer_)); }
+
+private:
+    LatencyScope(const LatencyScope&);
+    LatencyScope& operator=(const LatencyScope&);
+
+    LatencyHistogram& histogram_;
+    LatencyTimer timer_;
+};
+
+// Web handlers, each timed for as long as it holds the AsyncTCP task
+enum ApiEndpoint {
+    ENDPOINT_INDEX,
+    ENDPOINT_STATUS,
+    ENDPOINT_LOGS,
+    ENDPOINT_METRICS,  // Each chunk callback is recorded separately
+    ENDPOINT_DIAGNOSTICS,
+    ENDPOINT_LATENCY,
+    ENDPOINT_GROUPS,
+    ENDPOINT_GROUPS_SUMMARY,
+    ENDPOINT_SETTINGS,
+    ENDPOINT_SERVER_ADD,
+    ENDPOINT_SERVER_UPDATE,
+    ENDPOINT_SERVER_DELETE,
+    ENDPOINT_GROUP_RENAME,
+    ENDPOINT_TARGETS_BATCH,
+    ENDPOINT_TARGETS_EXPORT,  // Each chunk callback is recorded separately
+    ENDPOINT_FEDERATION,
+    ENDPOINT_FEDERATION_UPDATE,
+    ENDPOINT_METRICS_PUSH,
+    ENDPOINT_METRICS_PUSH_UPDATE,
+    ENDPOINT_ALERT_QUEUE,
+    ENDPOINT_OTA,
+    ENDPOINT_OTA_START,
+    ENDPOINT_OTA_CANCEL,
+    API_ENDPOINT_COUNT
+};
+
+extern LatencyHistogram loopLatency;                 // One monitorLoop() pass
+extern LatencyHistogram probeLatency;                // One target check (HTTP request)
+extern LatencyHistogram schedulingLag[NUM_TARGETS];  // Check start minus due time
+extern LatencyHistogram endpointLatency[API_ENDPOINT_COUNT];
+
+// Summary per histogram (count, mean, max, p50/p95/p99 upper bounds);
+// includeBuckets adds the raw bucket counts
+void buildLatencyJson(JsonObject root, bool includeBuckets);
+size_t latencyJsonCapacity(bool includeBuckets);
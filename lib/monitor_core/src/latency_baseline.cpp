@@ -0,0 +1,45 @@
+#include "latency_baseline.h"
+
+#include <math.h>
+
+LatencyBaseline latencyBaselines[NUM_TARGETS];
+
+void latencyBaselineUpdate(LatencyBaseline& baseline, uint32_t ms) {
+    float x = (float)ms;
+    if (baseline.samples == 0) {
+        baseline.mean_ms = x;
+        baseline.deviation_ms = 0.0f;
+        baseline.samples = 1;
+        return;
+    }
+    // Plain running average while warming up, so the first samples count
+    // equally; then a fixed weight
+    uint16_t n = baseline.samples < (1 << LATENCY_ALPHA_SHIFT) ? baseline.samples : (1 << LATENCY_ALPHA_SHIFT) - 1;
+    float alpha = 1.0f / (n + 1);
+
+    float error = x - baseline.mean_ms;
+    if (latencyBaselineReady(baseline)) {
+        float clip = LATENCY_CLIP_DEVIATIONS * baseline.deviation_ms;
+        if (clip < LATENCY_MIN_SPREAD_MS) clip = LATENCY_MIN_SPREAD_MS;
+        if (error > clip) error = clip;
+        else if (error < -clip) error = -clip;
+    }
+    baseline.mean_ms += alpha * error;
+    baseline.deviation_ms += alpha * (fabsf(error) - baseline.deviation_ms);
+    if (baseline.samples < 0xFFFF) baseline.samples++;
+}
+
+uint32_t latencySlowLimitMs(int index) {
+    const TargetConfig& target = targets[index];
+    uint32_t limit = target.latency_threshold_ms;
+    const LatencyBaseline& baseline = latencyBaselines[index];
+    if (target.latency_deviations && latencyBaselineReady(baseline)) {
+        float spread = baseline.deviation_ms;
+        float floor = baseline.mean_ms * LATENCY_MIN_SPREAD_FRACTION;
+        if (floor < LATENCY_MIN_SPREAD_MS) floor = LATENCY_MIN_SPREAD_MS;
+        if (spread < floor) spread = floor;
+        uint32_t learned = (uint32_t)(baseline.mean_ms + target.latency_deviations * spread + 0.5f);
+        if (!limit || learned < limit) limit = learned;
+    }
+    return limit;
+}
@@ -0,0 +1,46 @@
+#pragma once
+
+#include <stdint.h>
+
+#include "monitor_config.h"
+
+// --- Latency baseline ---
+// Each target learns its normal latency from its own successful checks that
+// were not slow, outside the degraded state: an exponentially weighted mean
+// and mean absolute deviation, updated in O(1) per check without keeping any
+// history. Before a sample is learned its distance from the mean is clipped
+// to LATENCY_CLIP_DEVIATIONS deviations (a Huber estimate), so drift within
+// the limit is followed within a few dozen checks. A lasting shift beyond it
+// stays degraded until the server is fast again or its URL changes.
+//
+// A check is slow when it takes longer than the target's latency_threshold_ms
+// (a fixed SLO) or, once LATENCY_WARMUP_SAMPLES have been learned, longer
+// than mean + latency_deviations x deviation. The deviation used there is
+// never below LATENCY_MIN_SPREAD_MS or LATENCY_MIN_SPREAD_FRACTION of the
+// mean, so a very steady target does not alert on a few ms of jitter.
+
+const uint8_t LATENCY_ALPHA_SHIFT = 4;        // Weight of a new sample once warmed up: 1/16
+const uint16_t LATENCY_WARMUP_SAMPLES = 20;
+const float LATENCY_CLIP_DEVIATIONS = 3.0f;
+const float LATENCY_MIN_SPREAD_MS = 5.0f;
+const float LATENCY_MIN_SPREAD_FRACTION = 0.1f;
+
+struct LatencyBaseline {
+    float mean_ms;
+    float deviation_ms;  // Mean absolute deviation from mean_ms
+    uint16_t samples;    // Learned checks (saturates)
+};
+
+extern LatencyBaseline latencyBaselines[NUM_TARGETS];
+
+inline bool latencyBaselineReady(const LatencyBaseline& baseline) {
+    return baseline.samples >= LATENCY_WARMUP_SAMPLES;
+}
+
+// Learn the duration of a successful check
+void latencyBaselineUpdate(LatencyBaseline& baseline, uint32_t ms);
+
+// Slowest check of the target that still counts as normal: the SLO or the
+// baseline limit, whichever is lower. 0 = no limit (neither is configured,
+// or the baseline is still warming up).
+uint32_t latencySlowLimitMs(int index);
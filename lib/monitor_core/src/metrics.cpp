@@ -0,0 +1,164 @@
+#include "metrics.h"
+
+#include <stdio.h>
+#include <string.h>
+
+#include "latency_baseline.h"
+#include "monitor_hal.h"
+#include "monitor_config.h"
+#include "monitor_state.h"
+#include "scheduler.h"
+
+struct MetricFamily {
+    const char* name;
+    const char* type;
+    const char* help;
+    bool per_target;
+};
+
+// Order must match METRIC_FAMILIES below
+enum MetricFamilyId {
+    METRIC_TARGET_UP,
+    METRIC_TARGET_HTTP_CODE,
+    METRIC_TARGET_LATENCY,
+    METRIC_TARGET_CHECKS,
+    METRIC_TARGET_FAILURES,
+    METRIC_TARGET_CHECK_INTERVAL,
+    METRIC_TARGET_DEGRADED,
+    METRIC_TARGET_LATENCY_BASELINE,
+    METRIC_HEAP_FREE,
+    METRIC_HEAP_MIN_FREE,
+    METRIC_HEAP_MAX_ALLOC,
+    METRIC_HEAP_FRAGMENTATION,
+    METRIC_WIFI_RSSI,
+    METRIC_UPTIME,
+    METRIC_PROBES,
+    METRIC_PROBES_COALESCED
+};
+
+static const MetricFamily METRIC_FAMILIES[] = {
+    {"uptime_monitor_target_up", "gauge", "Whether the last check of the target succeeded (2xx/3xx).", true},
+    {"uptime_monitor_target_http_code", "gauge", "HTTP status code of the last check (negative values are transport errors).", true},
+    {"uptime_monitor_target_latency_milliseconds", "gauge", "Duration of the last check in milliseconds.", true},
+    {"uptime_monitor_target_checks_total", "counter", "Checks performed since boot.", true},
+    {"uptime_monitor_target_failures_total", "counter", "Failed checks since boot.", true},
+    {"uptime_monitor_target_check_interval_seconds", "gauge", "Current adaptive interval between checks in seconds.", true},
+    {"uptime_monitor_target_degraded", "gauge", "Whether the target is online but confirmed slow (latency SLO or baseline).", true},
+    {"uptime_monitor_target_latency_baseline_milliseconds", "gauge", "Learned normal check duration in milliseconds (EWMA).", true},
+    {"uptime_monitor_heap_free_bytes", "gauge", "Free heap in bytes.", false},
+    {"uptime_monitor_heap_min_free_bytes", "gauge", "Lowest free heap since boot in bytes.", false},
+    {"uptime_monitor_heap_max_alloc_bytes", "gauge", "Largest allocatable heap block in bytes.", false},
+    {"uptime_monitor_heap_fragmentation_percent", "gauge", "Heap fragmentation (100 - max block / free heap).", false},
+    {"uptime_monitor_wifi_rssi_dbm", "gauge", "WiFi signal strength in dBm.", false},
+    {"uptime_monitor_uptime_seconds", "counter", "Seconds since boot.", false},
+    {"uptime_monitor_probes_total", "counter", "HTTP requests sent for checks since boot.", false},
+    {"uptime_monitor_probes_coalesced_total", "counter", "Checks answered by another target's probe of the same URL.", false},
+};
+static const int METRIC_FAMILY_COUNT = sizeof(METRIC_FAMILIES) / sizeof(METRIC_FAMILIES[0]);
+
+// Append a label value with Prometheus escaping (backslash, quote, newline)
+static size_t appendLabelValue(char* buf, size_t pos, size_t size, const char* value) {
+    while (*value && pos + 2 < size) {
+        char c = *value++;
+        if (c == '\\' || c == '"') {
+            buf[pos++] = '\\';
+            buf[pos++] = c;
+        } else if (c == '\n') {
+            buf[pos++] = '\\';
+            buf[pos++] = 'n';
+        } else {
+            buf[pos++] = c;
+        }
+    }
+    buf[pos] = '\0';
+    return pos;
+}
+
+static int metricFamilySteps(int family) {
+    return 2 + (METRIC_FAMILIES[family].per_target ? NUM_TARGETS : 1);
+}
+
+// Render one line of the exposition into buf. Returns its length, or 0 when
+// the step produces no output (disabled target slot).
+static size_t renderMetricLine(char* buf, size_t size, int family, int step) {
+    const MetricFamily& f = METRIC_FAMILIES[family];
+    if (step == 0) return snprintf(buf, size, "# HELP %s %s\n", f.name, f.help);
+    if (step == 1) return snprintf(buf, size, "# TYPE %s %s\n", f.name, f.type);
+
+    if (!f.per_target) {
+        HalHeapStats heap;
+        hal_heap_stats(&heap);
+        long value = 0;
+        switch (family) {
+            case METRIC_HEAP_FREE: value = heap.free_bytes; break;
+            case METRIC_HEAP_MIN_FREE: value = heap.min_free_bytes; break;
+            case METRIC_HEAP_MAX_ALLOC: value = heap.max_alloc_bytes; break;
+            case METRIC_HEAP_FRAGMENTATION:
+                value = heap.free_bytes ? 100 - ((heap.max_alloc_bytes * 100) / heap.free_bytes) : 0;
+                break;
+            case METRIC_WIFI_RSSI: value = hal_network_connected() ? hal_network_rssi() : 0; break;
+            case METRIC_UPTIME: value = hal_millis() / 1000; break;
+            case METRIC_PROBES: value = probes_sent; break;
+            case METRIC_PROBES_COALESCED: value = probes_coalesced; break;
+        }
+        return snprintf(buf, size, "%s %ld\n", f.name, value);
+    }
+
+    int i = step - 2;
+    if (!targets[i].enabled) return 0;
+
+    long value = 0;
+    switch (family) {
+        case METRIC_TARGET_UP: value = isOnlineCode(httpCode[i]) ? 1 : 0; break;
+        case METRIC_TARGET_HTTP_CODE: value = httpCode[i]; break;
+        case METRIC_TARGET_LATENCY: value = pingTime[i]; break;
+        case METRIC_TARGET_CHECKS: value = total_checks[i]; break;
+        case METRIC_TARGET_FAILURES: value = total_failures[i]; break;
+        case METRIC_TARGET_CHECK_INTERVAL: value = effectiveCheckInterval(i); break;
+        case METRIC_TARGET_DEGRADED: value = degraded[i] ? 1 : 0; break;
+        case METRIC_TARGET_LATENCY_BASELINE: value = (long)(latencyBaselines[i].mean_ms + 0.5f); break;
+    }
+
+    size_t pos = snprintf(buf, size, "%s{id=\"%d\",name=\"", f.name, i);
+    pos = appendLabelValue(buf, pos, size, targets[i].server_name);
+    pos += snprintf(buf + pos, size - pos, "\",group=\"");
+    pos = appendLabelValue(buf, pos, size, targets[i].group_name);
+    pos += snprintf(buf + pos, size - pos, "\"} %ld\n", value);
+    return pos < size ? pos : size - 1;
+}
+
+void metricsBegin(MetricsCursor& cursor) {
+    cursor.family = 0;
+    cursor.step = 0;
+    cursor.length = 0;
+    cursor.offset = 0;
+}
+
+size_t writeMetricsChunk(MetricsCursor& cursor, uint8_t* out, size_t maxLen) {
+    size_t written = 0;
+
+    while (written < maxLen) {
+        if (cursor.offset == cursor.length) {
+            if (cursor.family >= METRIC_FAMILY_COUNT) break;
+            if (cursor.step >= metricFamilySteps(cursor.family)) {
+                cursor.family++;
+                cursor.step = 0;
+                continue;
+            }
+            // Empty for a disabled target slot
+            cursor.length = (uint16_t)renderMetricLine(cursor.line, sizeof(cursor.line), cursor.family, cursor.step);
+            cursor.offset = 0;
+            cursor.step++;
+            // Keep whole lines together; the line starts the next chunk
+            if (written && cursor.length > maxLen - written) break;
+            continue;
+        }
+
+        size_t chunk = cursor.length - cursor.offset;
+        if (chunk > maxLen - written) chunk = maxLen - written;
+        memcpy(out + written, cursor.line + cursor.offset, chunk);
+        written += chunk;
+        cursor.offset += chunk;
+    }
+    return written;
+}
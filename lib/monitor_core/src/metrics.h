@@ -0,0 +1,30 @@
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+
+// --- PROMETHEUS METRICS EXPORTER ---
+// GET /metrics is streamed through a chunked response. Each call of the chunk
+// callback renders one exposition line at a time into the cursor and copies
+// it into the TCP buffer, so a scrape performs no heap allocation beyond the
+// response object itself. A chunk ends before a line that does not fit; only
+// a line longer than the whole chunk is split, and its rest is sent from the
+// cursor as rendered, so every line carries the values of one moment.
+
+const int METRICS_LINE_SIZE = 320;  // Longest line: labels with fully escaped name/group
+
+// Position in the exposition output, kept per request by the chunk callback.
+// step 0 = HELP line, step 1 = TYPE line, step 2.. = samples (2 + NUM_TARGETS
+// steps for a per-target family).
+struct MetricsCursor {
+    uint8_t family;
+    uint16_t step;    // Next step to render
+    uint16_t length;  // Rendered line waiting in `line`
+    uint16_t offset;  // Bytes of it already sent
+    char line[METRICS_LINE_SIZE];
+};
+
+void metricsBegin(MetricsCursor& cursor);
+
+// Fill up to maxLen bytes, resuming from the cursor. Returns 0 when done.
+size_t writeMetricsChunk(MetricsCursor& cursor, uint8_t* out, size_t maxLen);
@@ -0,0 +1,388 @@
+#include "metrics_push.h"
+
+#include <stdio.h>
+#include <string.h>
+#include <time.h>
+#include <memory>
+
+#include "diagnostics.h"
+#include "monitor_config.h"
+#include "monitor_hal.h"
+#include "monitor_state.h"
+#include "text_util.h"
+#include "uptime_stats.h"
+#include "web_log.h"
+
+MetricsPushConfig metricsPush = {"0", "0", 10, 20};
+
+// Written by the API handler only while no change is pending, then handed
+// over by setting configPending; from there on only metricsPushPoll() (loop
+// task, which also posts with metricsPush) touches it
+static MetricsPushConfig pendingConfig;
+static volatile bool configPending = false;
+
+struct PushRecord {
+    uint32_t unix_time;  // 0 = wall clock unknown when recorded
+    uint32_t millis;
+    uint32_t latency_ms;
+    int16_t code;
+    uint16_t target;
+};
+
+static PushRecord pending[METRICS_PUSH_MAX_BATCH];
+static uint8_t pendingCount = 0;
+static unsigned long lastFlush = 0;
+
+// Backlog: segment files /mpush<k>.lp used as a ring, described by /mpush.idx
+const uint32_t BACKLOG_INDEX_MAGIC = 0x4D504231;  // "MPB1"
+struct BacklogIndex {
+    uint32_t magic;
+    uint8_t head;   // Oldest segment
+    uint8_t count;
+    uint16_t reserved;
+    uint32_t bytes[METRICS_PUSH_BACKLOG_SEGMENTS];
+};
+static BacklogIndex backlog = {BACKLOG_INDEX_MAGIC, 0, 0, 0, {0}};
+static uint32_t backlogBytes = 0;
+
+static unsigned long retryAt = 0;    // hal_millis() before which nothing is sent
+static uint32_t backoffMs = 0;
+static unsigned long lastDrain = 0;
+
+static uint32_t resultsQueued = 0;
+static uint32_t resultsDropped = 0;   // Queue full, or segment dropped / rejected
+static uint32_t batchesSent = 0;
+static uint32_t batchesSpilled = 0;
+static uint32_t segmentsDrained = 0;
+static uint32_t segmentsDropped = 0;
+static int lastStatus = 0;
+static unsigned long lastSuccess = 0;
+
+static bool isEnabled() {
+    return strlen(metricsPush.url) > 1;
+}
+
+// --- Line protocol ---
+
+// Tag values escape comma, space and equals sign
+static size_t appendTag(char* out, size_t pos, size_t size, const char* key, const char* value) {
+    if (!*value) return pos;  // Empty tag values are not allowed
+    pos += snprintf(out + pos, pos < size ? size - pos : 0, ",%s=", key);
+    for (; *value && pos + 2 < size; value++) {
+        if (*value == ',' || *value == ' ' || *value == '=') out[pos++] = '\\';
+        out[pos++] = *value;
+    }
+    if (pos < size) out[pos] = '\0';
+    return pos;
+}
+
+size_t formatPushLine(char* out, size_t size, int index, int code, uint32_t latencyMs, uint32_t unixTime) {
+    size_t pos = snprintf(out, size, "uptime_check,id=%d", index);
+    pos = appendTag(out, pos, size, "name", targets[index].server_name);
+    pos = appendTag(out, pos, size, "group", targets[index].group_name);
+    // Nanosecond timestamps, the default precision of every Influx write API
+    if (unixTime) {
+        pos += snprintf(out + pos, pos < size ? size - pos : 0, " up=%di,code=%di,latency_ms=%lui %lu000000000\n",
+            isOnlineCode(code) ? 1 : 0, code, (unsigned long)latencyMs, (unsigned long)unixTime);
+    } else {
+        pos += snprintf(out + pos, pos < size ? size - pos : 0, " up=%di,code=%di,latency_ms=%lui\n",
+            isOnlineCode(code) ? 1 : 0, code, (unsigned long)latencyMs);
+    }
+    return pos < size ? pos : size - 1;
+}
+
+static uint32_t clockNow() {
+    time_t now = time(nullptr);
+    return now >= UPTIME_MIN_VALID_EPOCH ? (uint32_t)now : 0;
+}
+
+// --- Configuration ---
+
+static void readConfig(MetricsPushConfig& config, JsonObjectConst json) {
+    safeStrcpy(config.url, json["url"] | "0", sizeof(config.url));
+    safeStrcpy(config.authorization, json["authorization"] | "0", sizeof(config.authorization));
+    config.interval_seconds = json["interval"] | 10;
+    config.batch_size = json["batch_size"] | 20;
+}
+
+void metricsPushConfigFromJson(JsonObjectConst json) {
+    readConfig(metricsPush, json);
+}
+
+// A change not applied yet is what gets saved
+static const MetricsPushConfig& savedConfig() {
+    return configPending ? pendingConfig : metricsPush;
+}
+
+bool metricsPushConfigured() {
+    return strlen(savedConfig().url) > 1;
+}
+
+void metricsPushConfigToJson(JsonObject json) {
+    const MetricsPushConfig& config = savedConfig();
+    json["url"] = config.url;
+    json["authorization"] = config.authorization;
+    json["interval"] = config.interval_seconds;
+    json["batch_size"] = config.batch_size;
+}
+
+const char* setMetricsPushFromJson(JsonObjectConst json) {
+    if (configPending) return "Previous change not applied yet";
+    const char* url = json["url"] | "0";
+    if (strlen(url) > 1 && strncmp(url, "http://", 7) != 0 && strncmp(url, "https://", 8) != 0) return "Invalid url";
+    if (strlen(url) >= sizeof(metricsPush.url)) return "url too long";
+    if (strlen(json["authorization"] | "0") >= sizeof(metricsPush.authorization)) return "authorization too long";
+    int interval = json["interval"] | 10;
+    int batchSize = json["batch_size"] | 20;
+    if (interval < 1 || interval > 3600) return "Invalid interval";
+    if (batchSize < 1 || batchSize > METRICS_PUSH_MAX_BATCH) return "Invalid batch_size";
+
+    readConfig(pendingConfig, json);
+    configPending = true;
+    return nullptr;
+}
+
+// A new endpoint starts without the old one's back-off
+static void applyPendingConfig() {
+    metricsPush = pendingConfig;
+    configPending = false;
+    retryAt = 0;
+    backoffMs = 0;
+    web_log_printf("[Metrics push] %s", isEnabled() ? "Settings applied" : "Off");
+}
+
+// --- Backlog ---
+
+static void segmentPath(char* path, size_t size, int segment) {
+    snprintf(path, size, "/mpush%d.lp", segment);
+}
+
+static void saveBacklogIndex() {
+    HalFile* file = hal_fs_open("/mpush.idx", "w");
+    if (!file) return;
+    hal_fs_write(file, &backlog, sizeof(backlog));
+    hal_fs_close(file);
+}
+
+void metricsPushBegin() {
+    HalFile* file = hal_fs_open("/mpush.idx", "r");
+    if (!file) return;
+    BacklogIndex stored;
+    bool valid = hal_fs_read(file, &stored, sizeof(stored)) == sizeof(stored) && stored.magic == BACKLOG_INDEX_MAGIC &&
+                 stored.head < METRICS_PUSH_BACKLOG_SEGMENTS && stored.count <= METRICS_PUSH_BACKLOG_SEGMENTS;
+    hal_fs_close(file);
+    if (!valid) return;
+    backlog = stored;
+    backlogBytes = 0;
+    for (int k = 0; k < backlog.count; k++) backlogBytes += backlog.bytes[(backlog.head + k) % METRICS_PUSH_BACKLOG_SEGMENTS];
+    if (backlog.count) web_log_printf("[Metrics push] %d backlog segment(s) to drain", backlog.count);
+}
+
+static void dropOldestSegment() {
+    char path[24];
+    segmentPath(path, sizeof(path), backlog.head);
+    hal_fs_remove(path);
+    backlogBytes -= backlog.bytes[backlog.head];
+    backlog.bytes[backlog.head] = 0;
+    backlog.head = (backlog.head + 1) % METRICS_PUSH_BACKLOG_SEGMENTS;
+    backlog.count--;
+}
+
+void metricsPushClearBacklog() {
+    while (backlog.count) dropOldestSegment();
+    hal_fs_remove("/mpush.idx");
+}
+
+// Batches are appended to the tail segment until it holds at least
+// METRICS_PUSH_SEGMENT_BYTES (so by at most one batch more), which means the
+// segment count never limits the backlog before METRICS_PUSH_BACKLOG_MAX_BYTES
+static void spill(const char* body, size_t len, int lines) {
+    while (backlog.count > 0 && backlogBytes + len > METRICS_PUSH_BACKLOG_MAX_BYTES) {
+        dropOldestSegment();
+        segmentsDropped++;
+    }
+    int tail = (backlog.head + backlog.count + METRICS_PUSH_BACKLOG_SEGMENTS - 1) % METRICS_PUSH_BACKLOG_SEGMENTS;
+    bool append = backlog.count > 0 && backlog.bytes[tail] < METRICS_PUSH_SEGMENT_BYTES;
+    while (!append && backlog.count >= METRICS_PUSH_BACKLOG_SEGMENTS) {
+        dropOldestSegment();
+        segmentsDropped++;
+    }
+    int segment = append ? tail : (backlog.head + backlog.count) % METRICS_PUSH_BACKLOG_SEGMENTS;
+    char path[24];
+    segmentPath(path, sizeof(path), segment);
+    HalFile* file = hal_fs_open(path, append ? "a" : "w");
+    if (!file || hal_fs_write(file, body, len) != len) {
+        if (file) hal_fs_close(file);
+        resultsDropped += lines;
+        web_log_printf("[Metrics push] Cannot write %s; %d result(s) lost", path, lines);
+        return;
+    }
+    hal_fs_close(file);
+    if (append) {
+        backlog.bytes[segment] += len;
+    } else {
+        backlog.bytes[segment] = len;
+        backlog.count++;
+    }
+    backlogBytes += len;
+    batchesSpilled++;
+    saveBacklogIndex();
+}
+
+// --- Transport ---
+
+static int post(const char* body, size_t len) {
+    HalHttpRequest request = {};
+    request.method = "POST";
+    request.url = metricsPush.url;
+    request.content_type = "text/plain; charset=utf-8";
+    if (strlen(metricsPush.authorization) > 1) {
+        request.header_name = "Authorization";
+        request.header_value = metricsPush.authorization;
+    }
+    request.body = body;
+    request.body_len = len;
+    request.timeout_ms = 5000;
+    request.follow_redirects = false;
+    lastStatus = hal_http_request(request);
+    return lastStatus;
+}
+
+enum PushOutcome { PUSH_OK, PUSH_RETRY, PUSH_REJECTED };
+
+// 4xx other than 408/429 means the collector will never take this batch
+// (bad credentials, malformed line): retrying would block the backlog forever
+static PushOutcome classify(int code) {
+    if (code >= 200 && code < 300) return PUSH_OK;
+    if (code >= 400 && code < 500 && code != 408 && code != 429) return PUSH_REJECTED;
+    return PUSH_RETRY;
+}
+
+static void noteOutcome(PushOutcome outcome) {
+    if (outcome == PUSH_RETRY) {
+        uint32_t base = metricsPush.interval_seconds * 1000UL;
+        backoffMs = backoffMs ? backoffMs * 2 : base;
+        if (backoffMs > METRICS_PUSH_MAX_BACKOFF_MS) backoffMs = METRICS_PUSH_MAX_BACKOFF_MS;
+        retryAt = hal_millis() + backoffMs;
+        web_log_printf("[Metrics push] Collector answered %d; retrying in %lus", lastStatus, (unsigned long)(backoffMs / 1000));
+        return;
+    }
+    backoffMs = 0;
+    retryAt = 0;
+    if (outcome == PUSH_OK) lastSuccess = hal_millis();
+    else web_log_printf("[Metrics push] Collector rejected a batch (%d); dropped", lastStatus);
+}
+
+static bool canSend() {
+    return hal_network_connected() && (retryAt == 0 || (long)(hal_millis() - retryAt) >= 0);
+}
+
+static void flushPending() {
+    HeapScope heapScope(HEAP_METRICS_PUSH);
+    std::unique_ptr<char[]> body(new char[pendingCount * METRICS_PUSH_LINE_SIZE]);
+    uint32_t now = clockNow();
+    size_t len = 0;
+    for (int k = 0; k < pendingCount; k++) {
+        const PushRecord& r = pending[k];
+        // Results from before the clock was set get a back-dated timestamp
+        uint32_t unixTime = r.unix_time ? r.unix_time : now ? now - (hal_millis() - r.millis) / 1000 : 0;
+        len += formatPushLine(body.get() + len, METRICS_PUSH_LINE_SIZE, r.target, r.code, r.latency_ms, unixTime);
+    }
+    int lines = pendingCount;
+    pendingCount = 0;
+    lastFlush = hal_millis();
+
+    if (!canSend()) {
+        spill(body.get(), len, lines);
+        return;
+    }
+    PushOutcome outcome = classify(post(body.get(), len));
+    heapScope.sample();
+    noteOutcome(outcome);
+    if (outcome == PUSH_OK) batchesSent++;
+    else if (outcome == PUSH_REJECTED) resultsDropped += lines;
+    else spill(body.get(), len, lines);
+}
+
+static void drainOneSegment() {
+    HeapScope heapScope(HEAP_METRICS_PUSH);
+    lastDrain = hal_millis();
+    char path[24];
+    segmentPath(path, sizeof(path), backlog.head);
+    HalFile* file = hal_fs_open(path, "r");
+    if (!file) {
+        dropOldestSegment();  // Lost (e.g. filesystem repaired); nothing to send
+        segmentsDropped++;
+        saveBacklogIndex();
+        return;
+    }
+    size_t size = hal_fs_size(file);
+    std::unique_ptr<char[]> body(new char[size + 1]);
+    size = hal_fs_read(file, body.get(), size);
+    hal_fs_close(file);
+
+    PushOutcome outcome = classify(post(body.get(), size));
+    heapScope.sample();
+    noteOutcome(outcome);
+    if (outcome == PUSH_RETRY) return;
+    if (outcome == PUSH_OK) segmentsDrained++;
+    else segmentsDropped++;
+    dropOldestSegment();
+    saveBacklogIndex();
+    if (backlog.count == 0) web_log_printf("[Metrics push] Backlog drained");
+}
+
+void metricsPushRecord(int index) {
+    if (!isEnabled()) return;
+    if (pendingCount >= METRICS_PUSH_MAX_BATCH) {
+        resultsDropped++;  // Only if the loop could not flush for a whole batch
+        return;
+    }
+    PushRecord& r = pending[pendingCount++];
+    r.unix_time = clockNow();
+    r.millis = hal_millis();
+    r.latency_ms = pingTime[index];
+    r.code = (int16_t)httpCode[index];
+    r.target = (uint16_t)index;
+    resultsQueued++;
+}
+
+void metricsPushPoll() {
+    if (configPending) applyPendingConfig();
+    if (!isEnabled()) return;
+    // At most one request per loop pass: a due batch first, else one backlog segment
+    if (pendingCount > 0 && (pendingCount >= metricsPush.batch_size ||
+                             hal_millis() - lastFlush >= metricsPush.interval_seconds * 1000UL)) {
+        flushPending();
+    } else if (backlog.count > 0 && canSend() && hal_millis() - lastDrain >= METRICS_PUSH_DRAIN_SPACING_MS) {
+        drainOneSegment();
+    }
+}
+
+// --- Status ---
+
+void buildMetricsPushJson(JsonObject root) {
+    root["enabled"] = isEnabled();
+    root["interval"] = metricsPush.interval_seconds;
+    root["batch_size"] = metricsPush.batch_size;
+    root["queued"] = pendingCount;
+    root["last_status"] = lastStatus;
+    if (lastSuccess) root["last_success_seconds_ago"] = (hal_millis() - lastSuccess) / 1000;
+    else root["last_success_seconds_ago"] = nullptr;
+    long wait = retryAt ? (long)(retryAt - hal_millis()) : 0;
+    root["retry_in_seconds"] = wait > 0 ? wait / 1000 : 0;
+
+    JsonObject segments = root.createNestedObject("backlog");
+    segments["segments"] = backlog.count;
+    segments["bytes"] = backlogBytes;
+    segments["max_segments"] = METRICS_PUSH_BACKLOG_SEGMENTS;
+    segments["max_bytes"] = METRICS_PUSH_BACKLOG_MAX_BYTES;
+
+    JsonObject counters = root.createNestedObject("counters");
+    counters["results_queued"] = resultsQueued;
+    counters["results_dropped"] = resultsDropped;
+    counters["batches_sent"] = batchesSent;
+    counters["batches_spilled"] = batchesSpilled;
+    counters["segments_drained"] = segmentsDrained;
+    counters["segments_dropped"] = segmentsDropped;
+}
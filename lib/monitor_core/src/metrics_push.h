@@ -0,0 +1,67 @@
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+#include <ArduinoJson.h>
+
+// --- Metrics push (InfluxDB line protocol) ---
+// Every check result is queued in RAM and pushed to a time-series collector
+// (InfluxDB, VictoriaMetrics, anything with an Influx /write endpoint) in one
+// POST per batch: every interval_seconds, or as soon as batch_size results
+// are queued. A batch that cannot be sent (WiFi down, collector unreachable
+// or answering 5xx/429) is appended to a backlog on LittleFS: segment files
+// of about METRICS_PUSH_SEGMENT_BYTES, bounded by METRICS_PUSH_BACKLOG_MAX_BYTES,
+// oldest segments dropped first. Once pushes succeed again the backlog is drained
+// one segment per METRICS_PUSH_DRAIN_SPACING_MS, and draining stops at the
+// first failure, so a recovering collector is not flooded and checks keep
+// their slots in the loop.
+//
+//   uptime_check,id=3,name=Web\ API,group=Production up=1i,code=200i,latency_ms=42i 1763370000000000000
+
+const uint8_t METRICS_PUSH_MAX_BATCH = 32;
+const uint8_t METRICS_PUSH_BACKLOG_SEGMENTS = 32;
+const uint32_t METRICS_PUSH_BACKLOG_MAX_BYTES = 128UL * 1024;
+const uint32_t METRICS_PUSH_SEGMENT_BYTES = METRICS_PUSH_BACKLOG_MAX_BYTES / METRICS_PUSH_BACKLOG_SEGMENTS;
+const uint32_t METRICS_PUSH_DRAIN_SPACING_MS = 1000;
+const uint32_t METRICS_PUSH_MAX_BACKOFF_MS = 300000;
+const size_t METRICS_PUSH_LINE_SIZE = 256;  // Longest line: fully escaped name and group
+
+struct MetricsPushConfig {
+    char url[160];            // Write endpoint, e.g. http://influx:8086/api/v2/write?org=o&bucket=b; "0" = off
+    char authorization[96];   // Authorization header value ("Token ...", "Bearer ..."); "0" = none
+    uint16_t interval_seconds;
+    uint8_t batch_size;
+};
+
+extern MetricsPushConfig metricsPush;
+
+// "metrics_push" object of config.json (missing object = off)
+void metricsPushConfigFromJson(JsonObjectConst json);
+void metricsPushConfigToJson(JsonObject json);
+bool metricsPushConfigured();  // Whether there is a URL to save (a staged change included)
+
+// POST /api/metrics/push: validate and stage the change; metricsPushPoll()
+// applies it on the loop task, which is the one posting with the current
+// URL and token. The staged change is what saveConfig() writes (the caller
+// runs it). Returns an error message or nullptr.
+const char* setMetricsPushFromJson(JsonObjectConst json);
+
+// Pick up the backlog left on flash by a previous boot
+void metricsPushBegin();
+
+// Delete the backlog (resetToDefault())
+void metricsPushClearBacklog();
+
+// Queue the result processCheckResult() just recorded for the target
+void metricsPushRecord(int index);
+
+// Send a due batch or one backlog segment; called from monitorLoop() whether
+// or not the network is up (batches are spilled while it is down)
+void metricsPushPoll();
+
+// One result as a line protocol line (newline included). unixTime 0 omits
+// the timestamp, so the collector uses its arrival time. Returns the length.
+size_t formatPushLine(char* out, size_t size, int index, int code, uint32_t latencyMs, uint32_t unixTime);
+
+// GET /api/metrics/push
+void buildMetricsPushJson(JsonObject root);
@@ -0,0 +1,408 @@
+#include "monitor_config.h"
+
+#include <stdio.h>
+#include <string.h>
+#include <memory>
+
+#include "alert_queue.h"
+#include "config_migration.h"
+#include "diagnostics.h"
+#include "federation.h"
+#include "group_index.h"
+#include "metrics_push.h"
+#include "monitor_hal.h"
+#include "monitor_state.h"
+#include "notifications.h"
+#include "status_snapshot.h"
+#include "text_util.h"
+#include "uptime_stats.h"
+#include "web_log.h"
+
+// --- Global variables for operation ---
+int gmt_offset = 1; // Default GMT offset
+int coalesce_window = DEFAULT_COALESCE_WINDOW;
+long gmtOffset_sec;
+const char* ntpServer = "pool.ntp.org";
+TargetConfig targets[NUM_TARGETS];
+
+// Minimal ArduinoJson writer that streams straight into a HAL file
+struct HalFileWriter {
+    HalFile* file;
+    size_t write(uint8_t c) { return hal_fs_write(file, &c, 1); }
+    size_t write(const uint8_t* buffer, size_t length) { return hal_fs_write(file, buffer, length); }
+};
+
+// Copy a config this firmware cannot migrate to /config.v<version>.json, so
+// the defaults saved over /config.json do not destroy it; a firmware that
+// reads that version can still be given the file back
+static bool keepUnmigratedConfig(int version) {
+    char path[32];
+    snprintf(path, sizeof(path), "/config.v%d.json", version);
+    HalFile* in = hal_fs_open("/config.json", "r");
+    if (!in) return false;
+    HalFile* out = hal_fs_open(path, "w");
+    if (!out) {
+        hal_fs_close(in);
+        return false;
+    }
+    char chunk[256];
+    size_t n;
+    bool ok = true;
+    while (ok && (n = hal_fs_read(in, chunk, sizeof(chunk))) > 0) ok = hal_fs_write(out, chunk, n) == n;
+    hal_fs_close(out);
+    hal_fs_close(in);
+    if (ok) console_printf("Kept the unmigrated config as %s\n", path);
+    else hal_fs_remove(path);
+    return ok;
+}
+
+void resetToDefault() {
+    hal_console_write("Resetting to default values...\n");
+
+    hal_store_config_version(CONFIG_VERSION);
+
+    // Clear LittleFS config
+    if (hal_fs_exists("/config.json")) {
+        hal_fs_remove("/config.json");
+        hal_console_write("LittleFS config cleared.\n");
+    }
+    if (hal_fs_exists("/uptime.bin")) {
+        hal_fs_remove("/uptime.bin");
+    }
+    metricsPushClearBacklog();
+    alertQueueClear();
+
+    // NOTE: WiFi credentials are NOT cleared here
+    // WiFiManager stores credentials in NVS independently of app config
+    // WiFi credentials should persist across app config version changes
+    // Use factoryReset() function instead if you need to clear WiFi credentials
+
+    hal_console_write("App settings reset to defaults (WiFi credentials preserved).\n");
+}
+
+void loadConfig() {
+    HeapScope heapScope(HEAP_CONFIG);
+    bool configLoaded = false;
+    bool migrationFailed = false;
+    int fileVersion = CONFIG_VERSION;
+
+    // Load configuration from LittleFS
+    if (hal_fs_exists("/config.json")) {
+        HalFile* configFile = hal_fs_open("/config.json", "r");
+        if (configFile) {
+            hal_console_write("Reading config file\n");
+            size_t size = hal_fs_size(configFile);
+            std::unique_ptr<char[]> buf(new char[size + 1]);
+            size = hal_fs_read(configFile, buf.get(), size);
+            buf[size] = '\0';
+
+            DynamicJsonDocument json(CONFIG_JSON_CAPACITY);
+
+            if (deserializeJson(json, buf.get(), size) == DeserializationError::Ok) {
+                heapScope.sample();
+                heapScope.noteBuffer(CONFIG_JSON_CAPACITY, json.memoryUsage());
+                hal_console_write("Successfully parsed config\n");
+                // Files without a version were written by hand for this firmware
+                fileVersion = json["config_version"] | CONFIG_VERSION;
+                const char* migrationError = migrateConfig(json, fileVersion);
+                if (migrationError) {
+                    // Nothing below is read from an unusable schema, so the defaults apply
+                    console_printf("Cannot migrate config from version %d: %s\n", fileVersion, migrationError);
+                    json.clear();
+                    migrationFailed = true;
+                } else if (fileVersion != CONFIG_VERSION) {
+                    console_printf("Migrated config from version %d to %d\n", fileVersion, CONFIG_VERSION);
+                }
+                gmt_offset = json["gmt_offset"] | 1;
+                console_printf("Loaded GMT offset: %d\n", gmt_offset);
+                coalesce_window = json["coalesce_window"] | DEFAULT_COALESCE_WINDOW;
+                if (coalesce_window < 0 || coalesce_window > MAX_COALESCE_WINDOW) coalesce_window = DEFAULT_COALESCE_WINDOW;
+                federationConfigFromJson(json["federation"]);
+                metricsPushConfigFromJson(json["metrics_push"]);
+
+                // Load server configurations
+                JsonArray servers = json["servers"];
+                if (servers) {
+                    int loadedCount = 0;
+                    for (JsonObject server : servers) {
+                        int i = server["id"] | loadedCount;
+                        if (i >= 0 && i < NUM_TARGETS) {
+                            safeStrcpy(targets[i].server_name, server["name"] | "", sizeof(targets[i].server_name));
+                            safeStrcpy(targets[i].group_name, server["group"] | "Default", sizeof(targets[i].group_name));
+                            safeStrcpy(targets[i].weburl, server["url"] | "0", sizeof(targets[i].weburl));
+                            targets[i].enabled = server["enabled"] | false;
+                            targets[i].check_interval_seconds = server["check_interval"] | 20;
+                            targets[i].retry_interval_seconds = server["retry_interval"] | DEFAULT_RETRY_INTERVAL;
+                            targets[i].max_check_interval_seconds = server["max_check_interval"] | targets[i].check_interval_seconds;
+                            targets[i].failure_threshold = server["failure_threshold"] | 3;
+                            targets[i].recovery_threshold = server["recovery_threshold"] | 2;
+                            targets[i].parent_id = server["parent"] | -1;
+                            targets[i].latency_threshold_ms = server["latency_threshold"] | 0;
+                            targets[i].latency_deviations = server["latency_deviations"] | 0;
+                            targets[i].latency_slow_checks = server["latency_slow_checks"] | 0;
+                            targets[i].latency_recovery_checks = server["latency_recovery_checks"] | 0;
+
+                            safeStrcpy(targets[i].discord_webhook_url, server["discord_webhook"] | "0", sizeof(targets[i].discord_webhook_url));
+                            safeStrcpy(targets[i].ntfy_url, server["ntfy_url"] | "0", sizeof(targets[i].ntfy_url));
+                            safeStrcpy(targets[i].ntfy_priority, server["ntfy_priority"] | "default", sizeof(targets[i].ntfy_priority));
+                            safeStrcpy(targets[i].telegram_bot_token, server["telegram_token"] | "0", sizeof(targets[i].telegram_bot_token));
+                            safeStrcpy(targets[i].telegram_chat_id_1, server["telegram_chat1"] | "0", sizeof(targets[i].telegram_chat_id_1));
+                            safeStrcpy(targets[i].telegram_chat_id_2, server["telegram_chat2"] | "0", sizeof(targets[i].telegram_chat_id_2));
+                            safeStrcpy(targets[i].telegram_chat_id_3, server["telegram_chat3"] | "0", sizeof(targets[i].telegram_chat_id_3));
+                            safeStrcpy(targets[i].http_get_url_on, server["http_url_on"] | "0", sizeof(targets[i].http_get_url_on));
+                            safeStrcpy(targets[i].http_get_url_off, server["http_url_off"] | "0", sizeof(targets[i].http_get_url_off));
+                            safeStrcpy(targets[i].online_message, server["msg_online"] | "✅ {NAME} is back online: {URL}", sizeof(targets[i].online_message));
+                            safeStrcpy(targets[i].offline_message, server["msg_offline"] | "🚨 {NAME} OUTAGE: {URL} (Code: {CODE})", sizeof(targets[i].offline_message));
+
+                            loadedCount++;
+                        }
+                    }
+                    console_printf("Loaded %d servers from config\n", loadedCount);
+                    configLoaded = true;
+                }
+            } else {
+                hal_console_write("Failed to parse JSON config\n");
+            }
+            hal_fs_close(configFile);
+        }
+    }
+    // Without a copy the file stays as it is until the next save from the API
+    bool keepFile = migrationFailed && !keepUnmigratedConfig(fileVersion);
+
+    // Initialize with defaults if no config exists
+    if (!configLoaded) {
+        hal_console_write("Initializing default configuration\n");
+        for (int i = 0; i < NUM_TARGETS; i++) {
+            char name[32];
+            snprintf(name, sizeof(name), "Server %d", i + 1);
+            safeStrcpy(targets[i].server_name, name, sizeof(targets[i].server_name));
+            strcpy(targets[i].group_name, (i < 3) ? "Production" : "Staging");
+            strcpy(targets[i].weburl, (i == 0) ? "http://localhost" : "0");
+            targets[i].enabled = (i < 3);  // Only first 3 enabled by default
+
+            strcpy(targets[i].discord_webhook_url, "0");
+            strcpy(targets[i].ntfy_url, "0");
+            strcpy(targets[i].ntfy_priority, "default");
+            strcpy(targets[i].telegram_bot_token, "0");
+            strcpy(targets[i].telegram_chat_id_1, "0");
+            strcpy(targets[i].telegram_chat_id_2, "0");
+            strcpy(targets[i].telegram_chat_id_3, "0");
+            strcpy(targets[i].http_get_url_on, "0");
+            strcpy(targets[i].http_get_url_off, "0");
+            safeStrcpy(targets[i].online_message, "✅ {NAME} is back online: {URL}", sizeof(targets[i].online_message));
+            safeStrcpy(targets[i].offline_message, "🚨 {NAME} OUTAGE: {URL} (Code: {CODE})", sizeof(targets[i].offline_message));
+            targets[i].check_interval_seconds = 20;
+            targets[i].retry_interval_seconds = DEFAULT_RETRY_INTERVAL;
+            targets[i].max_check_interval_seconds = 20;
+            targets[i].failure_threshold = 3;
+            targets[i].recovery_threshold = 2;
+            targets[i].parent_id = -1;
+            targets[i].latency_threshold_ms = 0;
+            targets[i].latency_deviations = 0;
+            targets[i].latency_slow_checks = 0;
+            targets[i].latency_recovery_checks = 0;
+        }
+        // Save the default config
+        if (keepFile) console_printf("Cannot copy the unmigrated config; not overwriting /config.json\n");
+        else saveConfig();
+    } else if (fileVersion != CONFIG_VERSION) {
+        // Write the migrated schema back so the next boot reads it directly
+        saveConfig();
+    }
+
+    for (int i = 0; i < NUM_TARGETS; i++) compileMessageTemplates(i);
+    groupIndexRebuild();
+    statusChanged();
+
+    gmtOffset_sec = gmt_offset * 3600;
+}
+
+void saveConfig() {
+    hal_console_write("Saving config to LittleFS\n");
+    HeapScope heapScope(HEAP_CONFIG);
+    statusChanged();  // Every config mutation ends here
+
+    DynamicJsonDocument json(CONFIG_JSON_CAPACITY);
+
+    json["gmt_offset"] = gmt_offset;
+    json["coalesce_window"] = coalesce_window;
+    json["config_version"] = CONFIG_VERSION;
+    if (federationConfigured()) {
+        federationConfigToJson(json.createNestedObject("federation"));
+    }
+    if (metricsPushConfigured()) metricsPushConfigToJson(json.createNestedObject("metrics_push"));
+
+    // Create servers array
+    JsonArray servers = json.createNestedArray("servers");
+
+    for (int i = 0; i < NUM_TARGETS; i++) {
+        // Only save enabled servers or those with configuration
+        if (targets[i].enabled || strlen(targets[i].weburl) > 1) {
+            JsonObject server = servers.createNestedObject();
+
+            server["id"] = i;
+            server["name"] = targets[i].server_name;
+            server["group"] = targets[i].group_name;
+            server["url"] = targets[i].weburl;
+            server["enabled"] = targets[i].enabled;
+            server["check_interval"] = targets[i].check_interval_seconds;
+            server["retry_interval"] = targets[i].retry_interval_seconds;
+            server["max_check_interval"] = targets[i].max_check_interval_seconds;
+            server["failure_threshold"] = targets[i].failure_threshold;
+            server["recovery_threshold"] = targets[i].recovery_threshold;
+            server["parent"] = targets[i].parent_id;
+            server["latency_threshold"] = targets[i].latency_threshold_ms;
+            server["latency_deviations"] = targets[i].latency_deviations;
+            server["latency_slow_checks"] = targets[i].latency_slow_checks;
+            server["latency_recovery_checks"] = targets[i].latency_recovery_checks;
+
+            server["discord_webhook"] = targets[i].discord_webhook_url;
+            server["ntfy_url"] = targets[i].ntfy_url;
+            server["ntfy_priority"] = targets[i].ntfy_priority;
+            server["telegram_token"] = targets[i].telegram_bot_token;
+            server["telegram_chat1"] = targets[i].telegram_chat_id_1;
+            server["telegram_chat2"] = targets[i].telegram_chat_id_2;
+            server["telegram_chat3"] = targets[i].telegram_chat_id_3;
+            server["http_url_on"] = targets[i].http_get_url_on;
+            server["http_url_off"] = targets[i].http_get_url_off;
+            server["msg_online"] = targets[i].online_message;
+            server["msg_offline"] = targets[i].offline_message;
+        }
+    }
+
+    heapScope.noteBuffer(CONFIG_JSON_CAPACITY, json.memoryUsage());
+
+    HalFile* configFile = hal_fs_open("/config.json", "w");
+    heapScope.sample();
+    if (!configFile) {
+        hal_console_write("Failed to open config file for writing\n");
+        return;
+    }
+
+    HalFileWriter writer = {configFile};
+    size_t bytesWritten = serializeJson(json, writer);
+    hal_fs_close(configFile);
+
+    if (bytesWritten == 0) {
+        hal_console_write("Failed to write JSON to file\n");
+    } else {
+        console_printf("Config saved (%u bytes)\n", (unsigned)bytesWritten);
+    }
+
+    // Update version in EEPROM for compatibility checking
+    hal_store_config_version(CONFIG_VERSION);
+}
+
+// A parent must be another slot and must not depend on the target itself
+static const char* validateParent(int id, int parent) {
+    if (parent == -1) return nullptr;
+    if (parent < 0 || parent >= NUM_TARGETS) return "Invalid parent ID";
+    for (int p = parent, depth = 0; p >= 0 && p < NUM_TARGETS && depth < NUM_TARGETS; p = targets[p].parent_id, depth++) {
+        if (p == id) return "Parent would create a dependency cycle";
+    }
+    return nullptr;
+}
+
+const char* addTargetFromJson(JsonObjectConst json, int* slotOut) {
+    // Find first available slot
+    int slot = -1;
+    for (int i = 0; i < NUM_TARGETS; i++) {
+        if (!targets[i].enabled && strlen(targets[i].weburl) <= 1) {
+            slot = i;
+            break;
+        }
+    }
+    if (slot < 0) return "No available slots";
+    int parent = json["parent"] | -1;
+    const char* error = validateParent(slot, parent);
+    if (error) return error;
+
+    safeStrcpy(targets[slot].server_name, json["name"] | "", sizeof(targets[slot].server_name));
+    safeStrcpy(targets[slot].group_name, json["group"] | "Default", sizeof(targets[slot].group_name));
+    safeStrcpy(targets[slot].weburl, json["url"] | "0", sizeof(targets[slot].weburl));
+    targets[slot].enabled = true;
+    targets[slot].check_interval_seconds = json["check_interval"] | 60;
+    targets[slot].retry_interval_seconds = json["retry_interval"] | DEFAULT_RETRY_INTERVAL;
+    targets[slot].max_check_interval_seconds = json["max_check_interval"] | targets[slot].check_interval_seconds;
+    targets[slot].failure_threshold = json["failure_threshold"] | 3;
+    targets[slot].recovery_threshold = json["recovery_threshold"] | 2;
+    targets[slot].parent_id = parent;
+    targets[slot].latency_threshold_ms = json["latency_threshold"] | 0;
+    targets[slot].latency_deviations = json["latency_deviations"] | 0;
+    targets[slot].latency_slow_checks = json["latency_slow_checks"] | 0;
+    targets[slot].latency_recovery_checks = json["latency_recovery_checks"] | 0;
+    safeStrcpy(targets[slot].online_message, json["online_message"] | "{NAME} is back online!", sizeof(targets[slot].online_message));
+    safeStrcpy(targets[slot].offline_message, json["offline_message"] | "{NAME} is down!", sizeof(targets[slot].offline_message));
+    compileMessageTemplates(slot);
+    resetTargetRuntime(slot);
+    groupIndexUpdate(slot);
+
+    if (slotOut) *slotOut = slot;
+    return nullptr;
+}
+
+const char* updateTargetFromJson(JsonObjectConst json) {
+    int id = json["id"] | -1;
+    if (id < 0 || id >= NUM_TARGETS) return "Invalid server ID";
+    if (json.containsKey("parent")) {
+        const char* error = validateParent(id, json["parent"] | -1);
+        if (error) return error;
+        targets[id].parent_id = json["parent"] | -1;
+    }
+
+    if (json.containsKey("name")) safeStrcpy(targets[id].server_name, json["name"] | "", sizeof(targets[id].server_name));
+    if (json.containsKey("group")) safeStrcpy(targets[id].group_name, json["group"] | "", sizeof(targets[id].group_name));
+    if (json.containsKey("url") && strcmp(targets[id].weburl, json["url"] | "") != 0) {
+        safeStrcpy(targets[id].weburl, json["url"] | "", sizeof(targets[id].weburl));
+        resetLatencyState(id);  // The old URL's baseline says nothing about the new one
+    }
+    if (json.containsKey("enabled")) targets[id].enabled = json["enabled"];
+    if (json.containsKey("check_interval")) targets[id].check_interval_seconds = json["check_interval"];
+    if (json.containsKey("retry_interval")) targets[id].retry_interval_seconds = json["retry_interval"];
+    if (json.containsKey("max_check_interval")) targets[id].max_check_interval_seconds = json["max_check_interval"];
+    if (json.containsKey("failure_threshold")) targets[id].failure_threshold = json["failure_threshold"];
+    if (json.containsKey("recovery_threshold")) targets[id].recovery_threshold = json["recovery_threshold"];
+    if (json.containsKey("latency_threshold")) targets[id].latency_threshold_ms = json["latency_threshold"];
+    if (json.containsKey("latency_deviations")) targets[id].latency_deviations = json["latency_deviations"];
+    if (json.containsKey("latency_slow_checks")) targets[id].latency_slow_checks = json["latency_slow_checks"];
+    if (json.containsKey("latency_recovery_checks")) targets[id].latency_recovery_checks = json["latency_recovery_checks"];
+    if (json.containsKey("online_message")) safeStrcpy(targets[id].online_message, json["online_message"] | "", sizeof(targets[id].online_message));
+    if (json.containsKey("offline_message")) safeStrcpy(targets[id].offline_message, json["offline_message"] | "", sizeof(targets[id].offline_message));
+    if (json.containsKey("discord_webhook")) safeStrcpy(targets[id].discord_webhook_url, json["discord_webhook"] | "", sizeof(targets[id].discord_webhook_url));
+    if (json.containsKey("ntfy_url")) safeStrcpy(targets[id].ntfy_url, json["ntfy_url"] | "", sizeof(targets[id].ntfy_url));
+    if (json.containsKey("ntfy_priority")) safeStrcpy(targets[id].ntfy_priority, json["ntfy_priority"] | "", sizeof(targets[id].ntfy_priority));
+    if (json.containsKey("telegram_bot_token")) safeStrcpy(targets[id].telegram_bot_token, json["telegram_bot_token"] | "", sizeof(targets[id].telegram_bot_token));
+    if (json.containsKey("telegram_chat_id_1")) safeStrcpy(targets[id].telegram_chat_id_1, json["telegram_chat_id_1"] | "", sizeof(targets[id].telegram_chat_id_1));
+    if (json.containsKey("telegram_chat_id_2")) safeStrcpy(targets[id].telegram_chat_id_2, json["telegram_chat_id_2"] | "", sizeof(targets[id].telegram_chat_id_2));
+    if (json.containsKey("telegram_chat_id_3")) safeStrcpy(targets[id].telegram_chat_id_3, json["telegram_chat_id_3"] | "", sizeof(targets[id].telegram_chat_id_3));
+    if (json.containsKey("http_get_url_on")) safeStrcpy(targets[id].http_get_url_on, json["http_get_url_on"] | "", sizeof(targets[id].http_get_url_on));
+    if (json.containsKey("http_get_url_off")) safeStrcpy(targets[id].http_get_url_off, json["http_get_url_off"] | "", sizeof(targets[id].http_get_url_off));
+    compileMessageTemplates(id);
+    groupIndexUpdate(id);
+    return nullptr;
+}
+
+const char* deleteTarget(int id) {
+    if (id < 0 || id >= NUM_TARGETS) return "Invalid server ID";
+    targets[id].enabled = false;
+    strcpy(targets[id].weburl, "0");
+    targets[id].parent_id = -1;
+    for (int i = 0; i < NUM_TARGETS; i++) {
+        if (targets[i].parent_id == id) targets[i].parent_id = -1;
+    }
+    resetTargetRuntime(id);
+    groupIndexUpdate(id);
+    return nullptr;
+}
+
+int renameGroup(const char* oldName, const char* newName) {
+    int updated = 0;
+    for (int i = 0; i < NUM_TARGETS; i++) {
+        if (strcmp(targets[i].group_name, oldName) == 0) {
+            safeStrcpy(targets[i].group_name, newName, sizeof(targets[i].group_name));
+            updated++;
+        }
+    }
+    if (updated) groupIndexRename(oldName, newName);
+    return updated;
+}
@@ -0,0 +1,78 @@
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+#include <ArduinoJson.h>
+
+// --- Configuration Version ---
+const int CONFIG_VERSION = 14;  // Incremented for breaking changes (add a step in config_migration.cpp)
+// Slot count can be overridden at build time (host benchmarks use 100 and 500)
+#ifndef MONITOR_NUM_TARGETS
+#define MONITOR_NUM_TARGETS 20
+#endif
+const int NUM_TARGETS = MONITOR_NUM_TARGETS;  // Increased from 3 to 20
+
+// JSON document capacities scale with the slot count (11KB / 18KB for 20 servers;
+// the config also holds the federation and metrics push settings)
+const size_t CONFIG_JSON_CAPACITY = 544UL * NUM_TARGETS + 1024;
+const size_t STATUS_JSON_CAPACITY = 18432UL * NUM_TARGETS / 20;
+
+// Re-probe interval after a first failed check, so failure_threshold is
+// confirmed within seconds instead of failure_threshold x check_interval
+const uint16_t DEFAULT_RETRY_INTERVAL = 5;
+
+// Targets with the same URL due within this many seconds of a probe share
+// its result (0 = every target sends its own request)
+const int DEFAULT_COALESCE_WINDOW = 5;
+const int MAX_COALESCE_WINDOW = 300;
+
+// --- Data Structure for a single target ---
+struct TargetConfig {
+    char server_name[32];
+    char group_name[32];  // NEW: Group/tab name for organization
+    char weburl[128];
+    char discord_webhook_url[128];
+    char ntfy_url[64];
+    char ntfy_priority[16];
+    char telegram_bot_token[50];
+    char telegram_chat_id_1[16];
+    char telegram_chat_id_2[16];
+    char telegram_chat_id_3[16];
+    char http_get_url_on[128];
+    char http_get_url_off[128];
+    char online_message[128];
+    char offline_message[128];
+    uint16_t check_interval_seconds;
+    uint16_t retry_interval_seconds;      // Re-probe interval while a failure/recovery is unconfirmed (0 = check_interval)
+    uint16_t max_check_interval_seconds;  // Back-off ceiling for stable targets (<= check_interval: no back-off)
+    uint8_t failure_threshold;
+    uint8_t recovery_threshold;
+    int16_t parent_id;  // Target this one depends on (gateway, reverse proxy); -1 = none
+    uint16_t latency_threshold_ms;  // Checks slower than this are slow (0 = no latency SLO)
+    uint8_t latency_deviations;     // Slow above baseline + this many deviations (0 = no baseline alerts)
+    uint8_t latency_slow_checks;      // Slow checks in a row that mark it degraded (0 = failure_threshold)
+    uint8_t latency_recovery_checks;  // Normal checks in a row that clear it (0 = recovery_threshold)
+    bool enabled;  // NEW: Whether this server is active
+};
+
+// --- Global configuration ---
+extern int gmt_offset;
+extern int coalesce_window;  // Seconds; see DEFAULT_COALESCE_WINDOW
+extern long gmtOffset_sec;
+extern const char* ntpServer;
+extern TargetConfig targets[NUM_TARGETS];
+
+void loadConfig();
+void saveConfig();
+
+// Clear app settings (config file, uptime counters, stored version).
+// WiFi credentials are platform state and are not touched.
+void resetToDefault();
+
+// --- Target mutations shared by the REST handlers ---
+// Each returns a short error message on failure, nullptr on success.
+// None of them persist; callers run saveConfig() once they are done.
+const char* addTargetFromJson(JsonObjectConst json, int* slotOut);
+const char* updateTargetFromJson(JsonObjectConst json);
+const char* deleteTarget(int id);
+int renameGroup(const char* oldName, const char* newName);
@@ -0,0 +1,109 @@
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+#include <time.h>
+
+// --- Platform abstraction layer ---
+// The monitoring core only reaches the hardware through these functions.
+// src/hal_esp32.cpp implements them on Arduino/ESP-IDF (HTTPClient, WiFi,
+// LittleFS, EEPROM), src/native/hal/hal_posix.cpp on Linux (POSIX sockets,
+// in-memory filesystem) so the core can be built and profiled on a workstation.
+
+// --- Clock ---
+uint32_t hal_millis();
+void hal_delay(uint32_t ms);
+void hal_configure_time(long gmtOffsetSec, const char* ntpServer);
+bool hal_local_time(struct tm* timeinfo);  // false while wall-clock time is unknown
+uint32_t hal_cycle_count();   // Free-running 32-bit CPU cycle counter (wraps)
+uint32_t hal_cycles_per_us();
+uint32_t hal_random();         // 32 random bits, different on every boot
+
+// --- Console ---
+void hal_console_write(const char* text);
+
+// --- Network ---
+bool hal_network_connected();
+void hal_network_reconnect();
+int hal_network_rssi();
+void hal_network_ssid(char* buf, size_t size);
+
+// --- Memory ---
+struct HalHeapStats {
+    uint32_t free_bytes;
+    uint32_t min_free_bytes;
+    uint32_t max_alloc_bytes;
+};
+void hal_heap_stats(HalHeapStats* stats);  // All zero where the platform has no such figures
+uint32_t hal_stack_min_free_bytes();  // Stack high-water mark of the calling task (0 if unknown)
+
+// --- HTTP client ---
+// Error codes mirror the negative values returned by the ESP32 HTTPClient
+const int HAL_HTTP_ERROR_CONNECTION_REFUSED = -1;
+const int HAL_HTTP_ERROR_SEND_FAILED = -3;
+const int HAL_HTTP_ERROR_CONNECTION_LOST = -5;
+const int HAL_HTTP_ERROR_READ_TIMEOUT = -11;
+
+struct HalHttpRequest {
+    const char* method;        // "GET" or "POST"
+    const char* url;
+    const char* content_type;  // nullptr when there is no body
+    const char* header_name;   // Optional extra header (e.g. ntfy "Priority")
+    const char* header_value;
+    const char* body;
+    size_t body_len;
+    uint32_t timeout_ms;
+    bool follow_redirects;
+    // Optional: receives the wait the server asked for, from Retry-After (any
+    // status) or X-RateLimit-Reset-After once X-RateLimit-Remaining is 0
+    // (Discord); 0 when there is none
+    uint32_t* retry_after_ms;
+};
+
+// Perform a request and return the HTTP status code, or a negative error code
+int hal_http_request(const HalHttpRequest& request);
+
+// --- Streaming download (pull OTA) ---
+// A GET whose body is consumed piecemeal across loop passes. Only opening
+// blocks (connect, request, response headers; up to timeout_ms).
+struct HalDownload;  // Opaque, defined by each platform
+
+// nullptr unless the server answered 200; *status gets the HTTP status or a
+// negative error code, *length the Content-Length (-1 when not sent)
+HalDownload* hal_download_open(const char* url, uint32_t timeout_ms, int* status, int32_t* length);
+// Body bytes that have already arrived, up to size, without waiting: their
+// count, 0 when none yet, -1 at the end of the body or on a broken connection
+int hal_download_read(HalDownload* download, uint8_t* buf, size_t size);
+void hal_download_close(HalDownload* download);
+
+// --- Firmware update (inactive OTA partition on the ESP32) ---
+bool hal_update_begin(uint32_t size);
+bool hal_update_write(const uint8_t* data, size_t len);
+bool hal_update_end();    // Check the image and boot from it next time
+void hal_update_abort();  // Discard a partial image; the running firmware stays
+void hal_restart();
+
+// --- UDP (federation) ---
+// One datagram socket, bound on all interfaces. Sends resolve host names.
+bool hal_udp_begin(uint16_t port);  // (Re)bind; false on failure
+void hal_udp_end();
+bool hal_udp_send(const char* host, uint16_t port, const uint8_t* data, size_t len);
+bool hal_resolve_ipv4(const char* host, char* ip, size_t size);  // Dotted quad of host; false if unknown
+// Next pending datagram without blocking: its length (0 = none). from gets
+// the sender as "ip:port"; datagrams longer than size are truncated.
+size_t hal_udp_receive(uint8_t* buf, size_t size, char* from, size_t fromSize);
+
+// --- Filesystem ---
+struct HalFile;  // Opaque, defined by each platform
+
+HalFile* hal_fs_open(const char* path, const char* mode);  // mode "r", "w" or "a"; nullptr on failure
+size_t hal_fs_read(HalFile* file, void* buf, size_t len);
+size_t hal_fs_write(HalFile* file, const void* buf, size_t len);
+size_t hal_fs_size(HalFile* file);
+void hal_fs_close(HalFile* file);
+bool hal_fs_exists(const char* path);
+bool hal_fs_remove(const char* path);
+
+// --- Persistent config version (EEPROM on the ESP32) ---
+int hal_stored_config_version();
+void hal_store_config_version(int version);
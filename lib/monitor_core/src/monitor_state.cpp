@@ -0,0 +1,295 @@
+#include "monitor_state.h"
+
+#include <stdio.h>
+#include <string.h>
+
+#include "federation.h"
+#include "group_index.h"
+#include "latency_baseline.h"
+#include "monitor_hal.h"
+#include "notifications.h"
+#include "status_snapshot.h"
+#include "uptime_stats.h"
+#include "web_log.h"
+
+int httpCode[NUM_TARGETS] = {0};
+unsigned long pingTime[NUM_TARGETS] = {0};
+unsigned long minpingTime[NUM_TARGETS] = {0};
+unsigned long maxpingTime[NUM_TARGETS] = {0};
+unsigned long last_check_time[NUM_TARGETS] = {0};
+uint8_t failure_count[NUM_TARGETS] = {0};
+uint8_t success_count[NUM_TARGETS] = {0};
+bool confirmed_online_state[NUM_TARGETS];
+bool local_down[NUM_TARGETS] = {false};
+unsigned long first_failure_time[NUM_TARGETS] = {0};
+unsigned long offline_since[NUM_TARGETS] = {0};
+uint16_t effective_interval[NUM_TARGETS] = {0};
+uint8_t stable_checks[NUM_TARGETS] = {0};
+bool alert_held[NUM_TARGETS] = {false};
+uint32_t total_checks[NUM_TARGETS] = {0};
+uint32_t total_failures[NUM_TARGETS] = {0};
+bool degraded[NUM_TARGETS] = {false};
+uint8_t slow_count[NUM_TARGETS] = {0};
+uint8_t fast_count[NUM_TARGETS] = {0};
+
+char targetLogMessages[NUM_TARGETS][TARGET_LOG_SIZE];
+
+// Every target starts out assumed online so its first outage is reported.
+// (A "= {true}" initializer would only cover the first slot.)
+static bool initConfirmedOnlineState() {
+    for (int i = 0; i < NUM_TARGETS; i++) confirmed_online_state[i] = true;
+    return true;
+}
+static const bool confirmedOnlineStateInitialized = initConfirmedOnlineState();
+
+void updatePingStats(int index) {
+    if (pingTime[index] < minpingTime[index] || minpingTime[index] == 0) minpingTime[index] = pingTime[index];
+    if (pingTime[index] > maxpingTime[index]) maxpingTime[index] = pingTime[index];
+}
+
+static uint16_t retryInterval(const TargetConfig& target) {
+    uint16_t retry = target.retry_interval_seconds;
+    return (retry > 0 && retry < target.check_interval_seconds) ? retry : target.check_interval_seconds;
+}
+
+// Visits enabled ancestors nearest first until fn returns true; the depth
+// limit guards against cycles in a hand-edited config
+static int findAncestor(int index, bool (*match)(int p, int arg), int arg) {
+    int p = targets[index].parent_id;
+    for (int depth = 0; p >= 0 && p < NUM_TARGETS && p != index && depth < NUM_TARGETS; depth++) {
+        if (targets[p].enabled && match(p, arg)) return p;
+        p = targets[p].parent_id;
+    }
+    return -1;
+}
+
+static bool isOffline(int p, int) {
+    return !confirmed_online_state[p];
+}
+
+static bool isFailingOrOffline(int p, int) {
+    return !confirmed_online_state[p] || failure_count[p] > 0;
+}
+
+static bool isTarget(int p, int id) {
+    return p == id;
+}
+
+int offlineAncestor(int index) {
+    return findAncestor(index, isOffline, 0);
+}
+
+int countDependants(int index) {
+    int count = 0;
+    for (int j = 0; j < NUM_TARGETS; j++) {
+        if (targets[j].enabled && findAncestor(j, isTarget, index) >= 0) count++;
+    }
+    return count;
+}
+
+// Adaptive interval clamped to the current config, so edits take effect on
+// the next check
+static uint16_t adaptiveInterval(int index) {
+    const TargetConfig& target = targets[index];
+    uint16_t base = target.check_interval_seconds;
+    if (effective_interval[index] == 0) return base;
+
+    uint16_t low = retryInterval(target);
+    uint16_t high = target.max_check_interval_seconds > base ? target.max_check_interval_seconds : base;
+    if (effective_interval[index] < low) return low;
+    if (effective_interval[index] > high) return high;
+    return effective_interval[index];
+}
+
+uint16_t effectiveCheckInterval(int index) {
+    uint16_t interval = adaptiveInterval(index);
+    if (interval < PARENT_DOWN_CHECK_INTERVAL && offlineAncestor(index) >= 0) return PARENT_DOWN_CHECK_INTERVAL;
+    return interval;
+}
+
+static void updateEffectiveInterval(int i, bool isOnline) {
+    const TargetConfig& target = targets[i];
+    uint16_t base = target.check_interval_seconds;
+
+    bool confirming = local_down[i] ? success_count[i] > 0 : failure_count[i] > 0;
+    if (!isOnline || confirming) {
+        // Unconfirmed change: retry quickly; confirmed offline: plain interval
+        effective_interval[i] = confirming ? retryInterval(target) : base;
+        stable_checks[i] = 0;
+        return;
+    }
+    if (effective_interval[i] < base) effective_interval[i] = base;  // Just confirmed online
+
+    uint16_t current = adaptiveInterval(i);
+    if (target.max_check_interval_seconds <= current) return;
+    if (++stable_checks[i] < BACKOFF_STABLE_CHECKS) return;
+    stable_checks[i] = 0;
+    uint32_t next = (uint32_t)current * 2;
+    effective_interval[i] = next > target.max_check_interval_seconds ? target.max_check_interval_seconds : (uint16_t)next;
+}
+
+void resetLatencyState(int index) {
+    memset(&latencyBaselines[index], 0, sizeof(latencyBaselines[index]));
+    degraded[index] = false;
+    slow_count[index] = 0;
+    fast_count[index] = 0;
+}
+
+void resetTargetRuntime(int index) {
+    resetUptimeStats(index);
+    resetLatencyState(index);
+    effective_interval[index] = 0;
+    stable_checks[index] = 0;
+    alert_held[index] = false;
+    total_checks[index] = 0;
+    total_failures[index] = 0;
+}
+
+// Notifications and the custom HTTP action; in a federation only the
+// notifier sends them
+static void sendAlert(int i, AlertKind kind) {
+    if (!federationIsNotifier()) {
+        web_log_printf("[Server %d] Alert left to node %d", i + 1, federationNotifier());
+        return;
+    }
+    sendNotifications(i, kind);
+}
+
+static void logTransition(int i, const char* state) {
+    char timeBuf[30], logEntry[64];
+    getFormattedTime(timeBuf, sizeof(timeBuf));
+    snprintf(logEntry, sizeof(logEntry), "%s;%s\n", state, timeBuf);
+    prependToLog(targetLogMessages[i], logEntry, TARGET_LOG_SIZE);
+}
+
+// Apply the quorum to the own verdict; on a confirmed transition log it and
+// alert (or hold the alert). Returns whether the confirmed state flipped.
+static bool updateConfirmedState(int i) {
+    bool online = !federationTargetDown(i, local_down[i]);
+    if (online == confirmed_online_state[i]) return false;
+    confirmed_online_state[i] = online;
+    logTransition(i, online ? "on" : "off");
+
+    if (online) {
+        if (alert_held[i]) {
+            // Came back with its parent: the outage was never reported
+            alert_held[i] = false;
+            web_log_printf("[Server %d] Recovered; held offline alert dropped", i + 1);
+        } else {
+            sendAlert(i, ALERT_ONLINE);
+        }
+    } else {
+        // Peers can confirm an outage this node has not seen fail yet
+        offline_since[i] = failure_count[i] > 0 ? first_failure_time[i] : hal_millis();
+        int ancestor = findAncestor(i, isFailingOrOffline, 0);
+        if (ancestor >= 0) {
+            alert_held[i] = true;
+            web_log_printf("[Server %d] Offline alert held while server %d is down", i + 1, ancestor + 1);
+        } else {
+            sendAlert(i, ALERT_OFFLINE);
+        }
+    }
+    return true;
+}
+
+static uint8_t latencySlowChecks(const TargetConfig& target) {
+    return target.latency_slow_checks ? target.latency_slow_checks : target.failure_threshold;
+}
+
+static uint8_t latencyRecoveryChecks(const TargetConfig& target) {
+    return target.latency_recovery_checks ? target.latency_recovery_checks : target.recovery_threshold;
+}
+
+// Slow/fast thresholding of a check of a confirmed-online target. Only fast
+// checks outside the degraded state are learned, after they were judged:
+// learning a sustained regression would raise the limit until the slow
+// checks passed it and end the degraded state while still slow.
+static void updateLatencyState(int i, bool isOnline, unsigned long elapsedMs) {
+    if (!confirmed_online_state[i]) {
+        if (degraded[i]) web_log_printf("[Server %d] Offline; degraded state cleared", i + 1);
+        degraded[i] = false;
+        slow_count[i] = 0;
+        fast_count[i] = 0;
+        return;
+    }
+    if (!isOnline) return;
+
+    uint32_t limit = latencySlowLimitMs(i);
+    bool slow = limit && elapsedMs > limit;
+    bool learn = !slow && !degraded[i];
+    if (slow) {
+        fast_count[i] = 0;
+        if (slow_count[i] < 255) slow_count[i]++;
+        if (!degraded[i] && slow_count[i] >= latencySlowChecks(targets[i])) {
+            degraded[i] = true;
+            web_log_printf("[Server %d] Degraded: %lu ms, limit %lu ms", i + 1, elapsedMs, (unsigned long)limit);
+            logTransition(i, "degraded");
+            sendAlert(i, ALERT_DEGRADED);
+        }
+    } else {
+        slow_count[i] = 0;
+        if (fast_count[i] < 255) fast_count[i]++;
+        if (degraded[i] && fast_count[i] >= latencyRecoveryChecks(targets[i])) {
+            degraded[i] = false;
+            web_log_printf("[Server %d] Latency back to normal: %lu ms", i + 1, elapsedMs);
+            logTransition(i, "normal");
+            sendAlert(i, ALERT_LATENCY_OK);
+        }
+    }
+    if (learn) latencyBaselineUpdate(latencyBaselines[i], elapsedMs);
+}
+
+void reevaluateTarget(int index) {
+    if (!targets[index].enabled) return;
+    if (updateConfirmedState(index)) {
+        groupIndexNoteResult(index, true);
+        statusChanged();
+    }
+}
+
+void processCheckResult(int i, int code, unsigned long elapsedMs) {
+    bool wasOnline = confirmed_online_state[i];
+    bool wasLocalDown = local_down[i];
+    bool wasCheckOnline = isOnlineCode(httpCode[i]);
+    bool wasDegraded = degraded[i];
+    bool wasHeld = alert_held[i];
+    pingTime[i] = elapsedMs;
+    httpCode[i] = code;
+    updatePingStats(i);
+
+    bool isOnline = isOnlineCode(httpCode[i]);
+    recordUptimeSample(i, isOnline);
+    total_checks[i]++;
+    if (!isOnline) total_failures[i]++;
+
+    if (isOnline) {
+        failure_count[i] = 0;
+        success_count[i]++;
+        if (local_down[i] && success_count[i] >= targets[i].recovery_threshold) local_down[i] = false;
+    } else {
+        success_count[i] = 0;
+        if (failure_count[i] == 0) first_failure_time[i] = hal_millis() - elapsedMs;
+        failure_count[i]++;
+        if (!local_down[i] && failure_count[i] >= targets[i].failure_threshold) local_down[i] = true;
+    }
+    if (local_down[i] != wasLocalDown) federationNoteLocalVerdict(i);
+
+    if (!updateConfirmedState(i) && !isOnline && alert_held[i] && !confirmed_online_state[i] &&
+        findAncestor(i, isFailingOrOffline, 0) < 0) {
+        // Parent is back but this target is still down: report it now
+        alert_held[i] = false;
+        web_log_printf("[Server %d] Still offline after its parent recovered; sending held alert", i + 1);
+        sendAlert(i, ALERT_OFFLINE);
+    }
+    updateLatencyState(i, isOnline, elapsedMs);
+    updateEffectiveInterval(i, isOnline);
+    groupIndexNoteResult(i, confirmed_online_state[i] != wasOnline);
+    if (confirmed_online_state[i] != wasOnline || isOnline != wasCheckOnline || degraded[i] != wasDegraded ||
+        alert_held[i] != wasHeld) {
+        statusChanged();
+    } else {
+        statusValuesChanged();
+    }
+    web_log_printf("[Server %d] URL: %s, Status: %d, Ping: %lu ms, Fails: %d, Successes: %d",
+        i + 1, targets[i].weburl, httpCode[i], pingTime[i], failure_count[i], success_count[i]);
+}
@@ -0,0 +1,87 @@
+#pragma once
+
+#include <stdint.h>
+
+#include "monitor_config.h"
+
+// --- Runtime state variables ---
+extern int httpCode[NUM_TARGETS];
+extern unsigned long pingTime[NUM_TARGETS];
+extern unsigned long minpingTime[NUM_TARGETS];
+extern unsigned long maxpingTime[NUM_TARGETS];
+extern unsigned long last_check_time[NUM_TARGETS];
+extern uint8_t failure_count[NUM_TARGETS];
+extern uint8_t success_count[NUM_TARGETS];
+extern bool confirmed_online_state[NUM_TARGETS];
+extern bool local_down[NUM_TARGETS];  // This node's own verdict (thresholds applied, before any quorum)
+extern unsigned long first_failure_time[NUM_TARGETS];  // Start of the current run of failed checks
+extern unsigned long offline_since[NUM_TARGETS];       // first_failure_time of the last confirmed outage
+extern uint16_t effective_interval[NUM_TARGETS];  // Seconds until the next check (0 = check_interval)
+extern uint8_t stable_checks[NUM_TARGETS];        // Successes since the interval last changed
+extern bool alert_held[NUM_TARGETS];            // Offline alert folded into a parent's outage
+extern uint32_t total_checks[NUM_TARGETS];    // Checks performed since boot (for /metrics)
+extern uint32_t total_failures[NUM_TARGETS];  // Failed checks since boot (for /metrics)
+extern bool degraded[NUM_TARGETS];           // Confirmed slow while online (see below)
+extern uint8_t slow_count[NUM_TARGETS];      // Consecutive slow checks
+extern uint8_t fast_count[NUM_TARGETS];      // Consecutive checks within the latency limit
+
+// --- Per-target status change log ("on;<time>\n" / "off;<time>\n", and
+// "degraded;<time>\n" / "normal;<time>\n" for latency) ---
+const int TARGET_LOG_SIZE = 1024;
+extern char targetLogMessages[NUM_TARGETS][TARGET_LOG_SIZE];
+
+inline bool isOnlineCode(int code) {
+    return code >= 200 && code < 400;
+}
+
+void updatePingStats(int index);
+
+// --- Adaptive check interval ---
+// While a failure (or recovery) is unconfirmed the target is re-probed every
+// retry_interval_seconds. Once confirmed online, the interval doubles after
+// every BACKOFF_STABLE_CHECKS successes, up to max_check_interval_seconds;
+// any failure drops it back. Confirmed-offline targets use check_interval.
+const uint8_t BACKOFF_STABLE_CHECKS = 5;
+
+// Interval in seconds the scheduler waits before the next check of a target
+uint16_t effectiveCheckInterval(int index);
+
+// --- Dependencies (parent_id) ---
+// While an ancestor is confirmed offline its dependants are probed at most
+// every PARENT_DOWN_CHECK_INTERVAL seconds. While an ancestor is failing or
+// offline, a dependant's offline alert and action are held (alert_held): they
+// are dropped if it recovers before the ancestor does, and sent late if it is
+// still offline after the ancestor is back.
+const uint16_t PARENT_DOWN_CHECK_INTERVAL = 300;
+
+// Nearest enabled ancestor that is confirmed offline, or -1
+int offlineAncestor(int index);
+
+// Enabled targets whose parent chain includes index
+int countDependants(int index);
+
+// --- Latency degraded state ---
+// A successful check slower than latencySlowLimitMs() (latency_baseline.h)
+// is slow. latency_slow_checks consecutive slow checks mark an online target
+// degraded, latency_recovery_checks within the limit clear it (0 uses
+// failure_threshold / recovery_threshold), each with
+// an alert (ALERT_DEGRADED / ALERT_LATENCY_OK) on the usual channels except
+// the custom HTTP action. Failed checks count neither way; once the target
+// is confirmed offline the degraded state is dropped without an alert, as
+// the outage alerts cover it.
+
+// Forget the latency baseline and degraded state (new URL, reassigned slot)
+void resetLatencyState(int index);
+
+// Forget per-slot statistics when a slot is (re)assigned or deleted
+void resetTargetRuntime(int index);
+
+// Feed one probe result through the failure/recovery state machine.
+// Fires notifications and custom HTTP actions on confirmed transitions.
+// failure_threshold / recovery_threshold decide local_down; the confirmed
+// state follows it directly, or the quorum when federation is on.
+void processCheckResult(int index, int code, unsigned long elapsedMs);
+
+// Re-decide the confirmed state after a peer's vote (or the federation
+// config) changed; transitions alert exactly like processCheckResult()
+void reevaluateTarget(int index);
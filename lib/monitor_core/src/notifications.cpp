@@ -0,0 +1,383 @@
+#include "notifications.h"
+
+#include <ctype.h>
+#include <stdio.h>
+#include <string.h>
+
+#include "alert_queue.h"
+#include "diagnostics.h"
+#include "latency_baseline.h"
+#include "monitor_hal.h"
+#include "monitor_config.h"
+#include "monitor_state.h"
+#include "notify_governor.h"
+#include "web_log.h"
+
+const char* telegramApiBase = "https://api.telegram.org";
+
+const char* const ALERT_KIND_NAMES[ALERT_KIND_COUNT] = {"offline", "online", "degraded", "latency_ok"};
+
+CompiledTemplate onlineTemplates[NUM_TARGETS];
+CompiledTemplate offlineTemplates[NUM_TARGETS];
+
+struct Placeholder {
+    const char* token;
+    uint8_t length;
+    TemplateField field;
+};
+
+static const Placeholder PLACEHOLDERS[] = {
+    {"{NAME}", 6, FIELD_NAME},
+    {"{GROUP}", 7, FIELD_GROUP},
+    {"{URL}", 5, FIELD_URL},
+    {"{CODE}", 6, FIELD_CODE},
+    {"{LATENCY}", 9, FIELD_LATENCY},
+    {"{BASELINE}", 10, FIELD_BASELINE},
+    {"{TIME}", 6, FIELD_TIME},
+    {"{DOWNTIME}", 10, FIELD_DOWNTIME},
+    {"{DEPENDENTS}", 12, FIELD_DEPENDENTS},
+};
+
+static void addLiteral(CompiledTemplate& out, size_t offset, size_t length) {
+    if (length == 0) return;
+    TemplatePart* last = out.count ? &out.parts[out.count - 1] : nullptr;
+    if (last && last->field == FIELD_LITERAL && last->offset + last->length == offset) {
+        last->length += length;
+        return;
+    }
+    TemplatePart& part = out.parts[out.count++];
+    part.field = FIELD_LITERAL;
+    part.offset = offset;
+    part.length = length;
+}
+
+void compileTemplate(CompiledTemplate& out, const char* text) {
+    out.count = 0;
+    size_t len = strlen(text);
+    if (len > 255) len = 255;  // Offsets are 8 bit; templates are 128 bytes
+
+    size_t pos = 0;
+    while (pos < len) {
+        // Keep one part in reserve for the literal tail
+        if (out.count >= TEMPLATE_MAX_PARTS - 1) {
+            addLiteral(out, pos, len - pos);
+            return;
+        }
+        const Placeholder* match = nullptr;
+        if (text[pos] == '{') {
+            for (size_t p = 0; p < sizeof(PLACEHOLDERS) / sizeof(PLACEHOLDERS[0]); p++) {
+                if (strncmp(text + pos, PLACEHOLDERS[p].token, PLACEHOLDERS[p].length) == 0) {
+                    match = &PLACEHOLDERS[p];
+                    break;
+                }
+            }
+        }
+        if (match) {
+            TemplatePart& part = out.parts[out.count++];
+            part.field = match->field;
+            part.offset = 0;
+            part.length = 0;
+            pos += match->length;
+        } else {
+            size_t next = pos + 1;
+            while (next < len && text[next] != '{') next++;
+            addLiteral(out, pos, next - pos);
+            pos = next;
+        }
+    }
+}
+
+void compileMessageTemplates(int index) {
+    compileTemplate(onlineTemplates[index], targets[index].online_message);
+    compileTemplate(offlineTemplates[index], targets[index].offline_message);
+}
+
+// Built-in latency alert texts, shared by every target
+static const char DEGRADED_MESSAGE[] = "⚠️ {NAME} DEGRADED: {LATENCY} ms (baseline {BASELINE} ms): {URL}";
+static const char LATENCY_OK_MESSAGE[] = "✅ {NAME} latency back to normal: {LATENCY} ms (baseline {BASELINE} ms)";
+static CompiledTemplate degradedTemplate;
+static CompiledTemplate latencyOkTemplate;
+
+static bool compileLatencyTemplates() {
+    compileTemplate(degradedTemplate, DEGRADED_MESSAGE);
+    compileTemplate(latencyOkTemplate, LATENCY_OK_MESSAGE);
+    return true;
+}
+static const bool latencyTemplatesCompiled = compileLatencyTemplates();
+
+// --- Rendering ---
+
+struct MessageWriter {
+    char* out;
+    size_t size;
+    size_t pos;
+    MessageEscape escape;
+};
+
+static const char HEX_DIGITS[] = "0123456789ABCDEF";
+
+// Append raw bytes, escaped for the channel; an escape sequence that does not
+// fit is dropped whole so the output never ends in half an escape
+static void writeEscaped(MessageWriter& w, const char* s, size_t len) {
+    for (size_t i = 0; i < len; i++) {
+        unsigned char c = (unsigned char)s[i];
+        char seq[6];
+        size_t n = 0;
+        // Never start a UTF-8 sequence that cannot be finished
+        if (c >= 0xC0) {
+            size_t need = (c >= 0xF0 ? 4 : (c >= 0xE0 ? 3 : 2)) * (w.escape == ESCAPE_URL ? 3 : 1);
+            if (w.pos + need + 1 > w.size) {
+                w.size = w.pos + 1;
+                return;
+            }
+        }
+        switch (w.escape) {
+            case ESCAPE_NONE:
+                seq[n++] = c;
+                break;
+            case ESCAPE_JSON:
+                if (c == '"' || c == '\\') { seq[n++] = '\\'; seq[n++] = c; }
+                else if (c == '\n') { seq[n++] = '\\'; seq[n++] = 'n'; }
+                else if (c == '\r') { seq[n++] = '\\'; seq[n++] = 'r'; }
+                else if (c == '\t') { seq[n++] = '\\'; seq[n++] = 't'; }
+                else if (c < 0x20) {
+                    seq[n++] = '\\'; seq[n++] = 'u'; seq[n++] = '0'; seq[n++] = '0';
+                    seq[n++] = HEX_DIGITS[c >> 4]; seq[n++] = HEX_DIGITS[c & 0xF];
+                }
+                else seq[n++] = c;
+                break;
+            case ESCAPE_URL:
+                if (isalnum(c) || c == '-' || c == '_' || c == '.' || c == '~') seq[n++] = c;
+                else { seq[n++] = '%'; seq[n++] = HEX_DIGITS[c >> 4]; seq[n++] = HEX_DIGITS[c & 0xF]; }
+                break;
+        }
+        if (w.pos + n + 1 > w.size) {
+            w.size = w.pos + 1;  // Full: stop appending
+            return;
+        }
+        memcpy(w.out + w.pos, seq, n);
+        w.pos += n;
+    }
+}
+
+static void writeString(MessageWriter& w, const char* s) {
+    writeEscaped(w, s, strlen(s));
+}
+
+// "45s", "3m 05s", "2h 07m", "3d 04h"
+static void formatDuration(char* out, size_t size, unsigned long ms) {
+    unsigned long s = ms / 1000;
+    if (s < 60) snprintf(out, size, "%lus", s);
+    else if (s < 3600) snprintf(out, size, "%lum %02lus", s / 60, s % 60);
+    else if (s < 86400) snprintf(out, size, "%luh %02lum", s / 3600, (s % 3600) / 60);
+    else snprintf(out, size, "%lud %02luh", s / 86400, (s % 86400) / 3600);
+}
+
+size_t renderNotificationMessage(char* out, size_t size, int index, uint8_t kind, MessageEscape escape) {
+    if (size == 0) return 0;
+    const CompiledTemplate* templates[ALERT_KIND_COUNT] = {
+        &offlineTemplates[index], &onlineTemplates[index], &degradedTemplate, &latencyOkTemplate};
+    const char* texts[ALERT_KIND_COUNT] = {
+        targets[index].offline_message, targets[index].online_message, DEGRADED_MESSAGE, LATENCY_OK_MESSAGE};
+    if (kind >= ALERT_KIND_COUNT) kind = ALERT_OFFLINE;
+    const CompiledTemplate& tmpl = *templates[kind];
+    const char* text = texts[kind];
+    MessageWriter w = {out, size, 0, escape};
+    char value[32];
+
+    for (int p = 0; p < tmpl.count; p++) {
+        const TemplatePart& part = tmpl.parts[p];
+        switch (part.field) {
+            case FIELD_LITERAL:
+                writeEscaped(w, text + part.offset, part.length);
+                break;
+            case FIELD_NAME:
+                writeString(w, targets[index].server_name);
+                break;
+            case FIELD_GROUP:
+                writeString(w, targets[index].group_name);
+                break;
+            case FIELD_URL:
+                writeString(w, targets[index].weburl);
+                break;
+            case FIELD_CODE:
+                snprintf(value, sizeof(value), "%d", httpCode[index]);
+                writeString(w, value);
+                break;
+            case FIELD_LATENCY:
+                snprintf(value, sizeof(value), "%lu", pingTime[index]);
+                writeString(w, value);
+                break;
+            case FIELD_BASELINE:
+                if (latencyBaselines[index].samples) snprintf(value, sizeof(value), "%.0f", latencyBaselines[index].mean_ms);
+                else snprintf(value, sizeof(value), "?");
+                writeString(w, value);
+                break;
+            case FIELD_TIME:
+                getFormattedTime(value, sizeof(value));
+                writeString(w, value);
+                break;
+            case FIELD_DOWNTIME: {
+                unsigned long since = kind == ALERT_ONLINE ? offline_since[index] : first_failure_time[index];
+                formatDuration(value, sizeof(value), since ? hal_millis() - since : 0);
+                writeString(w, value);
+                break;
+            }
+            case FIELD_DEPENDENTS:
+                snprintf(value, sizeof(value), "%d", countDependants(index));
+                writeString(w, value);
+                break;
+        }
+    }
+    out[w.pos] = '\0';
+    return w.pos;
+}
+
+size_t escapeMessage(char* out, size_t size, const char* text, MessageEscape escape) {
+    if (size == 0) return 0;
+    MessageWriter w = {out, size, 0, escape};
+    writeString(w, text);
+    out[w.pos] = '\0';
+    return w.pos;
+}
+
+// --- Delivery ---
+
+const char* const ALERT_CHANNEL_NAMES[ALERT_CHANNEL_COUNT] = {
+    "discord", "ntfy", "telegram_1", "telegram_2", "telegram_3", "action"
+};
+
+static const char* telegramChatId(const TargetConfig& target, int channel) {
+    const char* chat_ids[] = {target.telegram_chat_id_1, target.telegram_chat_id_2, target.telegram_chat_id_3};
+    return chat_ids[channel - ALERT_TELEGRAM_1];
+}
+
+static bool isChannelConfigured(const TargetConfig& target, int channel, uint8_t kind) {
+    switch (channel) {
+        case ALERT_DISCORD:
+            return strcmp(target.discord_webhook_url, "0") != 0 && strlen(target.discord_webhook_url) > 10;
+        case ALERT_NTFY:
+            return strcmp(target.ntfy_url, "0") != 0 && strlen(target.ntfy_url) > 10;
+        case ALERT_TELEGRAM_1:
+        case ALERT_TELEGRAM_2:
+        case ALERT_TELEGRAM_3: {
+            const char* chat_id = telegramChatId(target, channel);
+            return strlen(target.telegram_bot_token) > 10 && strcmp(chat_id, "0") != 0 && strlen(chat_id) > 1;
+        }
+        case ALERT_ACTION: {
+            // The on/off hooks drive automations; a slow target is still on
+            if (alertIsLatency(kind)) return false;
+            const char* url = kind == ALERT_ONLINE ? target.http_get_url_on : target.http_get_url_off;
+            return strcmp(url, "0") != 0 && strlen(url) >= 10;
+        }
+    }
+    return false;
+}
+
+uint8_t alertChannels(int index, uint8_t kind) {
+    // The action URL differs per direction; either one makes the channel live
+    uint8_t other = alertIsRecovery(kind) ? kind - 1 : kind + 1;
+    uint8_t channels = 0;
+    for (int c = 0; c < ALERT_CHANNEL_COUNT; c++) {
+        if (isChannelConfigured(targets[index], c, kind) || isChannelConfigured(targets[index], c, other)) {
+            channels |= (uint8_t)(1 << c);
+        }
+    }
+    return channels;
+}
+
+// The queued plain text escaped for the channel, or the template rendered now
+static size_t writeMessage(char* out, size_t size, int index, uint8_t kind, const char* text, MessageEscape escape) {
+    if (text) return escapeMessage(out, size, text, escape);
+    return renderNotificationMessage(out, size, index, kind, escape);
+}
+
+int sendAlertChannel(int index, uint8_t kind, int channel, const char* text) {
+    const TargetConfig& target = targets[index];
+    if (!isChannelConfigured(target, channel, kind)) return 0;
+    bool online = alertIsRecovery(kind);
+    HalHttpRequest request = {};
+    request.timeout_ms = 3000;  // 3 second timeout for notifications
+    uint32_t retryAfter = 0;
+    request.retry_after_ms = &retryAfter;
+    char buffer[768];  // Discord JSON, ntfy text or Telegram URL (carries the encoded message)
+
+    switch (channel) {
+        case ALERT_DISCORD: {
+            static const char PREFIX[] = "{\"content\":\"";
+            size_t len = sizeof(PREFIX) - 1;
+            memcpy(buffer, PREFIX, len);
+            len += writeMessage(buffer + len, 2 * NOTIFICATION_MESSAGE_SIZE - len - 2, index, kind, text, ESCAPE_JSON);
+            buffer[len++] = '"';
+            buffer[len++] = '}';
+            request.method = "POST";
+            request.url = target.discord_webhook_url;
+            request.content_type = "application/json";
+            request.body = buffer;
+            request.body_len = len;
+            break;
+        }
+        case ALERT_NTFY:
+            request.method = "POST";
+            request.url = target.ntfy_url;
+            request.content_type = "text/plain";
+            request.header_name = "Priority";
+            request.header_value = target.ntfy_priority;
+            request.body = buffer;
+            request.body_len = writeMessage(buffer, NOTIFICATION_MESSAGE_SIZE, index, kind, text, ESCAPE_NONE);
+            break;
+        case ALERT_TELEGRAM_1:
+        case ALERT_TELEGRAM_2:
+        case ALERT_TELEGRAM_3: {
+            int len = snprintf(buffer, sizeof(buffer), "%s/bot%s/sendMessage?chat_id=%s&text=", telegramApiBase,
+                               target.telegram_bot_token, telegramChatId(target, channel));
+            if (len < 0 || len >= (int)sizeof(buffer)) return 0;
+            writeMessage(buffer + len, sizeof(buffer) - len, index, kind, text, ESCAPE_URL);
+            request.method = "GET";
+            request.url = buffer;
+            break;
+        }
+        case ALERT_ACTION:
+            request.method = "GET";
+            request.url = online ? target.http_get_url_on : target.http_get_url_off;
+            break;
+        default:
+            return 0;
+    }
+    int code = hal_http_request(request);
+    governorResult(index, online, channel, code, retryAfter);
+    return code;
+}
+
+bool alertShouldRetry(int code) {
+    return code < 0 || code == 408 || code == 429 || code >= 500;
+}
+
+void sendNotifications(int index, uint8_t kind) {
+    uint8_t channels = alertChannels(index, kind);
+    if (!channels) return;
+    if (!hal_network_connected() || alertQueuePending() > 0) {
+        alertQueuePush(index, kind, channels, 0);
+        return;
+    }
+    HeapScope heapScope(HEAP_NOTIFY);
+    bool online = alertIsRecovery(kind);  // Picks the governor's action endpoint
+    uint8_t failed = 0;
+    uint8_t deferred = 0;  // Paced by the governor, or just answered 429
+    uint32_t wait = 0;
+    for (int c = 0; c < ALERT_CHANNEL_COUNT; c++) {
+        if (!(channels & (1 << c))) continue;
+        uint32_t paced = governorAcquire(index, online, c);
+        if (!paced) {
+            int code = sendAlertChannel(index, kind, c, nullptr);
+            if (code == 429) paced = governorWait(index, online, c);
+            else if (alertShouldRetry(code)) failed |= (uint8_t)(1 << c);
+        }
+        if (paced) {
+            governorDeferred(index, online, c);
+            deferred |= (uint8_t)(1 << c);
+            if (!wait || paced < wait) wait = paced;
+        }
+    }
+    if (failed | deferred) alertQueuePush(index, kind, failed | deferred, failed ? ALERT_QUEUE_BACK_OFF : wait);
+}
@@ -0,0 +1,126 @@
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+
+const int NOTIFICATION_MESSAGE_SIZE = 256;
+
+// Telegram Bot API base URL (the load-test harness points it at a local sink)
+extern const char* telegramApiBase;
+
+// --- Alerts ---
+// Availability alerts follow the confirmed online/offline state; latency
+// alerts follow the degraded state (monitor_state.h) of a target that is
+// online. Values 0 and 1 are the former bool "online" of a queued alert.
+enum AlertKind {
+    ALERT_OFFLINE,
+    ALERT_ONLINE,
+    ALERT_DEGRADED,    // Confirmed slow against the latency SLO or baseline
+    ALERT_LATENCY_OK,  // Latency back to normal
+    ALERT_KIND_COUNT
+};
+
+extern const char* const ALERT_KIND_NAMES[ALERT_KIND_COUNT];
+
+// Good news (the problem is over), as opposed to a new problem
+inline bool alertIsRecovery(uint8_t kind) {
+    return kind == ALERT_ONLINE || kind == ALERT_LATENCY_OK;
+}
+
+inline bool alertIsLatency(uint8_t kind) {
+    return kind == ALERT_DEGRADED || kind == ALERT_LATENCY_OK;
+}
+
+// --- Message templates ---
+// online_message / offline_message are parsed once (at config load and on
+// every edit) into part lists that point back into the template text, so
+// rendering an alert is a single pass into a caller-provided buffer.
+// Latency alerts use fixed built-in templates.
+// Placeholders: {NAME} {GROUP} {URL} {CODE} {LATENCY} (ms of the last check)
+// {BASELINE} (learned normal latency in ms) {TIME} (local time) {DOWNTIME}
+// (offline: since the first failed check; online: length of the outage that
+// just ended) {DEPENDENTS} (enabled targets that list this one as a parent,
+// directly or further up). Unknown {...} stay literal.
+
+enum TemplateField {
+    FIELD_LITERAL,
+    FIELD_NAME,
+    FIELD_GROUP,
+    FIELD_URL,
+    FIELD_CODE,
+    FIELD_LATENCY,
+    FIELD_BASELINE,
+    FIELD_TIME,
+    FIELD_DOWNTIME,
+    FIELD_DEPENDENTS
+};
+
+struct TemplatePart {
+    uint8_t field;   // TemplateField
+    uint8_t offset;  // FIELD_LITERAL: slice of the template text
+    uint8_t length;
+};
+
+const int TEMPLATE_MAX_PARTS = 16;  // Anything past this renders as literal text
+
+struct CompiledTemplate {
+    uint8_t count;
+    TemplatePart parts[TEMPLATE_MAX_PARTS];
+};
+
+// How substituted text and literals are escaped for the channel
+enum MessageEscape {
+    ESCAPE_NONE,  // Plain text (ntfy body, log)
+    ESCAPE_JSON,  // Inside a JSON string (Discord)
+    ESCAPE_URL    // Query parameter (Telegram)
+};
+
+void compileTemplate(CompiledTemplate& out, const char* text);
+
+// Re-parse the online/offline templates of a target after they changed
+void compileMessageTemplates(int index);
+
+// Render the target's message for an AlertKind into out (always
+// NUL-terminated, truncated to fit) and return its length
+size_t renderNotificationMessage(char* out, size_t size, int index, uint8_t kind, MessageEscape escape);
+
+// Escape already rendered plain text for a channel (a queued alert)
+size_t escapeMessage(char* out, size_t size, const char* text, MessageEscape escape);
+
+// --- Delivery ---
+// Every channel of an alert is delivered and acknowledged on its own, so a
+// channel that failed can be retried without repeating the others.
+
+enum AlertChannel {
+    ALERT_DISCORD,
+    ALERT_NTFY,
+    ALERT_TELEGRAM_1,
+    ALERT_TELEGRAM_2,
+    ALERT_TELEGRAM_3,
+    ALERT_ACTION,  // Custom http_get_url_on / http_get_url_off (availability alerts only)
+    ALERT_CHANNEL_COUNT
+};
+
+extern const char* const ALERT_CHANNEL_NAMES[ALERT_CHANNEL_COUNT];
+
+// Bit (1 << AlertChannel) for each channel configured for the target that
+// carries this kind of alert
+uint8_t alertChannels(int index, uint8_t kind);
+
+// Send an alert (AlertKind) to one channel. text is the plain message of a
+// queued alert, or nullptr to render the target's template now.
+// Returns the HTTP status, a negative transport error, or 0 when the
+// channel is not configured.
+int sendAlertChannel(int index, uint8_t kind, int channel, const char* text);
+
+// Whether a channel result is worth retrying: no connection, timeout, 408,
+// 429 or 5xx. Anything else (delivered, or refused for good) is final.
+bool alertShouldRetry(int code);
+
+// Deliver an alert (AlertKind) to every channel configured for the target
+// (Discord, ntfy, Telegram, custom HTTP action). Channels that cannot
+// be reached, or that the rate governor (notify_governor.h) holds back, are
+// handed to the alert queue (alert_queue.h) and replayed once the network or
+// the endpoint is ready; while the queue is not empty, new alerts line up
+// behind it so they arrive in order.
+void sendNotifications(int index, uint8_t kind);
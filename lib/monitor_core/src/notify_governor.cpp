@@ -0,0 +1,204 @@
+#include "notify_governor.h"
+
+#include <string.h>
+
+#include "monitor_config.h"
+#include "monitor_hal.h"
+#include "notifications.h"
+#include "text_util.h"
+
+struct RateProfile {
+    uint8_t burst;         // Tokens the bucket holds; 0 = not paced
+    uint32_t interval_ms;  // One token back per interval
+};
+
+static const RateProfile DISCORD_RATE = {5, 2000};         // 5 per 2 s, 30 per minute per webhook
+static const RateProfile NTFY_RATE = {60, 5000};           // ntfy.sh visitor limit: burst 60, one per 5 s
+static const RateProfile TELEGRAM_CHAT_RATE = {1, 1000};   // One message per second per chat
+static const RateProfile TELEGRAM_GROUP_RATE = {3, 3000};  // 20 per minute in groups (negative chat id)
+static const RateProfile ACTION_RATE = {0, 0};             // Own endpoint: only 429 / Retry-After
+
+struct Endpoint {
+    uint32_t key;              // 0 = free
+    uint8_t channel;           // AlertChannel (ALERT_TELEGRAM_1 for every chat)
+    uint8_t burst;
+    uint16_t first_target;     // Target that created the entry, for the status output
+    uint32_t interval_ms;
+    uint32_t tokens;           // Thousandths of a token
+    unsigned long refilled_at;
+    unsigned long held_until;  // hal_millis(); 0 = not held
+    unsigned long last_used;
+    uint32_t sent;
+    uint32_t throttled;        // 429 answers
+    uint32_t deferred;         // Alerts that had to wait for the endpoint
+};
+
+static Endpoint endpoints[GOVERNOR_MAX_ENDPOINTS];
+
+// Totals survive an endpoint being evicted from the table
+static uint32_t totalSent = 0;
+static uint32_t totalThrottled = 0;
+static uint32_t totalDeferred = 0;
+
+// scheme://host[:port] of a URL: ntfy and most action services limit per client, not per topic
+static uint32_t hostKey(const char* url) {
+    char origin[96];
+    const char* host = strstr(url, "://");
+    host = host ? host + 3 : url;
+    size_t len = (host - url) + strcspn(host, "/?#");
+    if (len >= sizeof(origin)) len = sizeof(origin) - 1;
+    memcpy(origin, url, len);
+    origin[len] = '\0';
+    return hashString(origin);
+}
+
+static uint32_t endpointKey(const TargetConfig& target, bool online, int channel, RateProfile* profile) {
+    uint32_t key;
+    switch (channel) {
+        case ALERT_DISCORD:
+            *profile = DISCORD_RATE;
+            key = hashString(target.discord_webhook_url);
+            break;
+        case ALERT_NTFY:
+            *profile = NTFY_RATE;
+            key = hostKey(target.ntfy_url);
+            break;
+        case ALERT_TELEGRAM_1:
+        case ALERT_TELEGRAM_2:
+        case ALERT_TELEGRAM_3: {
+            const char* chat_ids[] = {target.telegram_chat_id_1, target.telegram_chat_id_2, target.telegram_chat_id_3};
+            const char* chat = chat_ids[channel - ALERT_TELEGRAM_1];
+            *profile = chat[0] == '-' ? TELEGRAM_GROUP_RATE : TELEGRAM_CHAT_RATE;
+            key = hashString(target.telegram_bot_token) * 31 + hashString(chat);
+            channel = ALERT_TELEGRAM_1;  // The same chat in another slot is the same endpoint
+            break;
+        }
+        default:
+            *profile = ACTION_RATE;
+            key = hostKey(online ? target.http_get_url_on : target.http_get_url_off);
+            break;
+    }
+    key = key * 8 + channel;
+    return key ? key : 1;
+}
+
+// Whether a is a better slot to reuse than b: free, then idle least
+// recently used, then held least recently used
+static bool betterVictim(const Endpoint& a, const Endpoint& b) {
+    if (!b.key) return false;
+    if (!a.key) return true;
+    if ((a.held_until != 0) != (b.held_until != 0)) return !a.held_until;
+    return (long)(a.last_used - b.last_used) < 0;
+}
+
+static Endpoint& findEndpoint(int index, bool online, int channel) {
+    RateProfile profile;
+    uint32_t key = endpointKey(targets[index], online, channel, &profile);
+    unsigned long now = hal_millis();
+    Endpoint* reuse = nullptr;
+    for (int k = 0; k < GOVERNOR_MAX_ENDPOINTS; k++) {
+        Endpoint& e = endpoints[k];
+        if (e.key == key) return e;
+        if (!reuse || betterVictim(e, *reuse)) reuse = &e;
+    }
+    Endpoint& e = *reuse;
+    memset(&e, 0, sizeof(e));
+    e.key = key;
+    e.channel = channel >= ALERT_TELEGRAM_1 && channel <= ALERT_TELEGRAM_3 ? ALERT_TELEGRAM_1 : channel;
+    e.burst = profile.burst;
+    e.first_target = (uint16_t)index;
+    e.interval_ms = profile.interval_ms;
+    e.tokens = profile.burst * 1000UL;
+    e.refilled_at = now;
+    e.last_used = now;
+    return e;
+}
+
+// Tokens (thousandths) the bucket holds at `now`
+static uint32_t tokensAt(const Endpoint& e, unsigned long now) {
+    uint64_t tokens = e.tokens + (uint64_t)(now - e.refilled_at) * 1000 / e.interval_ms;
+    return tokens > e.burst * 1000UL ? e.burst * 1000UL : (uint32_t)tokens;
+}
+
+// Read-only, so the status handler can call it from the web server task
+static uint32_t waitFor(const Endpoint& e, unsigned long now) {
+    if (e.held_until && (long)(e.held_until - now) > 0) return e.held_until - now;
+    if (!e.burst) return 0;
+    uint32_t tokens = tokensAt(e, now);
+    if (tokens >= 1000) return 0;
+    return (uint32_t)((1000 - tokens) * (uint64_t)e.interval_ms / 1000) + 1;
+}
+
+uint32_t governorWait(int index, bool online, int channel) {
+    return waitFor(findEndpoint(index, online, channel), hal_millis());
+}
+
+uint32_t governorAcquire(int index, bool online, int channel) {
+    Endpoint& e = findEndpoint(index, online, channel);
+    unsigned long now = hal_millis();
+    e.last_used = now;
+    uint32_t wait = waitFor(e, now);
+    if (wait) return wait;
+    e.held_until = 0;
+    if (e.burst) {
+        e.tokens = tokensAt(e, now) - 1000;
+        e.refilled_at = now;
+    }
+    return 0;
+}
+
+void governorDeferred(int index, bool online, int channel) {
+    findEndpoint(index, online, channel).deferred++;
+    totalDeferred++;
+}
+
+void governorResult(int index, bool online, int channel, int code, uint32_t retryAfterMs) {
+    Endpoint& e = findEndpoint(index, online, channel);
+    uint32_t hold = retryAfterMs;
+    if (code == 429) {
+        e.throttled++;
+        totalThrottled++;
+        e.tokens = 0;
+        e.refilled_at = hal_millis();
+        if (!hold) hold = e.interval_ms > GOVERNOR_DEFAULT_HOLD_MS ? e.interval_ms : GOVERNOR_DEFAULT_HOLD_MS;
+    } else if (code >= 200 && code < 300) {
+        e.sent++;
+        totalSent++;
+    }
+    if (!hold) return;
+    if (hold > GOVERNOR_MAX_HOLD_MS) hold = GOVERNOR_MAX_HOLD_MS;
+    unsigned long until = hal_millis() + hold;
+    e.held_until = until ? until : 1;
+}
+
+// --- Status ---
+
+void buildGovernorJson(JsonObject root) {
+    root["sent"] = totalSent;
+    root["throttled"] = totalThrottled;
+    root["deferred"] = totalDeferred;
+
+    unsigned long now = hal_millis();
+    JsonArray list = root.createNestedArray("endpoints");
+    for (int k = 0; k < GOVERNOR_MAX_ENDPOINTS; k++) {
+        const Endpoint& e = endpoints[k];
+        if (!e.key) continue;
+        JsonObject obj = list.createNestedObject();
+        obj["channel"] = e.channel == ALERT_TELEGRAM_1 ? "telegram" : ALERT_CHANNEL_NAMES[e.channel];
+        obj["first_id"] = e.first_target;
+        if (e.burst) {
+            obj["burst"] = e.burst;
+            obj["per_minute"] = 60000.0f / e.interval_ms;
+            obj["tokens"] = tokensAt(e, now) / 1000.0f;
+        } else {
+            obj["burst"] = nullptr;
+            obj["per_minute"] = nullptr;
+            obj["tokens"] = nullptr;
+        }
+        obj["wait_ms"] = waitFor(e, now);
+        obj["held"] = e.held_until && (long)(e.held_until - now) > 0;
+        obj["sent"] = e.sent;
+        obj["throttled"] = e.throttled;
+        obj["deferred"] = e.deferred;
+    }
+}
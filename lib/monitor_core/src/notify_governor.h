@@ -0,0 +1,39 @@
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+#include <ArduinoJson.h>
+
+// --- Notification rate governor ---
+// One token bucket per channel endpoint (Discord webhook, ntfy server,
+// Telegram bot + chat, action host), sized to what the provider accepts, so
+// a large incident is sent as fast as each endpoint allows and the rest waits
+// in the alert queue instead of being answered 429. A 429, or any response
+// with Retry-After (Discord: X-RateLimit-Remaining 0 with
+// X-RateLimit-Reset-After), holds the endpoint for the time it asked for.
+//
+// Endpoints are identified by a hash of their URL parts and kept in a small
+// table; when it is full the least recently used idle endpoint is reused.
+
+const uint8_t GOVERNOR_MAX_ENDPOINTS = 16;
+const uint32_t GOVERNOR_DEFAULT_HOLD_MS = 5000;    // 429 without Retry-After
+const uint32_t GOVERNOR_MAX_HOLD_MS = 3600000;     // Longer Retry-After values are capped
+
+// Take a token for the channel's endpoint. Returns 0 when the alert may be
+// sent now, else the milliseconds until it may.
+uint32_t governorAcquire(int index, bool online, int channel);
+
+// Count an alert that has to wait for the endpoint (once per alert)
+void governorDeferred(int index, bool online, int channel);
+
+// Report the endpoint's answer (HTTP status or negative transport error) and
+// the wait it asked for (HalHttpRequest::retry_after_ms)
+void governorResult(int index, bool online, int channel, int code, uint32_t retryAfterMs);
+
+// Milliseconds until the endpoint accepts the next alert (0 = now), without
+// taking a token
+uint32_t governorWait(int index, bool online, int channel);
+
+// "governor" object of GET /api/alerts/queue
+void buildGovernorJson(JsonObject root);
+const size_t GOVERNOR_JSON_CAPACITY = 256 + 192UL * GOVERNOR_MAX_ENDPOINTS;
@@ -0,0 +1,348 @@
+#include "ota_pull.h"
+
+#include <ctype.h>
+#include <stdio.h>
+#include <string.h>
+
+#include "alert_queue.h"
+#include "diagnostics.h"
+#include "monitor_hal.h"
+#include "sha256.h"
+#include "text_util.h"
+#include "uptime_stats.h"
+#include "web_log.h"
+
+static const char* const OTA_STATE_NAMES[] = {"idle", "manifest", "downloading", "verified", "failed"};
+
+// Written by the API handler only while no update runs, then handed over by
+// setting state; from there on only otaPoll() touches them
+static volatile OtaState state = OTA_IDLE;
+static volatile bool cancelRequested = false;
+static volatile bool pushActive = false;  // A browser upload holds the update partition
+static char manifestUrl[160];
+static char imageUrl[160];
+static char version[24];
+static char expectedSha[65];
+static int32_t expectedSize = -1;
+static uint16_t maxKbps = 0;
+
+static HalDownload* download = nullptr;
+static uint8_t* chunk = nullptr;  // OTA_CHUNK_SIZE, only while an update runs
+static size_t manifestLength = 0;
+static bool updateOpen = false;
+static Sha256 sha;
+
+static int32_t totalBytes = -1;
+static uint32_t bytesWritten = 0;
+static unsigned long startedAt = 0;      // Start of the image download
+static unsigned long lastDataAt = 0;
+static unsigned long finishedAt = 0;
+static bool restartIssued = false;
+static char error[64];
+
+static bool isHexDigest(const char* s) {
+    if (strlen(s) != 64) return false;
+    for (; *s; s++) {
+        if (!isxdigit((unsigned char)*s)) return false;
+    }
+    return true;
+}
+
+static bool isHttpUrl(const char* url) {
+    return strncmp(url, "http://", 7) == 0 || strncmp(url, "https://", 8) == 0;
+}
+
+static void lowerCopy(char* dest, const char* src, size_t size) {
+    size_t i = 0;
+    for (; src[i] && i + 1 < size; i++) dest[i] = (char)tolower((unsigned char)src[i]);
+    dest[i] = '\0';
+}
+
+bool otaInProgress() {
+    return state == OTA_MANIFEST || state == OTA_DOWNLOADING || state == OTA_VERIFIED;
+}
+
+bool otaPushBegin() {
+    if (pushActive || otaInProgress()) return false;
+    pushActive = true;
+    return true;
+}
+
+void otaPushEnd() {
+    pushActive = false;
+}
+
+bool otaPushActive() {
+    return pushActive;
+}
+
+const char* startOtaFromJson(JsonObjectConst json) {
+    if (otaInProgress() || pushActive) return "Update already in progress";
+    const char* manifest = json["manifest"] | "";
+    const char* url = json["url"] | "";
+    const char* digest = json["sha256"] | "";
+    int maxRate = json["max_kbps"] | 0;
+    if (maxRate < 0 || maxRate > 10000) return "Invalid max_kbps";
+
+    if (*manifest) {
+        if (!isHttpUrl(manifest)) return "Invalid manifest";
+        if (strlen(manifest) >= sizeof(manifestUrl)) return "manifest too long";
+    } else {
+        if (!isHttpUrl(url)) return "Missing manifest or url";
+        if (strlen(url) >= sizeof(imageUrl)) return "url too long";
+        if (!isHexDigest(digest)) return "sha256 must be 64 hex digits";
+    }
+    int32_t size = json["size"] | -1;
+    if (size == 0 || size < -1) return "Invalid size";
+
+    safeStrcpy(manifestUrl, *manifest ? manifest : "", sizeof(manifestUrl));
+    safeStrcpy(imageUrl, *manifest ? "" : url, sizeof(imageUrl));
+    safeStrcpy(version, json["version"] | "", sizeof(version));
+    lowerCopy(expectedSha, *manifest ? "" : digest, sizeof(expectedSha));
+    expectedSize = *manifest ? -1 : size;
+    maxKbps = (uint16_t)maxRate;
+    totalBytes = -1;
+    bytesWritten = 0;
+    startedAt = 0;
+    finishedAt = 0;
+    error[0] = '\0';
+    cancelRequested = false;
+    state = *manifest ? OTA_MANIFEST : OTA_DOWNLOADING;
+    return nullptr;
+}
+
+bool cancelOta() {
+    if (state != OTA_MANIFEST && state != OTA_DOWNLOADING) return false;
+    cancelRequested = true;
+    return true;
+}
+
+static void release() {
+    if (download) hal_download_close(download);
+    download = nullptr;
+    if (updateOpen) hal_update_abort();
+    updateOpen = false;
+    delete[] chunk;
+    chunk = nullptr;
+}
+
+static void fail(const char* message) {
+    release();
+    safeStrcpy(error, message, sizeof(error));
+    finishedAt = hal_millis();
+    state = OTA_FAILED;
+    web_log_printf("[OTA] Failed: %s", message);
+}
+
+// Open url; on failure the update fails with the HTTP status
+static bool openDownload(const char* url, int32_t* length) {
+    int status = 0;
+    download = hal_download_open(url, OTA_OPEN_TIMEOUT_MS, &status, length);
+    if (download) return true;
+    char message[64];
+    snprintf(message, sizeof(message), "%s answered %d", state == OTA_MANIFEST ? "Manifest" : "Image", status);
+    fail(message);
+    return false;
+}
+
+// --- Manifest ---
+
+// imageUrl = url when absolute, else url relative to the manifest's directory
+static bool resolveImageUrl(const char* url) {
+    if (isHttpUrl(url)) {
+        if (strlen(url) >= sizeof(imageUrl)) return false;
+        safeStrcpy(imageUrl, url, sizeof(imageUrl));
+        return true;
+    }
+    const char* slash = strrchr(manifestUrl, '/');
+    size_t base = slash ? slash - manifestUrl + 1 : strlen(manifestUrl);
+    if (base + strlen(url) >= sizeof(imageUrl)) return false;
+    memcpy(imageUrl, manifestUrl, base);
+    strcpy(imageUrl + base, url);
+    return true;
+}
+
+static void parseManifest() {
+    DynamicJsonDocument doc(OTA_MANIFEST_MAX_SIZE);
+    if (deserializeJson(doc, (const char*)chunk, manifestLength) != DeserializationError::Ok) {
+        fail("Manifest is not valid JSON");
+        return;
+    }
+    const char* url = doc["url"] | "";
+    const char* digest = doc["sha256"] | "";
+    int32_t size = doc["size"] | -1;
+    if (!*url || !resolveImageUrl(url)) {
+        fail("Manifest url missing or too long");
+        return;
+    }
+    if (!isHexDigest(digest)) {
+        fail("Manifest sha256 must be 64 hex digits");
+        return;
+    }
+    lowerCopy(expectedSha, digest, sizeof(expectedSha));
+    safeStrcpy(version, doc["version"] | "", sizeof(version));
+    expectedSize = size > 0 ? size : -1;
+    web_log_printf("[OTA] Manifest: version %s, %s", *version ? version : "?", imageUrl);
+    state = OTA_DOWNLOADING;
+}
+
+static void pollManifest() {
+    if (!download) {
+        int32_t length;
+        if (!openDownload(manifestUrl, &length)) return;
+        manifestLength = 0;
+        lastDataAt = hal_millis();
+    }
+    for (;;) {
+        if (manifestLength >= OTA_MANIFEST_MAX_SIZE) {
+            fail("Manifest too large");
+            return;
+        }
+        int n = hal_download_read(download, chunk + manifestLength, OTA_MANIFEST_MAX_SIZE - manifestLength);
+        if (n < 0) break;
+        if (n == 0) {
+            if (hal_millis() - lastDataAt > OTA_STALL_TIMEOUT_MS) fail("Manifest download stalled");
+            return;
+        }
+        manifestLength += n;
+        lastDataAt = hal_millis();
+    }
+    hal_download_close(download);
+    download = nullptr;
+    parseManifest();
+}
+
+// --- Image ---
+
+static void finishImage() {
+    hal_download_close(download);
+    download = nullptr;
+    if (totalBytes > 0 && bytesWritten != (uint32_t)totalBytes) {
+        fail("Download truncated");
+        return;
+    }
+    uint8_t digest[32];
+    char hex[65];
+    sha256Finish(sha, digest);
+    sha256ToHex(digest, hex);
+    if (strcmp(hex, expectedSha) != 0) {
+        web_log_printf("[OTA] SHA-256 %s, manifest says %s", hex, expectedSha);
+        fail("SHA-256 mismatch");
+        return;
+    }
+    updateOpen = false;
+    if (!hal_update_end()) {
+        fail("Image rejected by the update check");
+        return;
+    }
+    release();
+    finishedAt = hal_millis();
+    unsigned long seconds = (finishedAt - startedAt) / 1000;
+    web_log_printf("[OTA] %lu bytes verified in %lus; rebooting", (unsigned long)bytesWritten, seconds);
+    state = OTA_VERIFIED;
+}
+
+static void pollImage() {
+    if (!download) {
+        if (!openDownload(imageUrl, &totalBytes)) return;
+        if (expectedSize > 0) {
+            if (totalBytes > 0 && totalBytes != expectedSize) {
+                fail("Image size differs from the manifest");
+                return;
+            }
+            totalBytes = expectedSize;
+        }
+        if (!hal_update_begin(totalBytes > 0 ? totalBytes : 0)) {
+            fail("Cannot begin update (image too large?)");
+            return;
+        }
+        updateOpen = true;
+        sha256Begin(sha);
+        bytesWritten = 0;
+        startedAt = lastDataAt = hal_millis();
+        web_log_printf("[OTA] Downloading %s (%ld bytes)", imageUrl, (long)totalBytes);
+    }
+
+    unsigned long sliceStart = hal_millis();
+    do {
+        size_t want = OTA_CHUNK_SIZE;
+        if (maxKbps) {
+            // Byte budget earned since the start at max_kbps
+            uint64_t allowed = (uint64_t)maxKbps * 1024 * (hal_millis() - startedAt) / 1000;
+            if (allowed <= bytesWritten) break;
+            if (allowed - bytesWritten < want) want = (size_t)(allowed - bytesWritten);
+        }
+        int n = hal_download_read(download, chunk, want);
+        if (n < 0) {
+            finishImage();
+            return;
+        }
+        if (n == 0) break;
+        sha256Update(sha, chunk, n);
+        if (!hal_update_write(chunk, n)) {
+            fail("Flash write failed");
+            return;
+        }
+        bytesWritten += n;
+        lastDataAt = hal_millis();
+    } while (hal_millis() - sliceStart < OTA_SLICE_MS);
+
+    if (hal_millis() - lastDataAt > OTA_STALL_TIMEOUT_MS) fail("Download stalled");
+}
+
+void otaPoll() {
+    OtaState current = state;
+    if (current == OTA_IDLE || current == OTA_FAILED) return;
+    if (current == OTA_VERIFIED) {
+        if (restartIssued || hal_millis() - finishedAt < OTA_REBOOT_DELAY_MS) return;
+        saveUptimeStats();
+        alertQueueFlush();
+        web_log_printf("[OTA] Restarting into version %s", *version ? version : "?");
+        restartIssued = true;  // hal_restart() returns on the host build
+        webLogFlush();
+        hal_restart();
+        return;
+    }
+    if (cancelRequested) {
+        cancelRequested = false;
+        fail("Cancelled");
+        return;
+    }
+    HeapScope heapScope(HEAP_OTA);
+    if (!chunk) chunk = new uint8_t[OTA_CHUNK_SIZE];
+    if (current == OTA_MANIFEST) pollManifest();
+    else pollImage();
+}
+
+// --- Status ---
+
+void buildOtaJson(JsonObject root) {
+    OtaState current = state;
+    root["state"] = OTA_STATE_NAMES[current];
+    root["version"] = (char*)version;
+    root["manifest"] = (char*)manifestUrl;
+    root["url"] = (char*)imageUrl;
+    root["sha256"] = (char*)expectedSha;
+    root["max_kbps"] = maxKbps;
+    root["bytes"] = bytesWritten;
+    if (totalBytes > 0) {
+        root["total"] = totalBytes;
+        root["percent"] = (uint32_t)((uint64_t)bytesWritten * 100 / totalBytes);
+    } else {
+        root["total"] = nullptr;
+        root["percent"] = nullptr;
+    }
+
+    unsigned long end = (current == OTA_DOWNLOADING) ? hal_millis() : finishedAt;
+    unsigned long elapsed = startedAt && end ? end - startedAt : 0;
+    uint32_t rate = elapsed ? (uint32_t)((uint64_t)bytesWritten * 1000 / elapsed) : 0;
+    root["elapsed_seconds"] = elapsed / 1000;
+    root["bytes_per_second"] = rate;
+    if (current == OTA_DOWNLOADING && totalBytes > 0 && rate > 0) {
+        root["eta_seconds"] = ((uint32_t)totalBytes - bytesWritten) / rate;
+    } else {
+        root["eta_seconds"] = nullptr;
+    }
+    if (error[0]) root["error"] = (char*)error;
+    else root["error"] = nullptr;
+}
@@ -0,0 +1,57 @@
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+#include <ArduinoJson.h>
+
+// --- Pull OTA ---
+// The device fetches a firmware image itself instead of having it uploaded
+// through the browser. The image is read from monitorLoop() a chunk at a
+// time, at most OTA_SLICE_MS per pass (and optionally under max_kbps), hashed
+// with SHA-256 as it streams to the inactive partition, and only made
+// bootable if the digest matches the manifest. Checks keep running for the
+// whole download; the device is offline only for the reboot itself.
+//
+// Manifest (JSON): {"version":"14.0","url":"firmware.bin","size":1234567,
+// "sha256":"<64 hex>"}. A relative url is resolved against the manifest's.
+
+const size_t OTA_CHUNK_SIZE = 4096;            // One flash sector per write
+const uint32_t OTA_SLICE_MS = 20;              // Download time per monitorLoop() pass
+const uint32_t OTA_OPEN_TIMEOUT_MS = 5000;
+const uint32_t OTA_STALL_TIMEOUT_MS = 30000;   // No data for this long: give up
+const uint32_t OTA_REBOOT_DELAY_MS = 2000;     // Lets the last status poll see "verified"
+const size_t OTA_MANIFEST_MAX_SIZE = 1024;
+
+enum OtaState {
+    OTA_IDLE,
+    OTA_MANIFEST,     // Fetching the manifest
+    OTA_DOWNLOADING,  // Streaming the image to flash
+    OTA_VERIFIED,     // Digest matched; rebooting shortly
+    OTA_FAILED
+};
+
+// POST /api/ota: {"manifest":"http://..."} or {"url":"http://...","sha256":"...",
+// "size":N}, plus optional "max_kbps". The work starts on the next
+// monitorLoop() pass. Returns an error message or nullptr.
+const char* startOtaFromJson(JsonObjectConst json);
+
+// POST /api/ota/cancel: abandon a running update (the running firmware stays).
+// Returns false when there was nothing to cancel.
+bool cancelOta();
+
+bool otaInProgress();
+
+// The browser upload (/updatefirmware) writes the same update partition, so
+// only one of the two may run: startOtaFromJson() refuses while an upload
+// holds the partition, and an upload may only claim it while no pull update
+// runs. Both are claimed from web handlers (one task); the pull update
+// releases it from monitorLoop() by finishing.
+bool otaPushBegin();  // false while a pull update or another upload runs
+void otaPushEnd();    // Upload finished, failed or disconnected
+bool otaPushActive();
+
+// Advance the update; called from monitorLoop()
+void otaPoll();
+
+// GET /api/ota
+void buildOtaJson(JsonObject root);
@@ -0,0 +1,172 @@
+#include "scheduler.h"
+
+#include <string.h>
+
+#include "alert_queue.h"
+#include "diagnostics.h"
+#include "federation.h"
+#include "latency.h"
+#include "metrics_push.h"
+#include "monitor_hal.h"
+#include "monitor_config.h"
+#include "monitor_state.h"
+#include "ota_pull.h"
+#include "status_snapshot.h"
+#include "uptime_stats.h"
+#include "web_log.h"
+
+int current_check_index = 0;  // Track which server to check next (time-distributed checks)
+static uint16_t scheduled_interval[NUM_TARGETS];  // Longest interval in force since the last check
+uint32_t probes_sent = 0;
+uint32_t probes_coalesced = 0;
+
+// --- WiFi Reconnection Timer ---
+static unsigned long lastWifiReconnectAttempt = 0;
+static const long wifiReconnectInterval = 10000; // Try to reconnect every 10 seconds
+
+void manageWifiConnection() {
+  if (!hal_network_connected()) {
+    if (hal_millis() - lastWifiReconnectAttempt > wifiReconnectInterval) {
+      lastWifiReconnectAttempt = hal_millis();
+      web_log_printf("WiFi connection lost. Attempting to reconnect...");
+      hal_network_reconnect(); // Reconnect using stored credentials
+    }
+  }
+}
+
+static bool isProbed(int i) {
+    return targets[i].enabled && strcmp(targets[i].weburl, "0") != 0 && strlen(targets[i].weburl) >= 10;
+}
+
+// Start of a check; lag is how far past its due time it starts. The
+// interval shrinks between checks when a parent recovers, so measure
+// against the longest interval seen while waiting; the hold-off is
+// not scheduler lag.
+static void noteCheckStart(int i, unsigned long now) {
+    if (last_check_time[i] > 0) {
+        unsigned long dueMs = scheduled_interval[i] * 1000UL;
+        unsigned long lagMs = now - last_check_time[i] > dueMs ? now - last_check_time[i] - dueMs : 0;
+        latencyRecord(schedulingLag[i], lagMs * 1000);
+    }
+    last_check_time[i] = now;
+}
+
+static void finishCheck(int i, int code, unsigned long elapsedMs) {
+    processCheckResult(i, code, elapsedMs);
+    metricsPushRecord(i);
+    scheduled_interval[i] = effectiveCheckInterval(i);
+}
+
+// Hand target i's result to every other target probing the same URL that
+// falls due within coalesce_window seconds, as if each had sent the request
+static void shareProbeResult(int i, int code, unsigned long startedAt, unsigned long elapsedMs) {
+    if (coalesce_window <= 0) return;
+    unsigned long windowMs = coalesce_window * 1000UL;
+    for (int j = 0; j < NUM_TARGETS; j++) {
+        if (j == i || !isProbed(j) || strcmp(targets[j].weburl, targets[i].weburl) != 0) continue;
+        unsigned long intervalMs = effectiveCheckInterval(j) * 1000UL;
+        if (last_check_time[j] > 0 && startedAt - last_check_time[j] + windowMs < intervalMs) continue;
+        noteCheckStart(j, startedAt);
+        finishCheck(j, code, elapsedMs);
+        probes_coalesced++;
+    }
+}
+
+int runMonitorCycle() {
+    int checks_attempted = 0;
+
+    // Find next enabled server that's due for a check
+    while (checks_attempted < NUM_TARGETS) {
+        int i = current_check_index;
+
+        // Skip disabled servers
+        if (!isProbed(i)) {
+            if (httpCode[i] != 0) {
+                httpCode[i] = 0;
+                statusChanged();
+            }
+            current_check_index = (current_check_index + 1) % NUM_TARGETS;
+            checks_attempted++;
+            continue;
+        }
+
+        // Check if enough time has elapsed since last check (skip if not ready)
+        // Allow immediate check on first boot (when last_check_time[i] == 0)
+        uint16_t interval = effectiveCheckInterval(i);
+        if (interval > scheduled_interval[i]) scheduled_interval[i] = interval;
+        unsigned long intervalMs = interval * 1000UL;
+        if (last_check_time[i] > 0 && hal_millis() - last_check_time[i] < intervalMs) {
+            current_check_index = (current_check_index + 1) % NUM_TARGETS;
+            checks_attempted++;
+            continue;
+        }
+
+        // Perform the check
+        unsigned long now = hal_millis();
+        noteCheckStart(i, now);
+
+        HalHttpRequest request = {};
+        request.method = "GET";
+        request.url = targets[i].weburl;
+        request.timeout_ms = 5000;  // 5 second timeout to prevent blocking AsyncWebServer
+        request.follow_redirects = true;
+        unsigned long singleStartTime = hal_millis();
+        int currentHttpCode;
+        {
+            HeapScope heapScope(HEAP_PROBE);
+            LatencyScope latency(probeLatency);
+            currentHttpCode = hal_http_request(request);
+        }
+        unsigned long singleEndTime = hal_millis();
+        probes_sent++;
+
+        finishCheck(i, currentHttpCode, singleEndTime - singleStartTime);
+        shareProbeResult(i, currentHttpCode, now, singleEndTime - singleStartTime);
+
+        // Move to next server; only check one server per call
+        current_check_index = (current_check_index + 1) % NUM_TARGETS;
+        return i;
+    }
+    return -1;
+}
+
+void monitorLoop() {
+    LatencyScope latency(loopLatency);
+    manageWifiConnection();
+
+    // Heap monitoring for diagnostics (every 60 seconds)
+    static unsigned long lastHeapCheck = 0;
+    if (hal_millis() - lastHeapCheck > 60000) {
+        recordHeapTrendSample();
+        recordStackFree(STACK_LOOP);
+        HalHeapStats heap;
+        hal_heap_stats(&heap);
+        if (heap.free_bytes > 0) {
+            int fragmentation = 100 - ((heap.max_alloc_bytes * 100) / heap.free_bytes);
+            web_log_printf("Heap - Free: %lu, Min: %lu, MaxBlock: %lu, Frag: %d%%",
+                (unsigned long)heap.free_bytes, (unsigned long)heap.min_free_bytes,
+                (unsigned long)heap.max_alloc_bytes, fragmentation);
+        }
+        lastHeapCheck = hal_millis();
+    }
+
+    // Persist uptime counters periodically so SLA figures survive reboots
+    if (hal_millis() - lastUptimeSave > UPTIME_SAVE_INTERVAL) {
+        saveUptimeStats();
+        lastUptimeSave = hal_millis();
+    }
+
+    // Run offline too: due batches are spilled to the backlog, and the alert
+    // queue notices the reconnect
+    metricsPushPoll();
+    alertQueuePoll();
+    otaPoll();
+
+    if (hal_network_connected()) {
+        federationPoll();
+        runMonitorCycle();
+    }
+
+    // Console and /api/logs output of everything logged since the last pass
+    webLogFlush();
+}
@@ -0,0 +1,24 @@
+#pragma once
+
+#include <stdint.h>
+
+// --- Check scheduler ---
+// Time-distributed checks: at most one target is probed per call, which keeps
+// peak memory low and lets the web server run between probes. Targets with
+// the same URL share a probe: its result also counts as the check of every
+// other such target due within coalesce_window seconds, so the request rate
+// follows the number of distinct URLs.
+
+extern int current_check_index;  // Track which server to check next
+extern uint32_t probes_sent;       // HTTP requests made for checks
+extern uint32_t probes_coalesced;  // Check results taken from another target's probe
+
+// Retry the network connection at most every wifiReconnectInterval ms
+void manageWifiConnection();
+
+// Probe the next enabled target that is due and share the result with
+// targets of the same URL. Returns the index probed, or -1.
+int runMonitorCycle();
+
+// One pass of the main loop: connectivity, housekeeping, at most one check
+void monitorLoop();
@@ -0,0 +1,25 @@
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+
+// --- SHA-256 (FIPS 180-4) ---
+// Incremental, so a firmware image can be hashed while it streams to flash
+// without ever being held in RAM. Deliberately not mbedtls: the core reaches
+// the platform only through monitor_hal.h, and this way the digest code that
+// guards the device's flash is the same one the native build tests against
+// sha256sum. A 4 KB chunk is far cheaper than downloading it.
+
+struct Sha256 {
+    uint32_t state[8];
+    uint64_t length;      // Bytes hashed so far
+    uint8_t block[64];
+    uint8_t blockLength;
+};
+
+void sha256Begin(Sha256& ctx);
+void sha256Update(Sha256& ctx, const uint8_t* data, size_t len);
+void sha256Finish(Sha256& ctx, uint8_t digest[32]);
+
+// Lower-case hex of a digest (out gets 65 bytes with the NUL)
+void sha256ToHex(const uint8_t digest[32], char out[65]);
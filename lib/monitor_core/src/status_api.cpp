@@ -0,0 +1,277 @@
+#include "status_api.h"
+
+#include <stdlib.h>
+#include <string.h>
+
+#include "group_index.h"
+#include "latency_baseline.h"
+#include "monitor_hal.h"
+#include "monitor_config.h"
+#include "monitor_state.h"
+#include "uptime_stats.h"
+
+// Per-target keys selectable with fields=; names in the same order
+enum TargetFieldBit {
+    TF_HTTP_CODE,
+    TF_EFFECTIVE_INTERVAL_SECONDS,
+    TF_BLOCKED_BY,
+    TF_ALERT_HELD,
+    TF_DEGRADED,
+    TF_BASELINE,
+    TF_LOG,
+    TF_PING,
+    TF_UPTIME,
+    TF_CONFIG,
+    TARGET_FIELD_COUNT
+};
+
+static const char* const TARGET_FIELDS[TARGET_FIELD_COUNT] = {
+    "http_code", "effective_interval_seconds", "blocked_by", "alert_held", "degraded", "baseline", "log", "ping",
+    "uptime", "config"
+};
+
+// Keys inside "config"
+enum ConfigFieldBit {
+    CF_SERVER_NAME,
+    CF_GROUP_NAME,
+    CF_ENABLED,
+    CF_WEBURL,
+    CF_DISCORD_WEBHOOK,
+    CF_NTFY_URL,
+    CF_NTFY_PRIORITY,
+    CF_TELEGRAM_BOT_TOKEN,
+    CF_TELEGRAM_CHAT_ID_1,
+    CF_TELEGRAM_CHAT_ID_2,
+    CF_TELEGRAM_CHAT_ID_3,
+    CF_HTTP_GET_URL_ON,
+    CF_HTTP_GET_URL_OFF,
+    CF_ONLINE_MESSAGE,
+    CF_OFFLINE_MESSAGE,
+    CF_CHECK_INTERVAL_SECONDS,
+    CF_RETRY_INTERVAL_SECONDS,
+    CF_MAX_CHECK_INTERVAL_SECONDS,
+    CF_FAILURE_THRESHOLD,
+    CF_RECOVERY_THRESHOLD,
+    CF_PARENT_ID,
+    CF_LATENCY_THRESHOLD_MS,
+    CF_LATENCY_DEVIATIONS,
+    CF_LATENCY_SLOW_CHECKS,
+    CF_LATENCY_RECOVERY_CHECKS,
+    CONFIG_FIELD_COUNT
+};
+
+static const char* const CONFIG_FIELDS[CONFIG_FIELD_COUNT] = {
+    "server_name", "group_name", "enabled", "weburl", "discord_webhook", "ntfy_url", "ntfy_priority",
+    "telegram_bot_token", "telegram_chat_id_1", "telegram_chat_id_2", "telegram_chat_id_3",
+    "http_get_url_on", "http_get_url_off", "online_message", "offline_message",
+    "check_interval_seconds", "retry_interval_seconds", "max_check_interval_seconds",
+    "failure_threshold", "recovery_threshold", "parent_id", "latency_threshold_ms", "latency_deviations",
+    "latency_slow_checks", "latency_recovery_checks"
+};
+
+static const char* const STATE_NAMES[] = {"up", "down", "failing", "enabled", "disabled", "degraded"};
+
+// Bit of the name in table, or -1. name is the len bytes before a separator.
+static int lookupName(const char* const* table, int count, const char* name, size_t len) {
+    for (int k = 0; k < count; k++) {
+        if (strlen(table[k]) == len && strncmp(table[k], name, len) == 0) return k;
+    }
+    return -1;
+}
+
+void statusFilterAll(StatusFilter& filter) {
+    memset(&filter, 0, sizeof(filter));
+    filter.fields = (1 << TARGET_FIELD_COUNT) - 1;
+    filter.config_fields = (1UL << CONFIG_FIELD_COUNT) - 1;
+}
+
+const char* parseStatusFilter(StatusFilter& filter, const char* group, const char* state, const char* ids, const char* fields) {
+    statusFilterAll(filter);
+    filter.group = group;
+
+    // Comma-separated lists; empty items are skipped
+    for (const char* p = state; p && *p; ) {
+        size_t len = strcspn(p, ",");
+        if (len > 0) {
+            int bit = lookupName(STATE_NAMES, sizeof(STATE_NAMES) / sizeof(STATE_NAMES[0]), p, len);
+            if (bit < 0) return "Unknown state";
+            filter.states |= 1 << bit;
+        }
+        p += len + (p[len] == ',');
+    }
+    for (const char* p = ids; p; ) {
+        char* end;
+        long id = strtol(p, &end, 10);
+        if (end == p || id < 0 || id >= NUM_TARGETS || (*end != ',' && *end != '\0')) return "Invalid ids";
+        filter.ids[id / 8] |= 1 << (id % 8);
+        filter.has_ids = true;
+        p = *end ? end + 1 : nullptr;
+    }
+    if (fields) {
+        filter.fields = 0;
+        filter.config_fields = 0;
+        for (const char* p = fields; *p; ) {
+            size_t len = strcspn(p, ",");
+            if (len > 7 && strncmp(p, "config.", 7) == 0) {
+                int bit = lookupName(CONFIG_FIELDS, CONFIG_FIELD_COUNT, p + 7, len - 7);
+                if (bit < 0) return "Unknown field";
+                filter.fields |= (1 << TF_CONFIG);
+                filter.config_fields |= 1UL << bit;
+            } else if (len == 6 && strncmp(p, "config", 6) == 0) {
+                filter.fields |= (1 << TF_CONFIG);
+                filter.config_fields = (1UL << CONFIG_FIELD_COUNT) - 1;
+            } else if (len > 0 && !(len == 2 && strncmp(p, "id", 2) == 0)) {
+                int bit = lookupName(TARGET_FIELDS, TARGET_FIELD_COUNT, p, len);
+                if (bit < 0) return "Unknown field";
+                filter.fields |= 1 << bit;
+            }
+            p += len + (p[len] == ',');
+        }
+    }
+    return nullptr;
+}
+
+static bool isSelected(const StatusFilter& filter, int i) {
+    if (filter.has_ids && !(filter.ids[i / 8] & (1 << (i % 8)))) return false;
+    if (filter.group && strcmp(targets[i].group_name, filter.group) != 0) return false;
+    if (filter.states) {
+        bool enabled = targets[i].enabled;
+        uint8_t states = enabled ? STATE_ENABLED : STATE_DISABLED;
+        if (enabled && confirmed_online_state[i]) states |= failure_count[i] > 0 ? STATE_UP | STATE_FAILING : STATE_UP;
+        if (enabled && degraded[i]) states |= STATE_DEGRADED;
+        if (enabled && !confirmed_online_state[i]) states |= STATE_DOWN;
+        if (!(filter.states & states)) return false;
+    }
+    return true;
+}
+
+size_t statusJsonCapacity(const StatusFilter& filter) {
+    int selected = 0;
+    for (int i = 0; i < NUM_TARGETS; i++) {
+        if (isSelected(filter, i)) selected++;
+    }
+    return 512 + (STATUS_JSON_CAPACITY - 512) / NUM_TARGETS * selected;
+}
+
+void buildStatusJson(JsonObject root) {
+    StatusFilter filter;
+    statusFilterAll(filter);
+    buildStatusJson(root, filter);
+}
+
+void buildStatusJson(JsonObject root, const StatusFilter& filter) {
+    char ssid[33];
+    hal_network_ssid(ssid, sizeof(ssid));
+
+    root["firmware_version"] = CONFIG_VERSION;
+    JsonObject general_config = root.createNestedObject("general_config");
+    general_config["ssid"] = ssid;
+    general_config["gmt_offset"] = gmt_offset;
+    general_config["coalesce_window"] = coalesce_window;
+
+    uint16_t f = filter.fields;
+    uint32_t c = filter.config_fields;
+    JsonArray targets_json = root.createNestedArray("targets");
+    for (int i = 0; i < NUM_TARGETS; i++) {
+        if (!isSelected(filter, i)) continue;
+        JsonObject target_obj = targets_json.createNestedObject();
+        target_obj["id"] = i;
+        if (f & (1 << TF_HTTP_CODE)) target_obj["http_code"] = httpCode[i];
+        if (f & (1 << TF_EFFECTIVE_INTERVAL_SECONDS)) target_obj["effective_interval_seconds"] = effectiveCheckInterval(i);
+        if (f & (1 << TF_BLOCKED_BY)) target_obj["blocked_by"] = offlineAncestor(i);
+        if (f & (1 << TF_ALERT_HELD)) target_obj["alert_held"] = alert_held[i];
+        if (f & (1 << TF_DEGRADED)) target_obj["degraded"] = degraded[i];
+        if (f & (1 << TF_BASELINE)) {
+            const LatencyBaseline& b = latencyBaselines[i];
+            JsonObject baseline = target_obj.createNestedObject("baseline");
+            baseline["samples"] = b.samples;
+            if (b.samples) {
+                baseline["mean_ms"] = (uint32_t)(b.mean_ms + 0.5f);
+                baseline["deviation_ms"] = (uint32_t)(b.deviation_ms + 0.5f);
+            } else {
+                baseline["mean_ms"] = nullptr;
+                baseline["deviation_ms"] = nullptr;
+            }
+            uint32_t limit = latencySlowLimitMs(i);
+            if (limit) baseline["limit_ms"] = limit;
+            else baseline["limit_ms"] = nullptr;
+        }
+        if (f & (1 << TF_LOG)) target_obj["log"] = targetLogMessages[i];
+        if (f & (1 << TF_PING)) {
+            JsonObject ping = target_obj.createNestedObject("ping");
+            ping["last"] = pingTime[i];
+            ping["min"] = minpingTime[i];
+            ping["max"] = maxpingTime[i];
+        }
+        if (f & (1 << TF_UPTIME)) {
+            JsonObject uptime = target_obj.createNestedObject("uptime");
+            setUptimePercent(uptime, "24h", uptimeStats[i].sum_24h_ok, uptimeStats[i].sum_24h_total);
+            setUptimePercent(uptime, "7d", uptimeStats[i].sum_7d_ok, uptimeStats[i].sum_7d_total);
+            setUptimePercent(uptime, "30d", uptimeStats[i].sum_30d_ok, uptimeStats[i].sum_30d_total);
+        }
+        if (!(f & (1 << TF_CONFIG))) continue;
+
+        TargetConfig& t = targets[i];  // Non-const: char[] values are copied
+        JsonObject config = target_obj.createNestedObject("config");
+        if (c & (1UL << CF_SERVER_NAME)) config["server_name"] = t.server_name;
+        if (c & (1UL << CF_GROUP_NAME)) config["group_name"] = t.group_name;
+        if (c & (1UL << CF_ENABLED)) config["enabled"] = t.enabled;
+        if (c & (1UL << CF_WEBURL)) config["weburl"] = t.weburl;
+        if (c & (1UL << CF_DISCORD_WEBHOOK)) config["discord_webhook"] = t.discord_webhook_url;
+        if (c & (1UL << CF_NTFY_URL)) config["ntfy_url"] = t.ntfy_url;
+        if (c & (1UL << CF_NTFY_PRIORITY)) config["ntfy_priority"] = t.ntfy_priority;
+        if (c & (1UL << CF_TELEGRAM_BOT_TOKEN)) config["telegram_bot_token"] = t.telegram_bot_token;
+        if (c & (1UL << CF_TELEGRAM_CHAT_ID_1)) config["telegram_chat_id_1"] = t.telegram_chat_id_1;
+        if (c & (1UL << CF_TELEGRAM_CHAT_ID_2)) config["telegram_chat_id_2"] = t.telegram_chat_id_2;
+        if (c & (1UL << CF_TELEGRAM_CHAT_ID_3)) config["telegram_chat_id_3"] = t.telegram_chat_id_3;
+        if (c & (1UL << CF_HTTP_GET_URL_ON)) config["http_get_url_on"] = t.http_get_url_on;
+        if (c & (1UL << CF_HTTP_GET_URL_OFF)) config["http_get_url_off"] = t.http_get_url_off;
+        if (c & (1UL << CF_ONLINE_MESSAGE)) config["online_message"] = t.online_message;
+        if (c & (1UL << CF_OFFLINE_MESSAGE)) config["offline_message"] = t.offline_message;
+        if (c & (1UL << CF_CHECK_INTERVAL_SECONDS)) config["check_interval_seconds"] = t.check_interval_seconds;
+        if (c & (1UL << CF_RETRY_INTERVAL_SECONDS)) config["retry_interval_seconds"] = t.retry_interval_seconds;
+        if (c & (1UL << CF_MAX_CHECK_INTERVAL_SECONDS)) config["max_check_interval_seconds"] = t.max_check_interval_seconds;
+        if (c & (1UL << CF_FAILURE_THRESHOLD)) config["failure_threshold"] = t.failure_threshold;
+        if (c & (1UL << CF_RECOVERY_THRESHOLD)) config["recovery_threshold"] = t.recovery_threshold;
+        if (c & (1UL << CF_PARENT_ID)) config["parent_id"] = t.parent_id;
+        if (c & (1UL << CF_LATENCY_THRESHOLD_MS)) config["latency_threshold_ms"] = t.latency_threshold_ms;
+        if (c & (1UL << CF_LATENCY_DEVIATIONS)) config["latency_deviations"] = t.latency_deviations;
+        if (c & (1UL << CF_LATENCY_SLOW_CHECKS)) config["latency_slow_checks"] = t.latency_slow_checks;
+        if (c & (1UL << CF_LATENCY_RECOVERY_CHECKS)) config["latency_recovery_checks"] = t.latency_recovery_checks;
+    }
+}
+
+void buildGroupsJson(JsonArray groups) {
+    GroupSummary group;
+    for (int i = 0; i < NUM_TARGETS; i++) {
+        int g = groupLedBy(i);
+        if (g < 0) continue;
+        getGroupSummary(g, group);
+        groups.add((char*)group.name);  // char* so ArduinoJson copies the name
+    }
+}
+
+void buildGroupsSummaryJson(JsonObject root) {
+    unsigned long now = hal_millis();
+    int up = 0, down = 0;
+    GroupSummary group;
+    JsonArray groups = root.createNestedArray("groups");
+    for (int i = 0; i < NUM_TARGETS; i++) {
+        int g = groupLedBy(i);
+        if (g < 0) continue;
+        getGroupSummary(g, group);
+        JsonObject obj = groups.createNestedObject();
+        obj["name"] = (char*)group.name;
+        obj["total"] = group.members;
+        obj["up"] = group.up;
+        obj["down"] = group.down;
+        obj["worst_latency_ms"] = group.worst_latency_ms;
+        obj["median_latency_ms"] = group.median_latency_ms;
+        if (group.last_change) obj["last_change_seconds_ago"] = (now - group.last_change) / 1000;
+        else obj["last_change_seconds_ago"] = nullptr;
+        up += group.up;
+        down += group.down;
+    }
+    root["up"] = up;
+    root["down"] = down;
+}
@@ -0,0 +1,62 @@
+#pragma once
+
+#include <ArduinoJson.h>
+
+#include "monitor_config.h"
+
+// --- JSON serialization for the REST API ---
+// Kept free of the web server so the same code runs on the device and host.
+
+// --- /api/status selection ---
+// Query parameters, applied while serializing so unselected targets and
+// fields are never encoded:
+//   group=NAME        only targets of this group
+//   state=LIST        any of up, down (confirmed), failing (online with
+//                     unconfirmed failures), enabled, disabled, degraded
+//                     (confirmed slow, see monitor_state.h)
+//   ids=LIST          only these slots, e.g. ids=0,3,7
+//   fields=LIST       per-target keys to include ("id" is always present):
+//                     http_code, effective_interval_seconds, blocked_by,
+//                     alert_held, degraded, baseline, log, ping, uptime,
+//                     config, or a single config key such as
+//                     config.server_name
+enum StatusState {
+    STATE_UP = 1 << 0,
+    STATE_DOWN = 1 << 1,
+    STATE_FAILING = 1 << 2,
+    STATE_ENABLED = 1 << 3,
+    STATE_DISABLED = 1 << 4,
+    STATE_DEGRADED = 1 << 5
+};
+
+struct StatusFilter {
+    const char* group;   // nullptr = any
+    uint8_t states;      // StatusState bits, 0 = any
+    bool has_ids;
+    uint8_t ids[(NUM_TARGETS + 7) / 8];
+    uint16_t fields;     // Per-target keys (bit order of the list above)
+    uint32_t config_fields;  // Keys inside "config"
+};
+
+// Everything, as GET /api/status without parameters
+void statusFilterAll(StatusFilter& filter);
+
+// Parse the query parameters (nullptr when absent) into filter. Returns an
+// error message for a malformed list or unknown name, nullptr otherwise.
+// group must stay valid while the filter is used.
+const char* parseStatusFilter(StatusFilter& filter, const char* group, const char* state, const char* ids, const char* fields);
+
+// Document capacity for the selected targets and fields
+size_t statusJsonCapacity(const StatusFilter& filter);
+
+// Body of GET /api/status (firmware version, general config, every slot)
+void buildStatusJson(JsonObject root);
+void buildStatusJson(JsonObject root, const StatusFilter& filter);
+
+// Body of GET /api/groups (unique group names of enabled targets)
+void buildGroupsJson(JsonArray groups);
+
+// Body of GET /api/groups/summary: per-group member, up/down counts, worst
+// and median latency and time since the last confirmed transition
+void buildGroupsSummaryJson(JsonObject root);
+const size_t GROUPS_SUMMARY_JSON_CAPACITY = 256 + 192UL * NUM_TARGETS;
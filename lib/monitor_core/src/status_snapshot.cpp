@@ -0,0 +1,98 @@
+#include "status_snapshot.h"
+
+#include <new>
+#include <stdio.h>
+#include <string.h>
+
+#include "diagnostics.h"
+#include "monitor_config.h"
+#include "monitor_hal.h"
+#include "status_api.h"
+
+static volatile uint32_t generation = 1;
+static volatile uint32_t urgentGeneration = 1;  // Last statusChanged()
+static uint32_t bootNonce = 0;
+static std::shared_ptr<const StatusSnapshot> snapshots[3];  // Per ApiFormat
+
+static uint32_t builds = 0;
+static uint32_t served = 0;
+
+struct SnapshotWriter {
+    uint8_t* data;
+    size_t pos;
+    size_t write(uint8_t c) { data[pos++] = c; return 1; }
+    size_t write(const uint8_t* s, size_t n) { memcpy(data + pos, s, n); pos += n; return n; }
+};
+
+void statusChanged() {
+    urgentGeneration = ++generation;
+}
+
+void statusValuesChanged() {
+    generation++;
+}
+
+// Still good enough to serve for a status at generation current
+static bool snapshotUsable(const StatusSnapshot& snapshot, uint32_t current) {
+    if (snapshot.generation == current) return true;
+    if ((int32_t)(snapshot.generation - urgentGeneration) < 0) return false;
+    return hal_millis() - snapshot.built_ms < STATUS_SNAPSHOT_REFRESH_MS;
+}
+
+std::shared_ptr<const StatusSnapshot> statusSnapshot(ApiFormat format) {
+    // Read once: a change while building makes the next request rebuild
+    uint32_t current = generation;
+    std::shared_ptr<const StatusSnapshot>& slot = snapshots[format];
+    if (slot && snapshotUsable(*slot, current)) {
+        served++;
+        return slot;
+    }
+    slot.reset();  // Freed now unless a response is still sending it
+
+    HeapScope heapScope(HEAP_STATUS_JSON);
+    DynamicJsonDocument doc(STATUS_JSON_CAPACITY);
+    buildStatusJson(doc.to<JsonObject>());
+    heapScope.sample();
+    heapScope.noteBuffer(STATUS_JSON_CAPACITY, doc.memoryUsage());
+
+    StatusSnapshot* snapshot = new (std::nothrow) StatusSnapshot();
+    if (!snapshot) return slot;
+    snapshot->generation = current;
+    snapshot->built_ms = hal_millis();
+    snapshot->format = format;
+    snapshot->length = measureApiDocument(doc.as<JsonVariantConst>(), format);
+    snapshot->data = new (std::nothrow) uint8_t[snapshot->length];
+    if (!snapshot->data) {
+        delete snapshot;
+        return slot;
+    }
+    SnapshotWriter writer = {snapshot->data, 0};
+    serializeApiDocument(doc.as<JsonVariantConst>(), format, writer);
+    slot.reset(snapshot);
+    builds++;
+    served++;
+    return slot;
+}
+
+void statusSnapshotEtag(const StatusSnapshot& snapshot, char* buf, size_t size) {
+    while (!bootNonce) bootNonce = hal_random();
+    snprintf(buf, size, "\"s%08lx.%lu.%d\"", (unsigned long)bootNonce, (unsigned long)snapshot.generation,
+        (int)snapshot.format);
+}
+
+void buildStatusSnapshotJson(JsonObject root) {
+    static const char* const FORMAT_NAMES[] = {"json", "cbor", "msgpack"};
+    root["generation"] = generation;
+    root["builds"] = builds;
+    root["served"] = served;
+    JsonObject formats = root.createNestedObject("formats");
+    for (int f = 0; f < 3; f++) {
+        const std::shared_ptr<const StatusSnapshot>& slot = snapshots[f];
+        if (!slot) continue;
+        JsonObject obj = formats.createNestedObject(FORMAT_NAMES[f]);
+        obj["bytes"] = slot->length;
+        obj["current"] = slot->generation == generation;
+        obj["age_ms"] = hal_millis() - slot->built_ms;
+        obj["references"] = slot.use_count() - 1;  // Responses still sending it
+    }
+}
@@ -0,0 +1,59 @@
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+#include <memory>
+#include <ArduinoJson.h>
+
+#include "api_encoding.h"
+
+// --- Shared /api/status snapshot ---
+// Every open dashboard polls the unfiltered /api/status. Instead of building
+// and encoding the document for each request, the encoded body is kept per
+// format and handed to responses by shared_ptr, so concurrent and repeated
+// polls copy bytes out of one buffer; responses still sending an old buffer
+// keep it alive until they finish. Filtered requests (?group=, ?fields=, ...)
+// are built per request.
+//
+// Changes come in two kinds. statusChanged() (confirmed transitions, a check
+// flipping between ok and failed, degraded, held alerts, config loads and
+// saves) makes the next request rebuild. statusValuesChanged() (ping times,
+// counters and uptime of an ordinary check) only marks the snapshot stale:
+// it is rebuilt once it is STATUS_SNAPSHOT_REFRESH_MS old. With a check
+// every few seconds, every poll would otherwise rebuild.
+//
+// The snapshot is only built and released on the web server task; the
+// monitor loop only bumps the generation.
+
+// Two dashboard polls (every 5 s)
+#define STATUS_SNAPSHOT_REFRESH_MS 10000
+
+struct StatusSnapshot {
+    uint32_t generation;
+    uint32_t built_ms;
+    ApiFormat format;
+    size_t length;
+    uint8_t* data;
+
+    StatusSnapshot() : generation(0), built_ms(0), format(API_FORMAT_JSON), length(0), data(nullptr) {}
+    ~StatusSnapshot() { delete[] data; }
+    StatusSnapshot(const StatusSnapshot&) = delete;
+    StatusSnapshot& operator=(const StatusSnapshot&) = delete;
+};
+
+// Something /api/status shows has changed and should show at once
+void statusChanged();
+
+// Only measurements changed; may show up to STATUS_SNAPSHOT_REFRESH_MS late
+void statusValuesChanged();
+
+// Encoded status in the format, rebuilt as described above; empty when there
+// is no memory for it
+std::shared_ptr<const StatusSnapshot> statusSnapshot(ApiFormat format);
+
+// ETag of a snapshot: a per-boot nonce, the generation and the format, so a
+// validator from before a reboot never matches
+void statusSnapshotEtag(const StatusSnapshot& snapshot, char* buf, size_t size);
+
+// "status_snapshot" object of GET /api/diagnostics
+void buildStatusSnapshotJson(JsonObject root);
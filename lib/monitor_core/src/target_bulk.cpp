@@ -0,0 +1,247 @@
+#include "target_bulk.h"
+
+#include <string.h>
+
+#include "web_log.h"
+
+enum BatchState {
+    BATCH_EXPECT_ARRAY,  // Before the opening bracket
+    BATCH_IN_ARRAY,      // Between elements
+    BATCH_IN_ELEMENT,    // Collecting an object
+    BATCH_DONE,          // After the closing bracket
+    BATCH_FAILED
+};
+
+const size_t BATCH_DOC_CAPACITY = 1024;  // One operation; strings stay in the element buffer
+
+static bool isJsonSpace(char c) {
+    return c == ' ' || c == '\t' || c == '\r' || c == '\n';
+}
+
+void batchBegin(TargetBatch& batch) {
+    memset(&batch, 0, sizeof(batch));
+    batch.state = BATCH_EXPECT_ARRAY;
+}
+
+static void recordError(TargetBatch& batch, int index, const char* message) {
+    batch.failed++;
+    if (batch.error_count < BATCH_MAX_ERRORS) {
+        batch.errors[batch.error_count].index = index;
+        batch.errors[batch.error_count].message = message;
+        batch.error_count++;
+    }
+}
+
+static void failBatch(TargetBatch& batch, const char* error) {
+    batch.error = error;
+    batch.state = BATCH_FAILED;
+}
+
+static const char* applyOperation(TargetBatch& batch, char* json, size_t len) {
+    DynamicJsonDocument doc(BATCH_DOC_CAPACITY);
+    if (deserializeJson(doc, json, len) != DeserializationError::Ok) return "Invalid JSON";
+    JsonObjectConst op = doc.as<JsonObjectConst>();
+
+    const char* kind = op["op"] | (op.containsKey("id") ? "update" : "add");
+    if (strcmp(kind, "add") == 0) {
+        int slot = -1;
+        const char* error = addTargetFromJson(op, &slot);
+        if (!error && batch.added_count < NUM_TARGETS) batch.added[batch.added_count++] = slot;
+        return error;
+    }
+    if (strcmp(kind, "update") == 0) return updateTargetFromJson(op);
+    if (strcmp(kind, "delete") == 0) return deleteTarget(op["id"] | -1);
+    return "Unknown op";
+}
+
+static void finishElement(TargetBatch& batch) {
+    int index = batch.operations++;
+    if (batch.overflow) {
+        recordError(batch, index, "Operation too large");
+        return;
+    }
+    batch.element[batch.element_len] = '\0';
+    const char* error = applyOperation(batch, batch.element, batch.element_len);
+    if (error) recordError(batch, index, error);
+    else batch.applied++;
+}
+
+void batchFeed(TargetBatch& batch, const char* data, size_t len) {
+    for (size_t i = 0; i < len && batch.state != BATCH_FAILED; i++) {
+        char c = data[i];
+        switch (batch.state) {
+            case BATCH_EXPECT_ARRAY:
+                if (c == '[') batch.state = BATCH_IN_ARRAY;
+                else if (!isJsonSpace(c)) failBatch(batch, "Expected a JSON array");
+                break;
+
+            case BATCH_IN_ARRAY:
+                if (c == '{') {
+                    batch.state = BATCH_IN_ELEMENT;
+                    batch.depth = 1;
+                    batch.in_string = false;
+                    batch.escape = false;
+                    batch.overflow = false;
+                    batch.element[0] = c;
+                    batch.element_len = 1;
+                } else if (c == ']') {
+                    batch.state = BATCH_DONE;
+                } else if (c != ',' && !isJsonSpace(c)) {
+                    failBatch(batch, "Expected an array of objects");
+                }
+                break;
+
+            case BATCH_IN_ELEMENT:
+                if (batch.element_len < BATCH_ELEMENT_SIZE - 1) batch.element[batch.element_len++] = c;
+                else batch.overflow = true;
+
+                if (batch.in_string) {
+                    if (batch.escape) batch.escape = false;
+                    else if (c == '\\') batch.escape = true;
+                    else if (c == '"') batch.in_string = false;
+                } else if (c == '"') {
+                    batch.in_string = true;
+                } else if (c == '{' || c == '[') {
+                    if (++batch.depth > 16) failBatch(batch, "Nesting too deep");
+                } else if (c == '}' || c == ']') {
+                    if (--batch.depth == 0) {
+                        finishElement(batch);
+                        batch.state = BATCH_IN_ARRAY;
+                    }
+                }
+                break;
+
+            case BATCH_DONE:
+                if (!isJsonSpace(c)) failBatch(batch, "Unexpected data after the array");
+                break;
+        }
+    }
+}
+
+const char* batchFinish(TargetBatch& batch) {
+    if (batch.state == BATCH_EXPECT_ARRAY) failBatch(batch, "Expected a JSON array");
+    else if (batch.state == BATCH_IN_ARRAY || batch.state == BATCH_IN_ELEMENT) failBatch(batch, "Incomplete JSON array");
+
+    web_log_printf("Batch: %d operations, %d applied, %d failed%s%s", batch.operations, batch.applied, batch.failed,
+        batch.error ? " - " : "", batch.error ? batch.error : "");
+    return batch.error;
+}
+
+void buildBatchResultJson(const TargetBatch& batch, JsonObject root) {
+    root["success"] = batch.error == nullptr && batch.failed == 0;
+    root["applied"] = batch.applied;
+    root["failed"] = batch.failed;
+    JsonArray added = root.createNestedArray("added");
+    for (int i = 0; i < batch.added_count; i++) added.add(batch.added[i]);
+    JsonArray errors = root.createNestedArray("errors");
+    for (int i = 0; i < batch.error_count; i++) {
+        JsonObject error = errors.createNestedObject();
+        error["index"] = batch.errors[i].index;
+        error["error"] = batch.errors[i].message;
+    }
+    if (batch.error) root["error"] = batch.error;
+}
+
+// --- Export ---
+
+// Serializes into a window of the output: the first `skip` bytes are
+// dropped (already sent), the rest is copied while it fits. `seen` counts
+// everything, so the caller can tell whether the piece was cut off.
+struct WindowWriter {
+    uint8_t* out;
+    size_t size;
+    size_t skip;
+    size_t seen;
+    size_t written;
+
+    size_t write(uint8_t c) {
+        if (seen++ >= skip && written < size) out[written++] = c;
+        return 1;
+    }
+    size_t write(const uint8_t* s, size_t n) {
+        for (size_t i = 0; i < n; i++) write(s[i]);
+        return n;
+    }
+};
+
+// Same slots saveConfig() keeps
+static bool isExported(int i) {
+    return targets[i].enabled || strlen(targets[i].weburl) > 1;
+}
+
+// Field names of /api/server/update, so the export can be posted back.
+// Strings are passed as const char* so the document only stores pointers.
+static void writeTargetJson(int i, WindowWriter& writer) {
+    const TargetConfig& t = targets[i];
+    StaticJsonDocument<1024> doc;
+    doc["id"] = i;
+    doc["name"] = (const char*)t.server_name;
+    doc["group"] = (const char*)t.group_name;
+    doc["url"] = (const char*)t.weburl;
+    doc["enabled"] = t.enabled;
+    doc["check_interval"] = t.check_interval_seconds;
+    doc["retry_interval"] = t.retry_interval_seconds;
+    doc["max_check_interval"] = t.max_check_interval_seconds;
+    doc["failure_threshold"] = t.failure_threshold;
+    doc["recovery_threshold"] = t.recovery_threshold;
+    doc["parent"] = t.parent_id;
+    doc["latency_threshold"] = t.latency_threshold_ms;
+    doc["latency_deviations"] = t.latency_deviations;
+    doc["latency_slow_checks"] = t.latency_slow_checks;
+    doc["latency_recovery_checks"] = t.latency_recovery_checks;
+    doc["online_message"] = (const char*)t.online_message;
+    doc["offline_message"] = (const char*)t.offline_message;
+    doc["discord_webhook"] = (const char*)t.discord_webhook_url;
+    doc["ntfy_url"] = (const char*)t.ntfy_url;
+    doc["ntfy_priority"] = (const char*)t.ntfy_priority;
+    doc["telegram_bot_token"] = (const char*)t.telegram_bot_token;
+    doc["telegram_chat_id_1"] = (const char*)t.telegram_chat_id_1;
+    doc["telegram_chat_id_2"] = (const char*)t.telegram_chat_id_2;
+    doc["telegram_chat_id_3"] = (const char*)t.telegram_chat_id_3;
+    doc["http_get_url_on"] = (const char*)t.http_get_url_on;
+    doc["http_get_url_off"] = (const char*)t.http_get_url_off;
+    serializeJson(doc, writer);
+}
+
+void exportBegin(TargetExportCursor& cursor) {
+    cursor.target = -1;
+    cursor.emitted = 0;
+    cursor.offset = 0;
+    cursor.done = false;
+}
+
+size_t writeTargetExportChunk(TargetExportCursor& cursor, uint8_t* out, size_t maxLen) {
+    size_t written = 0;
+    while (!cursor.done && written < maxLen) {
+        int t = cursor.target;
+        if (t >= 0 && t < NUM_TARGETS && !isExported(t)) {
+            cursor.target++;
+            continue;
+        }
+
+        WindowWriter writer = {out + written, maxLen - written, cursor.offset, 0, 0};
+        if (t < 0) {
+            writer.write('[');
+        } else if (t >= NUM_TARGETS) {
+            writer.write(']');
+        } else {
+            if (cursor.emitted > 0) writer.write(',');
+            writeTargetJson(t, writer);
+        }
+        written += writer.written;
+
+        if (writer.seen > cursor.offset + writer.written) {
+            // Output buffer is full; resume inside this piece next time
+            cursor.offset += writer.written;
+            break;
+        }
+        cursor.offset = 0;
+        if (t >= NUM_TARGETS) {
+            cursor.done = true;
+        } else {
+            if (t >= 0) cursor.emitted++;
+            cursor.target++;
+        }
+    }
+    return written;
+}
@@ -0,0 +1,82 @@
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+#include <ArduinoJson.h>
+
+#include "monitor_config.h"
+
+// --- Bulk target import / export ---
+// POST /api/targets/batch takes a JSON array of operations:
+//   [{"op":"add","name":"API","url":"https://..."},
+//    {"op":"update","id":3,"check_interval":30},
+//    {"op":"delete","id":7}]
+// Without "op", an element with an "id" is an update and one without is an
+// add, so the output of GET /api/targets/export can be posted back as is.
+// Operations use the same fields as /api/server/add and /api/server/update.
+//
+// The body is scanned as it arrives: bytes of the current array element are
+// collected in a fixed buffer and the element is parsed and applied as soon as
+// it closes, so the request needs one element's worth of memory no matter how
+// many targets it carries, and TCP segment boundaries do not matter. Nothing
+// is persisted; the caller runs saveConfig() once at the end. There is no
+// rollback: operations before a malformed part of the array stay applied, and
+// the first element not processed is applied + failed.
+
+const size_t BATCH_ELEMENT_SIZE = 2048;  // Largest single operation (bytes of JSON)
+const int BATCH_MAX_ERRORS = 8;           // Per-operation errors kept for the response
+
+struct BatchError {
+    int16_t index;  // Position of the operation in the array
+    const char* message;
+};
+
+struct TargetBatch {
+    // Scanner
+    uint8_t state;
+    uint8_t depth;
+    bool in_string;
+    bool escape;
+    bool overflow;         // Current element did not fit and is being skipped
+    const char* error;     // Malformed stream; nothing after it was applied
+    size_t element_len;
+    char element[BATCH_ELEMENT_SIZE];
+
+    // Results
+    int16_t operations;
+    int16_t applied;
+    int16_t failed;
+    int16_t added_count;
+    int16_t added[NUM_TARGETS];  // Slot of each successful add, in order
+    int8_t error_count;
+    BatchError errors[BATCH_MAX_ERRORS];
+};
+
+void batchBegin(TargetBatch& batch);
+
+// Scan the next piece of the body, applying every operation that completes
+void batchFeed(TargetBatch& batch, const char* data, size_t len);
+
+// Call after the last chunk. Returns an error message if the stream was not
+// one complete JSON array, nullptr otherwise (individual operations may still
+// have failed; see failed / errors).
+const char* batchFinish(TargetBatch& batch);
+
+// {"success", "applied", "failed", "added": [slots], "errors": [{index, error}], "error"}
+void buildBatchResultJson(const TargetBatch& batch, JsonObject root);
+
+// Position in the export stream, kept per request by the chunk callback
+struct TargetExportCursor {
+    int16_t target;   // -1 = opening bracket, NUM_TARGETS = closing bracket
+    int16_t emitted;  // Elements written so far (for the separators)
+    uint16_t offset;  // Bytes of the current piece already sent
+    bool done;
+};
+
+void exportBegin(TargetExportCursor& cursor);
+
+// Stream every configured target as a batch-compatible JSON array. Each target
+// is serialized straight into the TCP buffer (re-rendered from the start when
+// it straddles two chunks), so no per-request buffer is needed. Returns 0 when
+// done.
+size_t writeTargetExportChunk(TargetExportCursor& cursor, uint8_t* out, size_t maxLen);
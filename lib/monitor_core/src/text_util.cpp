@@ -0,0 +1,37 @@
+#include "text_util.h"
+
+#include <ctype.h>
+#include <stdio.h>
+#include <string.h>
+
+void safeStrcpy(char* dest, const char* src, size_t size) {
+    strncpy(dest, src, size - 1);
+    dest[size - 1] = '\0';
+}
+
+void urlEncode(char* dst, const char* src, size_t dstSize) {
+    unsigned char c;
+    char hex_buf[4];
+    size_t written = 0;
+    while (*src && written + 4 < dstSize) {
+        c = (unsigned char)*src++;  // Unsigned, or UTF-8 bytes would print as %FFFFFFxx
+        if (isalnum(c) || c == '-' || c == '_' || c == '.' || c == '~') {
+            dst[written++] = c;
+        } else {
+            sprintf(hex_buf, "%%%02X", c);
+            dst[written++] = hex_buf[0];
+            dst[written++] = hex_buf[1];
+            dst[written++] = hex_buf[2];
+        }
+    }
+    dst[written] = '\0';
+}
+
+uint32_t hashString(const char* s) {
+    uint32_t hash = 2166136261UL;
+    for (; *s; s++) {
+        hash ^= (uint8_t)*s;
+        hash *= 16777619UL;
+    }
+    return hash;
+}
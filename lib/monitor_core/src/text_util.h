@@ -0,0 +1,13 @@
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+
+// Copy with truncation, always NUL-terminated
+void safeStrcpy(char* dest, const char* src, size_t size);
+
+// Percent-encode src into dst (RFC 3986 unreserved characters pass through)
+void urlEncode(char* dst, const char* src, size_t dstSize);
+
+// FNV-1a hash of a NUL-terminated string
+uint32_t hashString(const char* s);
@@ -0,0 +1,132 @@
+#include "uptime_stats.h"
+
+#include <math.h>
+#include <string.h>
+
+#include "monitor_hal.h"
+
+UptimeStats uptimeStats[NUM_TARGETS];
+unsigned long lastUptimeSave = 0;
+
+void resetUptimeStats(int index) {
+    memset(&uptimeStats[index], 0, sizeof(UptimeStats));
+}
+
+// Rotate hourly/daily buckets forward to the given epoch hour/day, dropping
+// whatever falls out of each window from the running sums.
+static void advanceUptimeBuckets(UptimeStats& s, uint32_t hour, uint32_t day) {
+    if (s.current_hour == 0) {
+        // First synced sample: adopt the current time without discarding counts
+        // that were recorded before NTP was available.
+        s.current_hour = hour;
+        s.current_day = day;
+        return;
+    }
+
+    if (hour > s.current_hour) {
+        if (hour - s.current_hour >= UPTIME_HOURLY_BUCKETS) {
+            memset(s.hourly_ok, 0, sizeof(s.hourly_ok));
+            memset(s.hourly_total, 0, sizeof(s.hourly_total));
+            s.sum_24h_ok = 0;
+            s.sum_24h_total = 0;
+        } else {
+            for (uint32_t h = s.current_hour + 1; h <= hour; h++) {
+                int slot = h % UPTIME_HOURLY_BUCKETS;
+                s.sum_24h_ok -= s.hourly_ok[slot];
+                s.sum_24h_total -= s.hourly_total[slot];
+                s.hourly_ok[slot] = 0;
+                s.hourly_total[slot] = 0;
+            }
+        }
+        s.current_hour = hour;
+    }
+
+    if (day > s.current_day) {
+        if (day - s.current_day >= UPTIME_DAILY_BUCKETS) {
+            memset(s.daily_ok, 0, sizeof(s.daily_ok));
+            memset(s.daily_total, 0, sizeof(s.daily_total));
+            s.sum_7d_ok = s.sum_7d_total = 0;
+            s.sum_30d_ok = s.sum_30d_total = 0;
+        } else {
+            for (uint32_t d = s.current_day + 1; d <= day; d++) {
+                // Day d-7 leaves the 7d window but stays in the 30d window
+                int slot7 = (d - 7) % UPTIME_DAILY_BUCKETS;
+                s.sum_7d_ok -= s.daily_ok[slot7];
+                s.sum_7d_total -= s.daily_total[slot7];
+
+                // Day d-30 leaves the 30d window; its slot is reused for day d
+                int slot = d % UPTIME_DAILY_BUCKETS;
+                s.sum_30d_ok -= s.daily_ok[slot];
+                s.sum_30d_total -= s.daily_total[slot];
+                s.daily_ok[slot] = 0;
+                s.daily_total[slot] = 0;
+            }
+        }
+        s.current_day = day;
+    }
+}
+
+void recordUptimeSample(int index, bool isOnline) {
+    UptimeStats& s = uptimeStats[index];
+    time_t now = time(nullptr);
+    if (now >= UPTIME_MIN_VALID_EPOCH) {
+        advanceUptimeBuckets(s, now / 3600, now / 86400);
+    }
+
+    int hourSlot = s.current_hour % UPTIME_HOURLY_BUCKETS;
+    int daySlot = s.current_day % UPTIME_DAILY_BUCKETS;
+    uint32_t ok = isOnline ? 1 : 0;
+
+    if (s.hourly_total[hourSlot] < UINT16_MAX) {
+        s.hourly_ok[hourSlot] += ok;
+        s.hourly_total[hourSlot]++;
+        s.sum_24h_ok += ok;
+        s.sum_24h_total++;
+    }
+    s.daily_ok[daySlot] += ok;
+    s.daily_total[daySlot]++;
+    s.sum_7d_ok += ok;
+    s.sum_7d_total++;
+    s.sum_30d_ok += ok;
+    s.sum_30d_total++;
+}
+
+void setUptimePercent(JsonObject obj, const char* key, uint32_t ok, uint32_t total) {
+    if (total == 0) {
+        obj[key] = nullptr;
+        return;
+    }
+    obj[key] = roundf(ok * 100000.0f / total) / 1000.0f;
+}
+
+void loadUptimeStats() {
+    HalFile* file = hal_fs_open("/uptime.bin", "r");
+    if (!file) return;
+
+    uint32_t header[3] = {0};
+    bool valid = hal_fs_read(file, header, sizeof(header)) == sizeof(header) &&
+                 header[0] == UPTIME_FILE_MAGIC &&
+                 header[1] == NUM_TARGETS &&
+                 header[2] == sizeof(UptimeStats) &&
+                 hal_fs_read(file, uptimeStats, sizeof(uptimeStats)) == sizeof(uptimeStats);
+    hal_fs_close(file);
+
+    if (!valid) {
+        hal_console_write("Uptime stats file invalid, starting fresh\n");
+        memset(uptimeStats, 0, sizeof(uptimeStats));
+    } else {
+        hal_console_write("Uptime stats restored\n");
+    }
+}
+
+void saveUptimeStats() {
+    HalFile* file = hal_fs_open("/uptime.bin", "w");
+    if (!file) {
+        hal_console_write("Failed to open uptime stats for writing\n");
+        return;
+    }
+    uint32_t header[3] = {UPTIME_FILE_MAGIC, (uint32_t)NUM_TARGETS, (uint32_t)sizeof(UptimeStats)};
+    hal_fs_write(file, header, sizeof(header));
+    hal_fs_write(file, uptimeStats, sizeof(uptimeStats));
+    hal_fs_close(file);
+}
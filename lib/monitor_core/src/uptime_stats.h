@@ -0,0 +1,44 @@
+#pragma once
+
+#include <stdint.h>
+#include <time.h>
+#include <ArduinoJson.h>
+
+#include "monitor_config.h"
+
+// --- Rolling uptime statistics (24h / 7d / 30d) ---
+// Success/total counters are kept in hourly buckets (24h window) and daily
+// buckets (7d and 30d windows). Window sums are maintained incrementally so
+// recording a check and reading a percentage are both O(1).
+const int UPTIME_HOURLY_BUCKETS = 24;
+const int UPTIME_DAILY_BUCKETS = 30;
+const uint32_t UPTIME_FILE_MAGIC = 0x55505431;  // "UPT1"
+const unsigned long UPTIME_SAVE_INTERVAL = 900000;  // Persist every 15 minutes
+const time_t UPTIME_MIN_VALID_EPOCH = 1600000000;  // Before this, NTP has not synced yet
+
+struct UptimeStats {
+    uint32_t current_hour;  // Epoch hour of the newest hourly bucket (0 = never synced)
+    uint32_t current_day;   // Epoch day of the newest daily bucket
+    uint16_t hourly_ok[UPTIME_HOURLY_BUCKETS];
+    uint16_t hourly_total[UPTIME_HOURLY_BUCKETS];
+    uint32_t daily_ok[UPTIME_DAILY_BUCKETS];
+    uint32_t daily_total[UPTIME_DAILY_BUCKETS];
+    uint32_t sum_24h_ok, sum_24h_total;
+    uint32_t sum_7d_ok, sum_7d_total;
+    uint32_t sum_30d_ok, sum_30d_total;
+};
+
+extern UptimeStats uptimeStats[NUM_TARGETS];
+extern unsigned long lastUptimeSave;
+
+void resetUptimeStats(int index);
+
+// Called from the check result path. Amortized O(1).
+void recordUptimeSample(int index, bool isOnline);
+
+// Store an uptime percentage (3 decimals) in the JSON object, or null when
+// the window holds no samples yet.
+void setUptimePercent(JsonObject obj, const char* key, uint32_t ok, uint32_t total);
+
+void loadUptimeStats();
+void saveUptimeStats();
@@ -0,0 +1,171 @@
+#include "web_log.h"
+
+#include <atomic>
+#include <stdarg.h>
+#include <stdio.h>
+#include <string.h>
+
+#include "monitor_hal.h"
+#include "uptime_stats.h"
+
+char serialLogBuffer[SERIAL_LOG_SIZE];
+int serialLogBufferPos = 0;
+
+static volatile long utcOffsetSec = 0;
+
+// Bounded multi-producer queue. A slot is free for the producer of position
+// pos when its sequence is 2 * lap (lap = pos / WEB_LOG_QUEUE_DEPTH), holds a
+// line when it is 2 * lap + 1, and is handed back for the next lap by the
+// consumer.
+struct LogRecord {
+    std::atomic<uint32_t> sequence;
+    uint32_t logged_at;  // hal_millis()
+    char text[WEB_LOG_MESSAGE_SIZE];
+};
+
+static LogRecord records[WEB_LOG_QUEUE_DEPTH];
+static std::atomic<uint32_t> enqueuePos(0);
+static uint32_t dequeuePos = 0;  // Only while holding flushing
+static std::atomic_flag flushing = ATOMIC_FLAG_INIT;
+static std::atomic<uint32_t> dropped(0);
+
+static uint32_t slotLap(uint32_t pos) {
+    return 2 * (pos / WEB_LOG_QUEUE_DEPTH);
+}
+
+// Local wall-clock second of a hal_millis() time; false while the clock is unknown
+static bool localTimeAt(uint32_t at, time_t* local) {
+    time_t now = time(nullptr);
+    if (now < UPTIME_MIN_VALID_EPOCH) return false;
+    *local = now - (time_t)((hal_millis() - at) / 1000) + utcOffsetSec;
+    return true;
+}
+
+static void formatLocalTime(time_t local, char* buffer, size_t bufferSize) {
+    struct tm timeinfo;
+    gmtime_r(&local, &timeinfo);
+    strftime(buffer, bufferSize, "%Y-%m-%d %H:%M:%S", &timeinfo);
+}
+
+void getFormattedTime(char* buffer, size_t bufferSize) {
+    time_t local;
+    if (localTimeAt(hal_millis(), &local)) {
+        formatLocalTime(local, buffer, bufferSize);
+        return;
+    }
+    strncpy(buffer, "Time not set", bufferSize -1);
+    buffer[bufferSize -1] = '\0';
+}
+
+void webLogSetUtcOffset(long seconds) {
+    utcOffsetSec = seconds;
+}
+
+void console_printf(const char *format, ...) {
+    char buf[256];
+    va_list args;
+    va_start(args, format);
+    vsnprintf(buf, sizeof(buf), format, args);
+    va_end(args);
+    hal_console_write(buf);
+}
+
+// Only called while holding flushing
+static void writeLine(uint32_t loggedAt, const char* text) {
+    // Lines of the same second reuse the previous line's text
+    static time_t stampSecond = 0;
+    static char stamp[24];
+    char uptimeBuf[24];
+    const char* timeBuf = stamp;
+    time_t local;
+    if (!localTimeAt(loggedAt, &local)) {
+        // Uptime until the clock is set
+        snprintf(uptimeBuf, sizeof(uptimeBuf), "+%lu.%03lus", (unsigned long)(loggedAt / 1000), (unsigned long)(loggedAt % 1000));
+        timeBuf = uptimeBuf;
+    } else if (local != stampSecond) {
+        formatLocalTime(local, stamp, sizeof(stamp));
+        stampSecond = local;
+    }
+
+    char lineBuf[WEB_LOG_MESSAGE_SIZE + 40];
+    int len = snprintf(lineBuf, sizeof(lineBuf), "[%s] %s\n", timeBuf, text);
+    if (len >= (int)sizeof(lineBuf)) len = sizeof(lineBuf) - 1;
+    hal_console_write(lineBuf);
+
+    if (serialLogBufferPos + len >= SERIAL_LOG_SIZE) {
+        serialLogBufferPos = 0;
+    }
+    memcpy(serialLogBuffer + serialLogBufferPos, lineBuf, len + 1);
+    serialLogBufferPos += len;
+}
+
+// Drain the queue unless another task is already doing it; returns whether
+// this call drained it
+static bool drain() {
+    if (flushing.test_and_set(std::memory_order_acquire)) return false;
+    for (;;) {
+        LogRecord& record = records[dequeuePos % WEB_LOG_QUEUE_DEPTH];
+        uint32_t lap = slotLap(dequeuePos);
+        if (record.sequence.load(std::memory_order_acquire) != lap + 1) break;
+        writeLine(record.logged_at, record.text);
+        record.sequence.store(lap + 2, std::memory_order_release);
+        dequeuePos++;
+    }
+    uint32_t lost = dropped.exchange(0);
+    if (lost) {
+        char note[48];
+        snprintf(note, sizeof(note), "%lu log lines dropped (queue full)", (unsigned long)lost);
+        writeLine(hal_millis(), note);
+    }
+    flushing.clear(std::memory_order_release);
+    return true;
+}
+
+void webLogFlush() {
+    drain();
+}
+
+void web_log_printf(const char *format, ...) {
+    uint32_t loggedAt = hal_millis();
+    bool flushed = false;
+    for (;;) {
+        uint32_t pos = enqueuePos.load(std::memory_order_relaxed);
+        LogRecord& record = records[pos % WEB_LOG_QUEUE_DEPTH];
+        uint32_t lap = slotLap(pos);
+        int32_t state = (int32_t)(record.sequence.load(std::memory_order_acquire) - lap);
+        if (state > 0) continue;  // Another task took pos meanwhile
+        if (state < 0) {
+            // Full: make room once, else give up rather than wait
+            if (!flushed && drain()) {
+                flushed = true;
+                continue;
+            }
+            dropped++;
+            return;
+        }
+        if (!enqueuePos.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) continue;
+
+        record.logged_at = loggedAt;
+        va_list args;
+        va_start(args, format);
+        vsnprintf(record.text, sizeof(record.text), format, args);
+        va_end(args);
+        record.sequence.store(lap + 1, std::memory_order_release);
+        return;
+    }
+}
+
+void prependToLog(char* logBuffer, const char* newEntry, size_t bufferSize) {
+    size_t entryLen = strlen(newEntry);
+    if (entryLen >= bufferSize) return;
+
+    size_t currentLen = strlen(logBuffer);
+    
+    if (currentLen + entryLen >= bufferSize) {
+        currentLen = bufferSize - entryLen - 1;
+    }
+
+    memmove(logBuffer + entryLen, logBuffer, currentLen);
+    memcpy(logBuffer, newEntry, entryLen);
+    logBuffer[currentLen + entryLen] = '\0';
+}
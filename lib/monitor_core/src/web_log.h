@@ -0,0 +1,40 @@
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+
+// --- Buffers for logs to prevent memory fragmentation ---
+const int SERIAL_LOG_SIZE = 2048;
+extern char serialLogBuffer[SERIAL_LOG_SIZE];
+extern int serialLogBufferPos;
+
+// --- Log pipeline ---
+// web_log_printf() only formats the message into a queue slot together with
+// its hal_millis() time; it never waits for the clock or the UART, and any
+// task may call it. webLogFlush() (monitorLoop(), GET /api/logs) turns the
+// times into wall-clock text with the cached UTC offset, writes the console
+// and fills serialLogBuffer. Lines logged before NTP synced get their real
+// time if it is known by the time they are flushed. When the queue is full
+// the logging task flushes it itself; if another task is flushing, the line
+// is dropped and counted.
+const int WEB_LOG_QUEUE_DEPTH = 16;
+const size_t WEB_LOG_MESSAGE_SIZE = 240;
+
+// Current local time "YYYY-MM-DD HH:MM:SS", or "Time not set" before NTP
+// has synced. Does not wait for the clock.
+void getFormattedTime(char* buffer, size_t bufferSize);
+
+// UTC offset for log and message timestamps (seconds, as hal_configure_time())
+void webLogSetUtcOffset(long seconds);
+
+// printf-style output to the console only (boot diagnostics)
+void console_printf(const char *format, ...);
+
+// printf-style logging to the console and the /api/logs ring buffer
+void web_log_printf(const char *format, ...);
+
+// Write queued lines to the console and serialLogBuffer
+void webLogFlush();
+
+// Insert newEntry at the front of logBuffer, dropping the oldest text if full
+void prependToLog(char* logBuffer, const char* newEntry, size_t bufferSize);
@@ -0,0 +1,46 @@
+#!/usr/bin/env python3
+"""Compare two result files written by scripts/run_benchmarks.sh.
+
+Prints time, allocations and bytes per operation for each benchmark and
+slot count, with the relative change from BASE to NEW.
+"""
+import json
+import sys
+
+
+def load(path):
+    with open(path) as f:
+        runs = json.load(f)
+    if isinstance(runs, dict):
+        runs = [runs]
+    results = {}
+    for run in runs:
+        for bench in run["benchmarks"]:
+            results[(bench["name"], run["num_targets"])] = bench
+    return results
+
+
+def delta(old, new):
+    if old == 0:
+        return "" if new == 0 else "new"
+    return "%+.1f%%" % ((new - old) * 100.0 / old)
+
+
+def main():
+    if len(sys.argv) != 3:
+        sys.exit("usage: compare_benchmarks.py BASE.json NEW.json")
+    base, new = load(sys.argv[1]), load(sys.argv[2])
+
+    print("%-18s %7s %12s %9s %10s %9s %12s %9s" % (
+        "benchmark", "targets", "ns/op", "", "allocs/op", "", "B/op", ""))
+    for key in sorted(set(base) & set(new), key=lambda k: (k[0], k[1])):
+        b, n = base[key], new[key]
+        print("%-18s %7d %12.0f %9s %10.1f %9s %12.0f %9s" % (
+            key[0], key[1],
+            n["ns_per_op"], delta(b["ns_per_op"], n["ns_per_op"]),
+            n["allocs_per_op"], delta(b["allocs_per_op"], n["allocs_per_op"]),
+            n["bytes_per_op"], delta(b["bytes_per_op"], n["bytes_per_op"])))
+
+
+if __name__ == "__main__":
+    main()
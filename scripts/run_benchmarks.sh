@@ -0,0 +1,36 @@
+#!/bin/sh
+# Build and run the host microbenchmarks at 20, 100 and 500 targets.
+# Results go to bench-results/<label>.json (label defaults to the git revision).
+#
+#   scripts/run_benchmarks.sh [label]
+#   scripts/compare_benchmarks.py bench-results/base.json bench-results/new.json
+set -e
+
+cd "$(dirname "$0")/.."
+LABEL="${1:-$(git rev-parse --short HEAD 2>/dev/null || echo local)}"
+MIN_TIME_MS="${MIN_TIME_MS:-500}"
+OUT_DIR=bench-results
+mkdir -p "$OUT_DIR"
+
+PARTS=""
+for ENV in native_bench native_bench_100 native_bench_500; do
+    pio run -s -e "$ENV"
+    PART="$OUT_DIR/.$LABEL.$ENV.json"
+    ".pio/build/$ENV/program" --label "$LABEL" --min-time-ms "$MIN_TIME_MS" --output "$PART"
+    PARTS="$PARTS $PART"
+done
+
+# One JSON array with a result set per slot count
+{
+    printf '['
+    SEP=""
+    for PART in $PARTS; do
+        printf '%s' "$SEP"
+        cat "$PART"
+        SEP=","
+    done
+    printf ']\n'
+} > "$OUT_DIR/$LABEL.json"
+rm -f $PARTS
+
+echo "Wrote $OUT_DIR/$LABEL.json"
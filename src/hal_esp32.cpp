@@ -0,0 +1,273 @@
+// ESP32 implementation of the platform abstraction layer (lib/monitor_core/src/monitor_hal.h)
+
+#include <Arduino.h>
+#include <WiFi.h>
+#include <WiFiUdp.h>
+#include <HTTPClient.h>
+#include <Update.h>
+#include <EEPROM.h>
+#include <LittleFS.h>
+
+#include "diagnostics.h"
+#include "monitor_hal.h"
+
+const int EEPROM_SIZE = 4095;
+const int CONFIG_VERSION_ADDRESS = 4090;
+
+// --- Clock ---
+
+uint32_t hal_millis() {
+    return millis();
+}
+
+void hal_delay(uint32_t ms) {
+    delay(ms);
+}
+
+void hal_configure_time(long gmtOffsetSec, const char* ntpServer) {
+    configTime(gmtOffsetSec, 0, ntpServer);
+}
+
+bool hal_local_time(struct tm* timeinfo) {
+    return getLocalTime(timeinfo, 0);  // The default waits up to 5 s for NTP
+}
+
+uint32_t hal_cycle_count() {
+    return ESP.getCycleCount();
+}
+
+uint32_t hal_cycles_per_us() {
+    return ESP.getCpuFreqMHz();
+}
+
+uint32_t hal_random() {
+    return esp_random();
+}
+
+// --- Console ---
+
+void hal_console_write(const char* text) {
+    Serial.print(text);
+}
+
+// --- Network ---
+
+bool hal_network_connected() {
+    return WiFi.status() == WL_CONNECTED;
+}
+
+void hal_network_reconnect() {
+    WiFi.reconnect();
+}
+
+int hal_network_rssi() {
+    return WiFi.RSSI();
+}
+
+void hal_network_ssid(char* buf, size_t size) {
+    strlcpy(buf, WiFi.SSID().c_str(), size);
+}
+
+// --- Memory ---
+
+void hal_heap_stats(HalHeapStats* stats) {
+    stats->free_bytes = ESP.getFreeHeap();
+    stats->min_free_bytes = ESP.getMinFreeHeap();
+    stats->max_alloc_bytes = ESP.getMaxAllocHeap();
+}
+
+uint32_t hal_stack_min_free_bytes() {
+    return uxTaskGetStackHighWaterMark(NULL);  // Bytes on ESP-IDF
+}
+
+// --- HTTP client ---
+
+int hal_http_request(const HalHttpRequest& request) {
+    HTTPClient http;
+    http.setTimeout(request.timeout_ms);
+    if (request.follow_redirects) http.setFollowRedirects(HTTPC_STRICT_FOLLOW_REDIRECTS);
+    http.begin(request.url);
+    if (request.content_type) http.addHeader("Content-Type", request.content_type);
+    if (request.header_name) http.addHeader(request.header_name, request.header_value);
+    if (request.retry_after_ms) {
+        static const char* RATE_HEADERS[] = {"Retry-After", "X-RateLimit-Remaining", "X-RateLimit-Reset-After"};
+        http.collectHeaders(RATE_HEADERS, 3);
+    }
+
+    int code;
+    if (strcmp(request.method, "GET") == 0) {
+        code = http.GET();
+    } else {
+        code = http.sendRequest(request.method, (uint8_t*)request.body, request.body_len);
+    }
+    heapScopeSample();  // Connection (and TLS session) still allocated here
+    if (request.retry_after_ms) {
+        // Seconds, possibly fractional; the HTTP-date form is not used by the notification services
+        double seconds = 0;
+        if (http.hasHeader("Retry-After")) {
+            seconds = atof(http.header("Retry-After").c_str());
+        } else if (http.hasHeader("X-RateLimit-Remaining") && http.header("X-RateLimit-Remaining") == "0") {
+            seconds = atof(http.header("X-RateLimit-Reset-After").c_str());
+        }
+        if (seconds > 86400) seconds = 86400;
+        *request.retry_after_ms = seconds > 0 ? (uint32_t)(seconds * 1000) : 0;
+    }
+    http.end();
+    return code;
+}
+
+// --- Streaming download ---
+
+struct HalDownload {
+    HTTPClient http;
+    WiFiClient* stream;
+    int32_t remaining;  // -1 = until the server closes the connection
+};
+
+HalDownload* hal_download_open(const char* url, uint32_t timeout_ms, int* status, int32_t* length) {
+    HalDownload* download = new HalDownload();
+    download->http.setTimeout(timeout_ms);
+    download->http.useHTTP10(true);  // No chunked encoding: the stream is the body itself
+    download->http.setFollowRedirects(HTTPC_STRICT_FOLLOW_REDIRECTS);
+    download->http.begin(url);
+    *status = download->http.GET();
+    if (*status != 200) {
+        download->http.end();
+        delete download;
+        return nullptr;
+    }
+    *length = download->http.getSize();
+    download->remaining = *length;
+    download->stream = download->http.getStreamPtr();
+    return download;
+}
+
+int hal_download_read(HalDownload* download, uint8_t* buf, size_t size) {
+    if (download->remaining == 0) return -1;
+    size_t available = download->stream->available();
+    if (available == 0) return download->http.connected() ? 0 : -1;
+    if (size > available) size = available;
+    if (download->remaining > 0 && size > (size_t)download->remaining) size = download->remaining;
+    int n = download->stream->readBytes(buf, size);
+    if (download->remaining > 0) download->remaining -= n;
+    return n;
+}
+
+void hal_download_close(HalDownload* download) {
+    download->http.end();
+    delete download;
+}
+
+// --- Firmware update ---
+
+bool hal_update_begin(uint32_t size) {
+    return Update.begin(size ? size : UPDATE_SIZE_UNKNOWN);
+}
+
+bool hal_update_write(const uint8_t* data, size_t len) {
+    return Update.write((uint8_t*)data, len) == len;
+}
+
+bool hal_update_end() {
+    if (Update.end(true)) return true;
+    Update.printError(Serial);
+    return false;
+}
+
+void hal_update_abort() {
+    Update.abort();
+}
+
+void hal_restart() {
+    ESP.restart();
+}
+
+// --- UDP ---
+
+static WiFiUDP udp;
+static bool udpOpen = false;
+
+bool hal_udp_begin(uint16_t port) {
+    if (udpOpen) udp.stop();
+    udpOpen = udp.begin(port);
+    return udpOpen;
+}
+
+void hal_udp_end() {
+    if (udpOpen) udp.stop();
+    udpOpen = false;
+}
+
+bool hal_udp_send(const char* host, uint16_t port, const uint8_t* data, size_t len) {
+    if (!udpOpen || !udp.beginPacket(host, port)) return false;
+    udp.write(data, len);
+    return udp.endPacket();
+}
+
+bool hal_resolve_ipv4(const char* host, char* ip, size_t size) {
+    IPAddress address;
+    if (!WiFi.hostByName(host, address)) return false;
+    snprintf(ip, size, "%s", address.toString().c_str());
+    return true;
+}
+
+size_t hal_udp_receive(uint8_t* buf, size_t size, char* from, size_t fromSize) {
+    if (!udpOpen || udp.parsePacket() <= 0) return 0;
+    int n = udp.read(buf, size);  // The rest of a longer datagram is dropped by the next parsePacket()
+    snprintf(from, fromSize, "%s:%u", udp.remoteIP().toString().c_str(), udp.remotePort());
+    return n > 0 ? n : 0;
+}
+
+// --- Filesystem ---
+
+struct HalFile {
+    File file;
+};
+
+HalFile* hal_fs_open(const char* path, const char* mode) {
+    File file = LittleFS.open(path, mode);
+    if (!file) return nullptr;
+    return new HalFile{file};
+}
+
+size_t hal_fs_read(HalFile* file, void* buf, size_t len) {
+    return file->file.read((uint8_t*)buf, len);
+}
+
+size_t hal_fs_write(HalFile* file, const void* buf, size_t len) {
+    return file->file.write((const uint8_t*)buf, len);
+}
+
+size_t hal_fs_size(HalFile* file) {
+    return file->file.size();
+}
+
+void hal_fs_close(HalFile* file) {
+    file->file.close();
+    delete file;
+}
+
+bool hal_fs_exists(const char* path) {
+    return LittleFS.exists(path);
+}
+
+bool hal_fs_remove(const char* path) {
+    return LittleFS.remove(path);
+}
+
+// --- Persistent config version ---
+
+int hal_stored_config_version() {
+    EEPROM.begin(EEPROM_SIZE);
+    int storedVersion = 0;
+    EEPROM.get(CONFIG_VERSION_ADDRESS, storedVersion);
+    EEPROM.end();
+    return storedVersion;
+}
+
+void hal_store_config_version(int version) {
+    EEPROM.begin(EEPROM_SIZE);
+    EEPROM.put(CONFIG_VERSION_ADDRESS, version);
+    EEPROM.commit();
+    EEPROM.end();
+}
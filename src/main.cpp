@@ -1,11 +1,8 @@
 #include <Arduino.h>
 #include <WiFi.h>
 #include <WiFiManager.h>
-#include <HTTPClient.h>
-#include <EEPROM.h>
 #include <Update.h>
 #include <ArduinoJson.h>
-#include <stdarg.h>
 #include <LittleFS.h>
 #include <ESPmDNS.h>
 #include <esp_wifi.h>
@@ -14,72 +11,37 @@
 #include <ESPAsyncWebServer.h>
 #include <AsyncJson.h>
 
-// --- Configuration Version ---
-const int CONFIG_VERSION = 13;  // Incremented for breaking changes
-const int NUM_TARGETS = 20;  // Increased from 3 to 20
-const int EEPROM_SIZE = 4095;
-const int CONFIG_VERSION_ADDRESS = 4090;
-
-// --- Data Structure for a single target ---
-struct TargetConfig {
-    char server_name[32];
-    char group_name[32];  // NEW: Group/tab name for organization
-    char weburl[128];
-    char discord_webhook_url[128];
-    char ntfy_url[64];
-    char ntfy_priority[16];
-    char telegram_bot_token[50];
-    char telegram_chat_id_1[16];
-    char telegram_chat_id_2[16];
-    char telegram_chat_id_3[16];
-    char http_get_url_on[128];
-    char http_get_url_off[128];
-    char online_message[128];
-    char offline_message[128];
-    uint16_t check_interval_seconds;
-    uint8_t failure_threshold;
-    uint8_t recovery_threshold;
-    bool enabled;  // NEW: Whether this server is active
-};
-
-// --- Global variables for operation ---
-int gmt_offset = 1; // Default GMT offset
-TargetConfig targets[NUM_TARGETS];
+// Platform-independent monitoring core (lib/monitor_core)
+#include "monitor_hal.h"
+#include "alert_queue.h"
+#include "api_encoding.h"
+#include "config_migration.h"
+#include "diagnostics.h"
+#include "federation.h"
+#include "latency.h"
+#include "metrics.h"
+#include "metrics_push.h"
+#include "monitor_config.h"
+#include "monitor_state.h"
+#include "ota_pull.h"
+#include "scheduler.h"
+#include "status_api.h"
+#include "status_snapshot.h"
+#include "target_bulk.h"
+#include "text_util.h"
+#include "uptime_stats.h"
+#include "web_log.h"
 
 // --- WiFiManager flag ---
 bool shouldSaveConfig = false;
 
-// --- Runtime state variables ---
-long gmtOffset_sec;
-const char* ntpServer = "pool.ntp.org";
-int httpCode[NUM_TARGETS] = {0};
-unsigned long pingTime[NUM_TARGETS] = {0};
-unsigned long minpingTime[NUM_TARGETS] = {0};
-unsigned long maxpingTime[NUM_TARGETS] = {0};
-unsigned long last_check_time[NUM_TARGETS] = {0};
-uint8_t failure_count[NUM_TARGETS] = {0};
-uint8_t success_count[NUM_TARGETS] = {0};
-bool confirmed_online_state[NUM_TARGETS] = {true};
-int current_check_index = 0;  // Track which server to check next (time-distributed checks)
-
-// --- Buffers for logs to prevent memory fragmentation ---
-const int TARGET_LOG_SIZE = 1024;
-const int SERIAL_LOG_SIZE = 2048;
-char targetLogMessages[NUM_TARGETS][TARGET_LOG_SIZE];
-char serialLogBuffer[SERIAL_LOG_SIZE];
-int serialLogBufferPos = 0;
-
-// --- WiFi Reconnection Timer ---
-unsigned long lastWifiReconnectAttempt = 0;
-const long wifiReconnectInterval = 10000; // Try to reconnect every 10 seconds
-
 // AsyncWebServer - initialize after WiFiManager to avoid port 80 conflict
 AsyncWebServer* server = nullptr;
 
 // --- HTML for the Firmware Update Page ---
 const char UPDATE_HTML[] PROGMEM = R"rawliteral(
-<form method='POST' action='/updatefirmware' enctype='multipart/form-data' id='upload_form'><h2>Firmware Update</h2><p>Upload the new .bin file here. <strong>Warning:</strong> After the update, all settings will be reset to their default values.</p><input type='file' name='update' id='file' onchange='sub(this)' style='display:none'><label id='file-input' for='file'>Choose File...</label><input type='submit' class='btn' value='Start Update'><br><br><div id='prg'>Progress: 0%</div><br><div id='prgbar'><div id='bar'></div></div></form><script>function sub(obj){var fileName=obj.value.split('\\').pop();document.getElementById('file-input').innerHTML=fileName}
-document.getElementById('upload_form').onsubmit=function(e){e.preventDefault();var form=document.getElementById('upload_form');var data=new FormData(form);var xhr=new XMLHttpRequest();xhr.open('POST','/updatefirmware',true);xhr.upload.onprogress=function(evt){if(evt.lengthComputable){var per=Math.round((evt.loaded/evt.total)*100);document.getElementById('prg').innerHTML='Progress: '+per+'%';document.getElementById('bar').style.width=per+'%'}};xhr.onload=function(){if(xhr.status===200){alert('Update successful! The device will restart with default settings.')}else{alert('Update failed! Status: '+xhr.status)}};xhr.send(data)};</script><style>body{background:#121212;font-family:sans-serif;font-size:14px;color:#e0e0e0}form{background:#1e1e1e;max-width:300px;margin:75px auto;padding:30px;border-radius:8px;text-align:center;border:1px solid #333}#file-input,.btn{width:100%;height:44px;border-radius:4px;margin:10px auto;font-size:15px}.btn{background:#3498db;color:#fff;cursor:pointer;border:0;padding:0 15px}.btn:hover{background-color:#2980b9}#file-input{padding:0;border:1px solid #333;line-height:44px;text-align:left;display:block;cursor:pointer;padding-left:10px}#prgbar{background-color:#333;border-radius:10px}#bar{background-color:#3498db;width:0%;height:10px;border-radius:10px}</style>
+<form method='POST' action='/updatefirmware' enctype='multipart/form-data' id='upload_form'><h2>Firmware Update</h2><p>Upload the new .bin file here. Settings are kept: the new firmware migrates the stored configuration on its first boot.</p><input type='file' name='update' id='file' onchange='sub(this)' style='display:none'><label id='file-input' for='file'>Choose File...</label><input type='submit' class='btn' value='Start Update'><br><br><div id='prg'>Progress: 0%</div><br><div id='prgbar'><div id='bar'></div></div></form><script>function sub(obj){var fileName=obj.value.split('\\').pop();document.getElementById('file-input').innerHTML=fileName}
+document.getElementById('upload_form').onsubmit=function(e){e.preventDefault();var form=document.getElementById('upload_form');var data=new FormData(form);var xhr=new XMLHttpRequest();xhr.open('POST','/updatefirmware',true);xhr.upload.onprogress=function(evt){if(evt.lengthComputable){var per=Math.round((evt.loaded/evt.total)*100);document.getElementById('prg').innerHTML='Progress: '+per+'%';document.getElementById('bar').style.width=per+'%'}};xhr.onload=function(){if(xhr.status===200){alert('Update successful! The device will restart and keep its settings.')}else{alert('Update failed! Status: '+xhr.status)}};xhr.send(data)};</script><style>body{background:#121212;font-family:sans-serif;font-size:14px;color:#e0e0e0}form{background:#1e1e1e;max-width:300px;margin:75px auto;padding:30px;border-radius:8px;text-align:center;border:1px solid #333}#file-input,.btn{width:100%;height:44px;border-radius:4px;margin:10px auto;font-size:15px}.btn{background:#3498db;color:#fff;cursor:pointer;border:0;padding:0 15px}.btn:hover{background-color:#2980b9}#file-input{padding:0;border:1px solid #333;line-height:44px;text-align:left;display:block;cursor:pointer;padding-left:10px}#prgbar{background-color:#333;border-radius:10px}#bar{background-color:#3498db;width:0%;height:10px;border-radius:10px}</style>
 )rawliteral";
 
 
@@ -112,6 +74,7 @@ const char INDEX_HTML[] PROGMEM = R"rawliteral(
         .status-indicator { width: 12px; height: 12px; border-radius: 50%; margin-right: 8px; background-color: #7f8c8d; transition: background-color 0.3s; display: inline-block; }
         .status-indicator.online { background-color: var(--color-green); }
         .status-indicator.offline { background-color: var(--color-red); }
+        .status-indicator.degraded { background-color: var(--color-orange); }
         .card { background: var(--card-bg); padding: 20px; border-radius: var(--border-radius); border: 1px solid var(--border-color); margin-top: 20px; }
         button, .button-link, .btn { background: var(--color-blue); color: white !important; border: none; padding: 10px 15px; border-radius: 5px; cursor: pointer; transition: background-color 0.2s; font-size: 0.95em; text-decoration: none; display: inline-block; text-align: center; }
         button:hover, .button-link:hover, .btn:hover { background-color: #2980b9; }
@@ -164,6 +127,8 @@ const char INDEX_HTML[] PROGMEM = R"rawliteral(
         .status-on::before { border-color: var(--color-green); }
         .status-off { border-left: 4px solid var(--color-red); }
         .status-off::before { border-color: var(--color-red); }
+        .status-degraded { border-left: 4px solid var(--color-orange); }
+        .status-degraded::before { border-color: var(--color-orange); }
         .timeline-event time { display: block; font-size: 0.8em; color: #999; margin-bottom: 5px; }
         .timeline-event p { margin: 0; }
 
@@ -205,6 +170,8 @@ const char INDEX_HTML[] PROGMEM = R"rawliteral(
         <div class="modal-body">
             <div class="form-group"><label for="ssid_input">WiFi SSID (Read-only)</label><input type="text" id="ssid_input" disabled></div>
             <div class="form-group"><label for="gmt_offset_input">UTC Offset (hours)</label><input type="number" id="gmt_offset_input" min="-12" max="14"></div>
+            <div class="form-group"><label for="coalesce_window_input">Shared Probe Window (seconds)</label><input type="number" id="coalesce_window_input" min="0" max="300"></div>
+            <p class="description">Servers with the same URL that are due within this window share one request. 0 probes each separately.</p>
             <p class="description">Note: WiFi credentials are managed via the WiFiManager portal. To change WiFi, reset the device.</p>
         </div>
         <div class="modal-footer">
@@ -240,10 +207,23 @@ const char INDEX_HTML[] PROGMEM = R"rawliteral(
                     <div class="form-group"><label for="failure_threshold">Failures for Alert</label><input type="number" id="failure_threshold" value="3" min="1"></div>
                     <div class="form-group"><label for="recovery_threshold">Successes for Recovery</label><input type="number" id="recovery_threshold" value="2" min="1"></div>
                 </div>
+                <div class="form-row">
+                    <div class="form-group"><label for="retry_interval">Retry Interval While Failing (seconds)</label><input type="number" id="retry_interval" value="5" min="0"></div>
+                    <div class="form-group"><label for="max_check_interval">Max Interval When Stable (seconds)</label><input type="number" id="max_check_interval" value="60" min="5"></div>
+                    <div class="form-group"><label for="parent_id">Depends On (server ID, -1 = none)</label><input type="number" id="parent_id" value="-1" min="-1"></div>
+                </div>
+                <div class="form-row">
+                    <div class="form-group"><label for="latency_threshold">Degraded Above (ms, 0 = off)</label><input type="number" id="latency_threshold" value="0" min="0" max="65535"></div>
+                    <div class="form-group"><label for="latency_deviations">Degraded Above Baseline + N Deviations (0 = off)</label><p class="description">Learned from recent checks; 4 is a good start</p><input type="number" id="latency_deviations" value="0" min="0" max="50"></div>
+                </div>
+                <div class="form-row">
+                    <div class="form-group"><label for="latency_slow_checks">Slow Checks for Degraded (0 = Failures for Alert)</label><input type="number" id="latency_slow_checks" value="0" min="0" max="255"></div>
+                    <div class="form-group"><label for="latency_recovery_checks">Normal Checks to Clear (0 = Successes for Recovery)</label><input type="number" id="latency_recovery_checks" value="0" min="0" max="255"></div>
+                </div>
 
                 <label class="section-label">Notification Messages</label>
-                <div class="form-group"><label for="online_message">Online Message</label><p class="description">Placeholders: {NAME}, {URL}</p><textarea id="online_message">{NAME} is back online!</textarea></div>
-                <div class="form-group"><label for="offline_message">Offline Message</label><p class="description">Placeholders: {NAME}, {URL}, {CODE}</p><textarea id="offline_message">{NAME} is down!</textarea></div>
+                <div class="form-group"><label for="online_message">Online Message</label><p class="description">Placeholders: {NAME}, {GROUP}, {URL}, {LATENCY}, {BASELINE}, {TIME}, {DOWNTIME}, {DEPENDENTS}</p><textarea id="online_message">{NAME} is back online!</textarea></div>
+                <div class="form-group"><label for="offline_message">Offline Message</label><p class="description">Placeholders: {NAME}, {GROUP}, {URL}, {CODE}, {LATENCY}, {BASELINE}, {TIME}, {DOWNTIME}, {DEPENDENTS}</p><textarea id="offline_message">{NAME} is down!</textarea></div>
 
                 <label class="section-label">Notification Channels</label>
                 <div class="form-group"><label for="discord_webhook">Discord Webhook URL</label><p class="description">'0' to disable</p><input type="text" id="discord_webhook" value="0"></div>
@@ -285,6 +265,21 @@ const char INDEX_HTML[] PROGMEM = R"rawliteral(
             let refreshIntervalId, logRefreshIntervalId;
             let allServersData = [];
             let currentGroup = 'All';
+            let statusEtag = null, fetchInFlight = false;
+
+            // Table state: rows are kept per server id and patched in place,
+            // so refreshes keep expanded rows and scroll position
+            const VIRTUALIZE_AFTER = 60;       // Longer tables only render rows near the viewport
+            const OVERSCAN_PX = 600;           // Rendered above and below the viewport
+            const DETAILS_HEIGHT_GUESS = 360;  // Until an expanded row has been measured
+            const rowCache = new Map();        // id -> {server, row, detailsRow, rowKey, detailsKey}
+            const expandedIds = new Set();
+            const detailsHeights = new Map();
+            let filteredServers = [];
+            let renderedTabsKey = '';
+            let tableBody = null;
+            let rowHeight = 50;
+            const topSpacer = spacerRow(), bottomSpacer = spacerRow();
 
             // Modal elements
             const settingsModal = document.getElementById('settingsModal');
@@ -303,9 +298,19 @@ const char INDEX_HTML[] PROGMEM = R"rawliteral(
             const closeLogBtn = document.getElementById('closeLogBtn');
             const logContent = document.getElementById('log-content');
 
-            // Auto-refresh functions
+            // Auto-refresh functions; polling pauses while the tab is hidden
             function startAutoRefresh() { clearInterval(refreshIntervalId); fetchData(); refreshIntervalId = setInterval(fetchData, 5000); }
-            function stopAutoRefresh() { clearInterval(refreshIntervalId); }
+            function stopAutoRefresh() { clearInterval(refreshIntervalId); refreshIntervalId = null; }
+            document.addEventListener('visibilitychange', () => { if (!document.hidden && refreshIntervalId) fetchData(); });
+
+            // Virtualized tables follow the scroll position
+            let scrollFrame = 0;
+            const onScroll = () => {
+                if (scrollFrame || filteredServers.length <= VIRTUALIZE_AFTER) return;
+                scrollFrame = requestAnimationFrame(() => { scrollFrame = 0; renderTable(); });
+            };
+            window.addEventListener('scroll', onScroll, {passive: true});
+            window.addEventListener('resize', onScroll);
 
             // Modal handlers
             settingsBtn.onclick = () => { stopAutoRefresh(); settingsModal.style.display = 'block'; }
@@ -342,7 +347,8 @@ const char INDEX_HTML[] PROGMEM = R"rawliteral(
             // Save general settings
             saveGeneralBtn.onclick = async () => {
                 const gmtOffset = document.getElementById('gmt_offset_input').value;
-                const params = new URLSearchParams({gmt_offset: gmtOffset});
+                const coalesceWindow = document.getElementById('coalesce_window_input').value;
+                const params = new URLSearchParams({gmt_offset: gmtOffset, coalesce_window: coalesceWindow});
                 try {
                     const res = await fetch('/api/settings', {method: 'POST', body: params});
                     if (res.ok) {
@@ -367,6 +373,13 @@ const char INDEX_HTML[] PROGMEM = R"rawliteral(
                     group: document.getElementById('server_group').value,
                     url: document.getElementById('server_url').value,
                     check_interval: parseInt(document.getElementById('check_interval').value),
+                    retry_interval: parseInt(document.getElementById('retry_interval').value),
+                    max_check_interval: parseInt(document.getElementById('max_check_interval').value),
+                    parent: parseInt(document.getElementById('parent_id').value),
+                    latency_threshold: parseInt(document.getElementById('latency_threshold').value),
+                    latency_deviations: parseInt(document.getElementById('latency_deviations').value),
+                    latency_slow_checks: parseInt(document.getElementById('latency_slow_checks').value),
+                    latency_recovery_checks: parseInt(document.getElementById('latency_recovery_checks').value),
                     failure_threshold: parseInt(document.getElementById('failure_threshold').value),
                     recovery_threshold: parseInt(document.getElementById('recovery_threshold').value),
                     online_message: document.getElementById('online_message').value,
@@ -417,56 +430,81 @@ const char INDEX_HTML[] PROGMEM = R"rawliteral(
                 }
             }
 
-            // Fetch server data
+            // Fetch server data. Polls send the last ETag; the device answers
+            // 304 while nothing changed, and nothing is parsed or redrawn.
             async function fetchData() {
+                if (document.hidden || fetchInFlight) return;
+                fetchInFlight = true;
                 try {
-                    const response = await fetch('/api/status');
+                    const headers = statusEtag ? {'If-None-Match': statusEtag} : {};
+                    const response = await fetch('/api/status', {headers});
+                    if (response.status === 304) return;
                     if (!response.ok) throw new Error('Network response was not ok');
                     const data = await response.json();
+                    statusEtag = response.headers.get('ETag');
                     allServersData = data.targets;
                     document.getElementById('ssid_input').value = data.general_config.ssid;
                     document.getElementById('gmt_offset_input').value = data.general_config.gmt_offset;
+                    document.getElementById('coalesce_window_input').value = data.general_config.coalesce_window;
                     document.getElementById('firmware_version').textContent = 'Current Version: ' + (data.firmware_version / 10).toFixed(1);
                     updateUI();
                 } catch (error) { console.error('Error fetching status data:', error); }
+                finally { fetchInFlight = false; }
             }
 
-            // Update UI with group tabs and server table
+            // Update group tabs and server table; only what changed is touched
             function updateUI() {
                 const groupTabs = document.getElementById('group-tabs');
                 const groupContent = document.getElementById('group-content');
 
-                // Extract unique groups
-                const groups = new Set(['All']);
+                // Unique groups with their server counts
+                const counts = new Map([['All', 0]]);
                 allServersData.forEach(s => {
-                    if (s.config.enabled) groups.add(s.config.group_name);
+                    if (!s.config.enabled) return;
+                    counts.set('All', counts.get('All') + 1);
+                    counts.set(s.config.group_name, (counts.get(s.config.group_name) || 0) + 1);
                 });
 
-                // Render group tabs
-                groupTabs.innerHTML = '';
-                Array.from(groups).forEach((group, idx) => {
-                    const btn = document.createElement('button');
-                    btn.className = `tab-link ${group === currentGroup ? 'active' : ''}`;
-                    btn.textContent = group;
-                    const count = group === 'All' ? allServersData.filter(s => s.config.enabled).length : allServersData.filter(s => s.config.enabled && s.config.group_name === group).length;
-                    if (count > 0) btn.innerHTML += `<span class="badge badge-count">${count}</span>`;
-                    btn.onclick = () => {
-                        currentGroup = group;
-                        updateUI();
-                    };
-                    groupTabs.appendChild(btn);
-                });
+                // Render group tabs when the groups, counts or selection changed
+                const tabsKey = JSON.stringify([currentGroup, Array.from(counts)]);
+                if (tabsKey !== renderedTabsKey) {
+                    renderedTabsKey = tabsKey;
+                    groupTabs.innerHTML = '';
+                    counts.forEach((count, group) => {
+                        const btn = document.createElement('button');
+                        btn.className = `tab-link ${group === currentGroup ? 'active' : ''}`;
+                        btn.textContent = group;
+                        if (count > 0) btn.innerHTML += `<span class="badge badge-count">${count}</span>`;
+                        btn.onclick = () => {
+                            currentGroup = group;
+                            updateUI();
+                        };
+                        groupTabs.appendChild(btn);
+                    });
+                }
 
                 // Filter servers by current group
-                const filteredServers = allServersData.filter(s => {
+                filteredServers = allServersData.filter(s => {
                     if (!s.config.enabled) return false;
                     return currentGroup === 'All' || s.config.group_name === currentGroup;
                 });
 
+                // Forget rows of servers that were deleted or disabled
+                const enabledIds = new Set(allServersData.filter(s => s.config.enabled).map(s => s.id));
+                rowCache.forEach((entry, id) => {
+                    if (enabledIds.has(id)) return;
+                    rowCache.delete(id);
+                    expandedIds.delete(id);
+                    detailsHeights.delete(id);
+                });
+
                 // Render server table
                 if (filteredServers.length === 0) {
+                    tableBody = null;
                     groupContent.innerHTML = '<div class="card"><div class="empty-state"><h3>No servers in this group</h3><p>Click the + button to add a server</p></div></div>';
-                } else {
+                    return;
+                }
+                if (!tableBody) {
                     groupContent.innerHTML = `
                         <div class="card">
                             <table class="server-table">
@@ -483,81 +521,170 @@ const char INDEX_HTML[] PROGMEM = R"rawliteral(
                             </table>
                         </div>
                     `;
-
-                    const tbody = document.getElementById('serverTableBody');
-                    filteredServers.forEach(server => renderServerRow(tbody, server));
+                    tableBody = document.getElementById('serverTableBody');
                 }
+                filteredServers.forEach(updateServerRow);
+                renderTable();
             }
 
-            // Render individual server row with expandable details
-            function renderServerRow(tbody, server) {
-                const isOnline = server.http_code >= 200 && server.http_code < 400;
-                const rowId = `server-row-${server.id}`;
+            // Update (or create) the cached rows of a server; the DOM is only
+            // written when a displayed value changed. The details row is
+            // filled while it is expanded.
+            function updateServerRow(server) {
+                let entry = rowCache.get(server.id);
+                if (!entry) {
+                    const row = document.createElement('tr');
+                    row.className = 'server-row';
+                    row.id = `server-row-${server.id}`;
+                    row.onclick = () => toggleServerDetails(server.id);
+                    const detailsRow = document.createElement('tr');
+                    detailsRow.className = 'server-details';
+                    detailsRow.id = `server-details-${server.id}`;
+                    entry = {row, detailsRow, rowKey: '', detailsKey: ''};
+                    rowCache.set(server.id, entry);
+                }
+                entry.server = server;
+
+                const rowKey = JSON.stringify([server.config.server_name, server.config.weburl, server.http_code, server.degraded, server.ping.last]);
+                if (rowKey !== entry.rowKey) {
+                    entry.rowKey = rowKey;
+                    const isOnline = server.http_code >= 200 && server.http_code < 400;
+                    const status = !isOnline ? 'offline' : server.degraded ? 'degraded' : 'online';
+                    const statusText = !isOnline ? `Offline (${server.http_code})` : server.degraded ? 'Degraded' : 'Online';
+                    entry.row.innerHTML = `
+                        <td><strong>${server.config.server_name}</strong></td>
+                        <td><span class="status-indicator ${status}"></span> ${statusText}</td>
+                        <td style="word-break: break-all; max-width: 300px;">${server.config.weburl}</td>
+                        <td>${server.ping.last} ms</td>
+                        <td>
+                            <button class="btn btn-small" onclick="event.stopPropagation(); editServer(${server.id})">Edit</button>
+                            <button class="btn btn-small btn-danger" onclick="event.stopPropagation(); deleteServer(${server.id}, '${server.config.server_name}')">Delete</button>
+                        </td>
+                    `;
+                }
+                const expanded = expandedIds.has(server.id);
+                entry.row.classList.toggle('expanded', expanded);
+                entry.detailsRow.classList.toggle('show', expanded);
+                if (expanded) renderServerDetails(entry);
+            }
 
-                // Main row
-                const row = document.createElement('tr');
-                row.className = 'server-row';
-                row.id = rowId;
-                row.innerHTML = `
-                    <td><strong>${server.config.server_name}</strong></td>
-                    <td><span class="status-indicator ${isOnline ? 'online' : 'offline'}"></span> ${isOnline ? 'Online' : `Offline (${server.http_code})`}</td>
-                    <td style="word-break: break-all; max-width: 300px;">${server.config.weburl}</td>
-                    <td>${server.ping.last} ms</td>
-                    <td>
-                        <button class="btn btn-small" onclick="event.stopPropagation(); editServer(${server.id})">Edit</button>
-                        <button class="btn btn-small btn-danger" onclick="event.stopPropagation(); deleteServer(${server.id}, '${server.config.server_name}')">Delete</button>
-                    </td>
-                `;
-                row.onclick = () => toggleServerDetails(server.id);
-                tbody.appendChild(row);
-
-                // Details row (hidden by default)
-                const detailsRow = document.createElement('tr');
-                detailsRow.className = 'server-details';
-                detailsRow.id = `server-details-${server.id}`;
-                detailsRow.innerHTML = `
+            function renderServerDetails(entry) {
+                const server = entry.server;
+                const detailsKey = JSON.stringify([server.config, server.effective_interval_seconds, server.blocked_by, server.ping, server.baseline, server.uptime, server.log]);
+                if (detailsKey === entry.detailsKey) return;
+                entry.detailsKey = detailsKey;
+                entry.detailsRow.innerHTML = `
                     <td colspan="5">
                         <div class="details-grid">
                             <div class="detail-item"><strong>Group</strong>${server.config.group_name}</div>
-                            <div class="detail-item"><strong>Check Interval</strong>${server.config.check_interval_seconds}s</div>
+                            <div class="detail-item"><strong>Check Interval</strong>${server.effective_interval_seconds}s (base ${server.config.check_interval_seconds}s, max ${server.config.max_check_interval_seconds}s)</div>
+                            <div class="detail-item"><strong>Depends On</strong>${server.config.parent_id >= 0 ? 'Server ' + server.config.parent_id : '-'}${server.blocked_by >= 0 ? ' (server ' + server.blocked_by + ' down, checks slowed)' : ''}</div>
                             <div class="detail-item"><strong>Min Ping</strong>${server.ping.min} ms</div>
                             <div class="detail-item"><strong>Max Ping</strong>${server.ping.max} ms</div>
+                            <div class="detail-item"><strong>Latency Baseline</strong>${server.baseline.mean_ms !== null ? server.baseline.mean_ms + ' &plusmn; ' + server.baseline.deviation_ms + ' ms' : '-'}${server.baseline.limit_ms !== null ? ' (degraded above ' + server.baseline.limit_ms + ' ms)' : ''}</div>
                             <div class="detail-item"><strong>Failure Threshold</strong>${server.config.failure_threshold}</div>
                             <div class="detail-item"><strong>Recovery Threshold</strong>${server.config.recovery_threshold}</div>
+                            <div class="detail-item"><strong>Uptime 24h / 7d / 30d</strong>${formatUptime(server.uptime['24h'])} / ${formatUptime(server.uptime['7d'])} / ${formatUptime(server.uptime['30d'])}</div>
                         </div>
                         <h4 style="margin-top: 20px;">Uptime Log</h4>
-                        <div class="timeline" id="timeline-${server.id}"></div>
+                        <div class="timeline"></div>
                     </td>
                 `;
-                tbody.appendChild(detailsRow);
 
                 // Populate timeline
-                const timeline = detailsRow.querySelector(`#timeline-${server.id}`);
-                const logEntries = server.log.split('\\n').filter(e => e.trim() !== '');
+                const timeline = entry.detailsRow.querySelector('.timeline');
+                const logEntries = server.log.split('\n').filter(e => e.trim() !== '');
                 if (logEntries.length === 0) {
                     timeline.innerHTML = '<p>No log entries yet.</p>';
                 } else {
-                    logEntries.forEach(entry => {
-                        const parts = entry.split(';');
+                    logEntries.forEach(logEntry => {
+                        const parts = logEntry.split(';');
                         if (parts.length < 2) return;
                         const status = parts[0];
                         const time = parts[1];
-                        const isEntryOnline = (status === 'on');
-                        const text = isEntryOnline ? 'Server Online' : 'Server Offline';
+                        const kinds = {
+                            on: ['status-on', 'Server Online'],
+                            off: ['status-off', 'Server Offline'],
+                            degraded: ['status-degraded', 'Latency Degraded'],
+                            normal: ['status-on', 'Latency Normal']
+                        };
+                        const [className, text] = kinds[status] || kinds.off;
                         const eventDiv = document.createElement('div');
-                        eventDiv.className = `timeline-event ${isEntryOnline ? 'status-on' : 'status-off'}`;
+                        eventDiv.className = `timeline-event ${className}`;
                         eventDiv.innerHTML = `<time>${time}</time><p>${text}</p>`;
                         timeline.appendChild(eventDiv);
                     });
                 }
             }
 
+            // Put the rows of filteredServers into the table. Long tables are
+            // virtualized: only the rows near the viewport are in the DOM and
+            // spacer rows stand in for the rest.
+            function renderTable() {
+                if (!tableBody) return;
+                let start = 0, end = filteredServers.length, topPad = 0, bottomPad = 0;
+                if (filteredServers.length > VIRTUALIZE_AFTER) {
+                    const offset = -tableBody.getBoundingClientRect().top;
+                    const from = offset - OVERSCAN_PX, to = offset + window.innerHeight + OVERSCAN_PX;
+                    let y = 0, height = 0;
+                    start = end = -1;
+                    filteredServers.forEach((server, i) => {
+                        height = rowHeight + (expandedIds.has(server.id) ? (detailsHeights.get(server.id) || DETAILS_HEIGHT_GUESS) : 0);
+                        if (start < 0 && y + height > from) { start = i; topPad = y; }
+                        if (start >= 0 && end < 0 && y > to) end = i;
+                        if (end >= 0) bottomPad += height;
+                        y += height;
+                    });
+                    // Scrolled past the end (the list just got shorter): keep the last row
+                    if (start < 0) { start = filteredServers.length - 1; topPad = y - height; }
+                    if (end < 0) end = filteredServers.length;
+                }
+
+                // Wanted sequence of rows; existing rows stay in place
+                const wanted = [topSpacer];
+                filteredServers.slice(start, end).forEach(server => {
+                    const entry = rowCache.get(server.id);
+                    wanted.push(entry.row);
+                    if (expandedIds.has(server.id)) wanted.push(entry.detailsRow);
+                });
+                wanted.push(bottomSpacer);
+                topSpacer.firstChild.style.height = topPad + 'px';
+                bottomSpacer.firstChild.style.height = bottomPad + 'px';
+                wanted.forEach((node, i) => {
+                    if (tableBody.children[i] !== node) tableBody.insertBefore(node, tableBody.children[i] || null);
+                });
+                while (tableBody.children.length > wanted.length) tableBody.lastChild.remove();
+
+                // Measure what is on screen for the next layout
+                if (end > start) {
+                    const first = rowCache.get(filteredServers[start].id).row.offsetHeight;
+                    if (first > 0) rowHeight = first;
+                }
+                expandedIds.forEach(id => {
+                    const entry = rowCache.get(id);
+                    if (entry && entry.detailsRow.isConnected) detailsHeights.set(id, entry.detailsRow.offsetHeight);
+                });
+            }
+
+            function spacerRow() {
+                const row = document.createElement('tr');
+                row.innerHTML = '<td colspan="5" style="padding: 0; border: 0;"></td>';
+                return row;
+            }
+
+            // Format an uptime percentage (null when no samples yet)
+            function formatUptime(value) {
+                return (value === null || value === undefined) ? '&ndash;' : `${value.toFixed(2)}%`;
+            }
+
             // Toggle server details expansion
             function toggleServerDetails(serverId) {
-                const row = document.getElementById(`server-row-${serverId}`);
-                const details = document.getElementById(`server-details-${serverId}`);
-                row.classList.toggle('expanded');
-                details.classList.toggle('show');
+                const entry = rowCache.get(serverId);
+                if (!entry) return;
+                if (expandedIds.has(serverId)) expandedIds.delete(serverId);
+                else expandedIds.add(serverId);
+                updateServerRow(entry.server);
+                renderTable();
             }
 
             // Edit server
@@ -572,6 +699,13 @@ const char INDEX_HTML[] PROGMEM = R"rawliteral(
                 document.getElementById('server_group').value = server.config.group_name;
                 document.getElementById('server_url').value = server.config.weburl;
                 document.getElementById('check_interval').value = server.config.check_interval_seconds;
+                document.getElementById('retry_interval').value = server.config.retry_interval_seconds;
+                document.getElementById('max_check_interval').value = server.config.max_check_interval_seconds;
+                document.getElementById('parent_id').value = server.config.parent_id;
+                document.getElementById('latency_threshold').value = server.config.latency_threshold_ms;
+                document.getElementById('latency_deviations').value = server.config.latency_deviations;
+                document.getElementById('latency_slow_checks').value = server.config.latency_slow_checks;
+                document.getElementById('latency_recovery_checks').value = server.config.latency_recovery_checks;
                 document.getElementById('failure_threshold').value = server.config.failure_threshold;
                 document.getElementById('recovery_threshold').value = server.config.recovery_threshold;
                 document.getElementById('online_message').value = server.config.online_message;
@@ -620,98 +754,6 @@ const char INDEX_HTML[] PROGMEM = R"rawliteral(
 
 // --- HELPER FUNCTIONS ---
 
-void getFormattedTime(char* buffer, size_t bufferSize) {
-    struct tm timeinfo;
-    if (!getLocalTime(&timeinfo)) {
-        strncpy(buffer, "Time not set", bufferSize -1);
-        buffer[bufferSize -1] = '\0';
-        return;
-    }
-    strftime(buffer, bufferSize, "%Y-%m-%d %H:%M:%S", &timeinfo);
-}
-
-void web_log_printf(const char *format, ...) {
-    char timeBuf[30];
-    getFormattedTime(timeBuf, sizeof(timeBuf));
-
-    char logBuf[256];
-    va_list args;
-    va_start(args, format);
-    vsnprintf(logBuf, sizeof(logBuf), format, args);
-    va_end(args);
-
-    Serial.printf("[%s] %s\n", timeBuf, logBuf);
-
-    int len = snprintf(NULL, 0, "[%s] %s\n", timeBuf, logBuf);
-    if (serialLogBufferPos + len >= SERIAL_LOG_SIZE) {
-        serialLogBufferPos = 0;
-    }
-    snprintf(serialLogBuffer + serialLogBufferPos, SERIAL_LOG_SIZE - serialLogBufferPos, "[%s] %s\n", timeBuf, logBuf);
-    serialLogBufferPos += len;
-}
-
-void prependToLog(char* logBuffer, const char* newEntry, size_t bufferSize) {
-    size_t entryLen = strlen(newEntry);
-    if (entryLen >= bufferSize) return;
-
-    size_t currentLen = strlen(logBuffer);
-    
-    if (currentLen + entryLen >= bufferSize) {
-        currentLen = bufferSize - entryLen - 1;
-    }
-
-    memmove(logBuffer + entryLen, logBuffer, currentLen);
-    memcpy(logBuffer, newEntry, entryLen);
-    logBuffer[currentLen + entryLen] = '\0';
-}
-
-void safeStrcpy(char* dest, const char* src, size_t size) {
-    strncpy(dest, src, size - 1);
-    dest[size - 1] = '\0';
-}
-
-void urlEncode(char* dst, const char* src, size_t dstSize) {
-    char c, hex_buf[4];
-    size_t written = 0;
-    while (*src && written + 4 < dstSize) {
-        c = *src++;
-        if (isalnum(c) || c == '-' || c == '_' || c == '.' || c == '~') {
-            dst[written++] = c;
-        } else {
-            sprintf(hex_buf, "%%%02X", c);
-            dst[written++] = hex_buf[0];
-            dst[written++] = hex_buf[1];
-            dst[written++] = hex_buf[2];
-        }
-    }
-    dst[written] = '\0';
-}
-
-void resetToDefault() {
-    Serial.println("Resetting to default values...");
-
-    // Clear EEPROM
-    EEPROM.begin(EEPROM_SIZE);
-    for (int i = 0; i < EEPROM_SIZE; i++) EEPROM.write(i, 0);
-    EEPROM.put(CONFIG_VERSION_ADDRESS, CONFIG_VERSION);
-    EEPROM.commit();
-    EEPROM.end();
-    Serial.println("EEPROM cleared.");
-
-    // Clear LittleFS config
-    if (LittleFS.exists("/config.json")) {
-        LittleFS.remove("/config.json");
-        Serial.println("LittleFS config cleared.");
-    }
-
-    // NOTE: WiFi credentials are NOT cleared here
-    // WiFiManager stores credentials in NVS independently of app config
-    // WiFi credentials should persist across app config version changes
-    // Use factoryReset() function instead if you need to clear WiFi credentials
-
-    Serial.println("App settings reset to defaults (WiFi credentials preserved).");
-}
-
 void factoryReset() {
     Serial.println("Performing FACTORY RESET - clearing ALL settings including WiFi...");
 
@@ -726,229 +768,96 @@ void factoryReset() {
     Serial.println("Factory reset complete. Device will restart.");
 }
 
-// WiFiManager callback notifying us of the need to save config
-void saveConfigCallback() {
-    Serial.println("Should save config");
-    shouldSaveConfig = true;
-}
+// Reassemble a JSON request body that may arrive in several TCP segments.
+// Returns the complete, NUL-terminated body once the last chunk is in, nullptr
+// before that (or after answering 413/500). The buffer lives in _tempObject,
+// which the request frees.
+const size_t MAX_JSON_BODY = 4096;
 
-// Forward declaration
-void saveConfig();
-
-void loadConfig() {
-    bool configLoaded = false;
-
-    // Load configuration from LittleFS
-    if (LittleFS.exists("/config.json")) {
-        File configFile = LittleFS.open("/config.json", "r");
-        if (configFile) {
-            Serial.println("Reading config file");
-            size_t size = configFile.size();
-            std::unique_ptr<char[]> buf(new char[size]);
-            configFile.readBytes(buf.get(), size);
-
-            // Larger buffer for 20 servers (10KB)
-            DynamicJsonDocument json(10240);
-
-            if (deserializeJson(json, buf.get()) == DeserializationError::Ok) {
-                Serial.println("Successfully parsed config");
-                gmt_offset = json["gmt_offset"] | 1;
-                Serial.printf("Loaded GMT offset: %d\n", gmt_offset);
-
-                // Load server configurations
-                JsonArray servers = json["servers"];
-                if (servers) {
-                    int loadedCount = 0;
-                    for (JsonObject server : servers) {
-                        int i = server["id"] | loadedCount;
-                        if (i >= 0 && i < NUM_TARGETS) {
-                            strlcpy(targets[i].server_name, server["name"] | "", sizeof(targets[i].server_name));
-                            strlcpy(targets[i].group_name, server["group"] | "Default", sizeof(targets[i].group_name));
-                            strlcpy(targets[i].weburl, server["url"] | "0", sizeof(targets[i].weburl));
-                            targets[i].enabled = server["enabled"] | false;
-                            targets[i].check_interval_seconds = server["check_interval"] | 20;
-                            targets[i].failure_threshold = server["failure_threshold"] | 3;
-                            targets[i].recovery_threshold = server["recovery_threshold"] | 2;
-
-                            strlcpy(targets[i].discord_webhook_url, server["discord_webhook"] | "0", sizeof(targets[i].discord_webhook_url));
-                            strlcpy(targets[i].ntfy_url, server["ntfy_url"] | "0", sizeof(targets[i].ntfy_url));
-                            strlcpy(targets[i].ntfy_priority, server["ntfy_priority"] | "default", sizeof(targets[i].ntfy_priority));
-                            strlcpy(targets[i].telegram_bot_token, server["telegram_token"] | "0", sizeof(targets[i].telegram_bot_token));
-                            strlcpy(targets[i].telegram_chat_id_1, server["telegram_chat1"] | "0", sizeof(targets[i].telegram_chat_id_1));
-                            strlcpy(targets[i].telegram_chat_id_2, server["telegram_chat2"] | "0", sizeof(targets[i].telegram_chat_id_2));
-                            strlcpy(targets[i].telegram_chat_id_3, server["telegram_chat3"] | "0", sizeof(targets[i].telegram_chat_id_3));
-                            strlcpy(targets[i].http_get_url_on, server["http_url_on"] | "0", sizeof(targets[i].http_get_url_on));
-                            strlcpy(targets[i].http_get_url_off, server["http_url_off"] | "0", sizeof(targets[i].http_get_url_off));
-                            strlcpy(targets[i].online_message, server["msg_online"] | "✅ {NAME} is back online: {URL}", sizeof(targets[i].online_message));
-                            strlcpy(targets[i].offline_message, server["msg_offline"] | "🚨 {NAME} OUTAGE: {URL} (Code: {CODE})", sizeof(targets[i].offline_message));
-
-                            loadedCount++;
-                        }
-                    }
-                    Serial.printf("Loaded %d servers from config\n", loadedCount);
-                    configLoaded = true;
-                }
-            } else {
-                Serial.println("Failed to parse JSON config");
-            }
-            configFile.close();
-        }
+char* collectBody(AsyncWebServerRequest *request, uint8_t *data, size_t len, size_t index, size_t total) {
+    if (total > MAX_JSON_BODY) {
+        if (index == 0) request->send(413, "application/json", "{\"success\":false,\"error\":\"Request body too large\"}");
+        return nullptr;
     }
-
-    // Initialize with defaults if no config exists
-    if (!configLoaded) {
-        Serial.println("Initializing default configuration");
-        for (int i = 0; i < NUM_TARGETS; i++) {
-            char name[32];
-            snprintf(name, sizeof(name), "Server %d", i + 1);
-            safeStrcpy(targets[i].server_name, name, sizeof(targets[i].server_name));
-            strcpy(targets[i].group_name, (i < 3) ? "Production" : "Staging");
-            strcpy(targets[i].weburl, (i == 0) ? "http://localhost" : "0");
-            targets[i].enabled = (i < 3);  // Only first 3 enabled by default
-
-            strcpy(targets[i].discord_webhook_url, "0");
-            strcpy(targets[i].ntfy_url, "0");
-            strcpy(targets[i].ntfy_priority, "default");
-            strcpy(targets[i].telegram_bot_token, "0");
-            strcpy(targets[i].telegram_chat_id_1, "0");
-            strcpy(targets[i].telegram_chat_id_2, "0");
-            strcpy(targets[i].telegram_chat_id_3, "0");
-            strcpy(targets[i].http_get_url_on, "0");
-            strcpy(targets[i].http_get_url_off, "0");
-            safeStrcpy(targets[i].online_message, "✅ {NAME} is back online: {URL}", sizeof(targets[i].online_message));
-            safeStrcpy(targets[i].offline_message, "🚨 {NAME} OUTAGE: {URL} (Code: {CODE})", sizeof(targets[i].offline_message));
-            targets[i].check_interval_seconds = 20;
-            targets[i].failure_threshold = 3;
-            targets[i].recovery_threshold = 2;
+    if (index == 0) {
+        request->_tempObject = malloc(total + 1);
+        if (!request->_tempObject) {
+            request->send(500, "application/json", "{\"success\":false,\"error\":\"Out of memory\"}");
+            return nullptr;
         }
-        // Save the default config
-        saveConfig();
     }
+    char* body = (char*)request->_tempObject;
+    if (!body || index + len > total) return nullptr;
+    memcpy(body + index, data, len);
+    if (index + len < total) return nullptr;
+    body[total] = '\0';
+    return body;
+}
 
-    gmtOffset_sec = gmt_offset * 3600;
+// Value of a query parameter, or nullptr when absent (valid for the request)
+const char* queryParam(AsyncWebServerRequest *request, const char* name) {
+    const AsyncWebParameter* p = request->getParam(name);
+    return p ? p->value().c_str() : nullptr;
 }
 
-void saveConfig() {
-    Serial.println("Saving config to LittleFS");
-
-    // Larger buffer for 20 servers (10KB)
-    DynamicJsonDocument json(10240);
-
-    json["gmt_offset"] = gmt_offset;
-    json["config_version"] = CONFIG_VERSION;
-
-    // Create servers array
-    JsonArray servers = json.createNestedArray("servers");
-
-    for (int i = 0; i < NUM_TARGETS; i++) {
-        // Only save enabled servers or those with configuration
-        if (targets[i].enabled || strlen(targets[i].weburl) > 1) {
-            JsonObject server = servers.createNestedObject();
-
-            server["id"] = i;
-            server["name"] = targets[i].server_name;
-            server["group"] = targets[i].group_name;
-            server["url"] = targets[i].weburl;
-            server["enabled"] = targets[i].enabled;
-            server["check_interval"] = targets[i].check_interval_seconds;
-            server["failure_threshold"] = targets[i].failure_threshold;
-            server["recovery_threshold"] = targets[i].recovery_threshold;
-
-            server["discord_webhook"] = targets[i].discord_webhook_url;
-            server["ntfy_url"] = targets[i].ntfy_url;
-            server["ntfy_priority"] = targets[i].ntfy_priority;
-            server["telegram_token"] = targets[i].telegram_bot_token;
-            server["telegram_chat1"] = targets[i].telegram_chat_id_1;
-            server["telegram_chat2"] = targets[i].telegram_chat_id_2;
-            server["telegram_chat3"] = targets[i].telegram_chat_id_3;
-            server["http_url_on"] = targets[i].http_get_url_on;
-            server["http_url_off"] = targets[i].http_get_url_off;
-            server["msg_online"] = targets[i].online_message;
-            server["msg_offline"] = targets[i].offline_message;
-        }
+// AsyncJsonResponse that encodes its document as JSON, CBOR or MessagePack,
+// whichever the client negotiated (same windowed re-encode per chunk)
+class ApiResponse : public AsyncJsonResponse {
+public:
+    ApiResponse(ApiFormat format, bool isArray, size_t capacity) : AsyncJsonResponse(isArray, capacity), _format(format) {
+        _contentType = apiFormatContentType(format);
     }
-
-    File configFile = LittleFS.open("/config.json", "w");
-    if (!configFile) {
-        Serial.println("Failed to open config file for writing");
-        return;
+    size_t setLength() {
+        _contentLength = measureApiDocument(_root, _format);
+        if (_contentLength) _isValid = true;
+        return _contentLength;
     }
-
-    size_t bytesWritten = serializeJson(json, configFile);
-    configFile.close();
-
-    if (bytesWritten == 0) {
-        Serial.println("Failed to write JSON to file");
-    } else {
-        Serial.printf("Config saved (%d bytes)\n", bytesWritten);
+    size_t _fillBuffer(uint8_t *data, size_t len) override {
+        ChunkPrint dest(data, _sentLength, len);
+        serializeApiDocument(_root, _format, dest);
+        return len;
     }
 
-    // Update version in EEPROM for compatibility checking
-    EEPROM.begin(EEPROM_SIZE);
-    EEPROM.put(CONFIG_VERSION_ADDRESS, CONFIG_VERSION);
-    EEPROM.commit();
-    EEPROM.end();
+private:
+    ApiFormat _format;
+};
+
+ApiFormat requestApiFormat(AsyncWebServerRequest *request) {
+    const AsyncWebHeader* accept = request->getHeader("Accept");
+    return negotiateApiFormat(accept ? accept->value().c_str() : nullptr, queryParam(request, "format"));
 }
 
-void updatePingStats(int index) {
-    if (pingTime[index] < minpingTime[index] || minpingTime[index] == 0) minpingTime[index] = pingTime[index];
-    if (pingTime[index] > maxpingTime[index]) maxpingTime[index] = pingTime[index];
+ApiResponse* newApiResponse(AsyncWebServerRequest *request, bool isArray, size_t capacity) {
+    ApiResponse* response = new ApiResponse(requestApiFormat(request), isArray, capacity);
+    response->addHeader("Vary", "Accept");
+    return response;
 }
 
-void sendNotifications(int index, const char* msg) {
-    TargetConfig target = targets[index];
-    HTTPClient http;
-    http.setTimeout(3000);  // 3 second timeout for notifications
-
-    if (strcmp(target.discord_webhook_url, "0") != 0 && strlen(target.discord_webhook_url) > 10) {
-        http.begin(target.discord_webhook_url);
-        http.addHeader("Content-Type", "application/json");
-        char payload[256];
-        snprintf(payload, sizeof(payload), "{\"content\":\"%s\"}", msg);
-        http.POST(payload);
-        http.end();
+// Sends a shared status snapshot; holding the reference keeps the buffer
+// alive until the last chunk is out, even if the status changes meanwhile
+class SnapshotResponse : public AsyncAbstractResponse {
+public:
+    explicit SnapshotResponse(const std::shared_ptr<const StatusSnapshot>& snapshot) : _snapshot(snapshot) {
+        _code = 200;
+        _contentType = apiFormatContentType(snapshot->format);
+        _contentLength = snapshot->length;
     }
-    if (strcmp(target.ntfy_url, "0") != 0 && strlen(target.ntfy_url) > 10) {
-        http.begin(target.ntfy_url);
-        http.addHeader("Content-Type", "text/plain");
-        http.addHeader("Priority", target.ntfy_priority);
-        http.POST(msg);
-        http.end();
+    bool _sourceValid() const override { return true; }
+    size_t _fillBuffer(uint8_t *data, size_t len) override {
+        size_t left = _snapshot->length - _sentLength;
+        if (len > left) len = left;
+        memcpy(data, _snapshot->data + _sentLength, len);
+        return len;
     }
-    if (strlen(target.telegram_bot_token) > 10) {
-        char encodedMsg[512];
-        urlEncode(encodedMsg, msg, sizeof(encodedMsg));
-        
-        char url[512];
-        const char* chat_ids[] = {target.telegram_chat_id_1, target.telegram_chat_id_2, target.telegram_chat_id_3};
-        for (int j = 0; j < 3; j++) {
-            if (strcmp(chat_ids[j], "0") != 0 && strlen(chat_ids[j]) > 1) {
-                snprintf(url, sizeof(url), "https://api.telegram.org/bot%s/sendMessage?chat_id=%s&text=%s", target.telegram_bot_token, chat_ids[j], encodedMsg);
-                http.begin(url);
-                http.GET();
-                http.end();
-            }
-        }
-    }
-}
 
-void sendCustomHttpRequest(const char* url) {
-    if (strcmp(url, "0") == 0 || strlen(url) < 10) return;
-    HTTPClient http;
-    http.setTimeout(3000);  // 3 second timeout
-    http.begin(url);
-    http.GET();
-    http.end();
-}
+private:
+    std::shared_ptr<const StatusSnapshot> _snapshot;
+};
 
-void manageWifiConnection() {
-  if (WiFi.status() != WL_CONNECTED) {
-    if (millis() - lastWifiReconnectAttempt > wifiReconnectInterval) {
-      lastWifiReconnectAttempt = millis();
-      web_log_printf("WiFi connection lost. Attempting to reconnect...");
-      WiFi.reconnect(); // Reconnect using stored credentials
-    }
-  }
+// WiFiManager callback notifying us of the need to save config
+void saveConfigCallback() {
+    Serial.println("Should save config");
+    shouldSaveConfig = true;
 }
 
 void setup() {
@@ -962,15 +871,13 @@ void setup() {
         web_log_printf("LittleFS mounted successfully");
     }
 
-    EEPROM.begin(EEPROM_SIZE);
-    int storedVersion = 0;
-    EEPROM.get(CONFIG_VERSION_ADDRESS, storedVersion);
-    EEPROM.end();
-    if (storedVersion != CONFIG_VERSION) {
-        web_log_printf("Config version mismatch! Stored: %d, Firmware: %d. Resetting.", storedVersion, CONFIG_VERSION);
+    // Older schemas are migrated in place by loadConfig(); only pre-LittleFS
+    // settings are reset here. A file from newer firmware is left to
+    // loadConfig(), which keeps a copy before falling back to defaults
+    int storedVersion = hal_stored_config_version();
+    if (storedVersion < CONFIG_VERSION && !configVersionMigratable(storedVersion)) {
+        web_log_printf("Config version %d cannot be migrated to %d. Resetting.", storedVersion, CONFIG_VERSION);
         resetToDefault();
-        delay(1000);
-        ESP.restart();
     }
 
     // TEMPORARILY DISABLED - GPIO0 strapping pin issue
@@ -982,6 +889,9 @@ void setup() {
 
     // Load configuration from LittleFS and EEPROM
     loadConfig();
+    loadUptimeStats();
+    metricsPushBegin();
+    alertQueueBegin();
 
     // Force ESP32 to use 2.4GHz only (channels 1-13)
     // ESP32 hardware doesn't support 5GHz WiFi
@@ -1034,6 +944,7 @@ void setup() {
     web_log_printf("Starting WiFi configuration...");
 
     bool wifiConnected = false;
+    webLogFlush();  // The portal can block for a long time
 
     if (forceConfigPortal) {
         // Force start config portal
@@ -1047,6 +958,7 @@ void setup() {
 
     if (!wifiConnected) {
         web_log_printf("Failed to connect - restarting...");
+        webLogFlush();
         delay(3000);
         ESP.restart();
     }
@@ -1072,66 +984,106 @@ void setup() {
     }
 
     gmtOffset_sec = gmt_offset * 3600;
-    configTime(gmtOffset_sec, 0, ntpServer);
+    hal_configure_time(gmtOffset_sec, ntpServer);
+    webLogSetUtcOffset(gmtOffset_sec);
 
     // Initialize AsyncWebServer now that WiFiManager has completed
     // (Avoids port 80 conflict with WiFiManager's config portal)
     server = new AsyncWebServer(80);
 
     server->on("/", HTTP_GET, [](AsyncWebServerRequest *request) {
+        LatencyScope latency(endpointLatency[ENDPOINT_INDEX]);
         request->send(200, "text/html", FPSTR(INDEX_HTML));
     });
 
     server->on("/api/logs", HTTP_GET, [](AsyncWebServerRequest *request) {
+        LatencyScope latency(endpointLatency[ENDPOINT_LOGS]);
+        webLogFlush();
         request->send(200, "text/plain", serialLogBuffer);
     });
 
     server->on("/api/status", HTTP_GET, [](AsyncWebServerRequest *request) {
-        AsyncJsonResponse * response = new AsyncJsonResponse(false, 16384);  // 16KB buffer for 20 servers
-        JsonObject root = response->getRoot();
-
-        root["firmware_version"] = CONFIG_VERSION;
-        JsonObject general_config = root.createNestedObject("general_config");
-        general_config["ssid"] = WiFi.SSID();
-        general_config["gmt_offset"] = gmt_offset;
-
-        JsonArray targets_json = root.createNestedArray("targets");
-        for (int i = 0; i < NUM_TARGETS; i++) {
-            JsonObject target_obj = targets_json.createNestedObject();
-            target_obj["id"] = i;
-            target_obj["http_code"] = httpCode[i];
-            target_obj["log"] = targetLogMessages[i];
-            JsonObject ping = target_obj.createNestedObject("ping");
-            ping["last"] = pingTime[i];
-            ping["min"] = minpingTime[i];
-            ping["max"] = maxpingTime[i];
-
-            JsonObject config = target_obj.createNestedObject("config");
-            config["server_name"] = targets[i].server_name;
-            config["group_name"] = targets[i].group_name;
-            config["enabled"] = targets[i].enabled;
-            config["weburl"] = targets[i].weburl;
-            config["discord_webhook"] = targets[i].discord_webhook_url;
-            config["ntfy_url"] = targets[i].ntfy_url;
-            config["ntfy_priority"] = targets[i].ntfy_priority;
-            config["telegram_bot_token"] = targets[i].telegram_bot_token;
-            config["telegram_chat_id_1"] = targets[i].telegram_chat_id_1;
-            config["telegram_chat_id_2"] = targets[i].telegram_chat_id_2;
-            config["telegram_chat_id_3"] = targets[i].telegram_chat_id_3;
-            config["http_get_url_on"] = targets[i].http_get_url_on;
-            config["http_get_url_off"] = targets[i].http_get_url_off;
-            config["online_message"] = targets[i].online_message;
-            config["offline_message"] = targets[i].offline_message;
-            config["check_interval_seconds"] = targets[i].check_interval_seconds;
-            config["failure_threshold"] = targets[i].failure_threshold;
-            config["recovery_threshold"] = targets[i].recovery_threshold;
+        LatencyScope latency(endpointLatency[ENDPOINT_STATUS]);
+        const char* group = queryParam(request, "group");
+        const char* state = queryParam(request, "state");
+        const char* ids = queryParam(request, "ids");
+        const char* fields = queryParam(request, "fields");
+
+        // Unfiltered polls (every dashboard) share one encoded body per format
+        if (!group && !state && !ids && !fields) {
+            ApiFormat format = requestApiFormat(request);
+            std::shared_ptr<const StatusSnapshot> snapshot = statusSnapshot(format);
+            if (snapshot) {
+                char etag[32];
+                statusSnapshotEtag(*snapshot, etag, sizeof(etag));
+                const AsyncWebHeader* ifNoneMatch = request->getHeader("If-None-Match");
+                AsyncWebServerResponse* response;
+                if (ifNoneMatch && ifNoneMatch->value() == etag) response = request->beginResponse(304);
+                else response = new SnapshotResponse(snapshot);
+                response->addHeader("Vary", "Accept");
+                response->addHeader("ETag", etag);
+                response->addHeader("Cache-Control", "no-cache");
+                request->send(response);
+                return;
+            }
+            // No memory for a snapshot: build this one per request
         }
 
+        HeapScope heapScope(HEAP_STATUS_JSON);
+        // ?group=&state=&ids=&fields= select targets and keys before anything is encoded
+        StatusFilter filter;
+        const char* error = parseStatusFilter(filter, group, state, ids, fields);
+        if (error) {
+            request->send(400, "application/json", "{\"success\":false,\"error\":\"" + String(error) + "\"}");
+            return;
+        }
+        size_t capacity = statusJsonCapacity(filter);  // 18KB for 20 servers when unfiltered
+        ApiResponse * response = newApiResponse(request, false, capacity);
+        buildStatusJson(response->getRoot(), filter);
+        heapScope.sample();
+        heapScope.noteBuffer(capacity, response->getRoot().memoryUsage());
+
+        response->setLength();
+        request->send(response);
+    });
+
+    // GET /api/diagnostics - Heap use per subsystem, stack watermarks, fragmentation trend
+    server->on("/api/diagnostics", HTTP_GET, [](AsyncWebServerRequest *request) {
+        LatencyScope latency(endpointLatency[ENDPOINT_DIAGNOSTICS]);
+        recordStackFree(STACK_ASYNC_TCP);  // Handlers run on the AsyncTCP task
+        ApiResponse * response = newApiResponse(request, false, 8192);
+        buildDiagnosticsJson(response->getRoot());
+
         response->setLength();
         request->send(response);
     });
     
+    // GET /api/latency - Loop, probe, scheduling-lag and handler latency histograms
+    server->on("/api/latency", HTTP_GET, [](AsyncWebServerRequest *request) {
+        LatencyScope latency(endpointLatency[ENDPOINT_LATENCY]);
+        bool includeBuckets = request->hasParam("buckets");
+        ApiResponse * response = newApiResponse(request, false, latencyJsonCapacity(includeBuckets));
+        buildLatencyJson(response->getRoot(), includeBuckets);
+
+        response->setLength();
+        request->send(response);
+    });
+
+    server->on("/metrics", HTTP_GET, [](AsyncWebServerRequest *request) {
+        LatencyScope latency(endpointLatency[ENDPOINT_METRICS]);
+        MetricsCursor cursor;
+        metricsBegin(cursor);
+        AsyncWebServerResponse* response = request->beginChunkedResponse("text/plain; version=0.0.4; charset=utf-8",
+            [cursor](uint8_t *buffer, size_t maxLen, size_t index) mutable -> size_t {
+                LatencyScope latency(endpointLatency[ENDPOINT_METRICS]);
+                return writeMetricsChunk(cursor, buffer, maxLen);
+            });
+        request->send(response);
+    });
+
     server->on("/api/settings", HTTP_POST, [](AsyncWebServerRequest *request) {
+        LatencyScope latency(endpointLatency[ENDPOINT_SETTINGS]);
+        HeapScope heapScope(HEAP_API);
         for (int i = 0; i < request->params(); i++) {
             const AsyncWebParameter* p = request->getParam(i);
             if (!p->isPost()) continue;
@@ -1142,6 +1094,10 @@ void setup() {
             // Note: WiFi credentials are now managed by WiFiManager
             // To change WiFi, reset the device and reconfigure through the portal
             if (strcmp(paramName, "gmt_offset") == 0) gmt_offset = atoi(paramValue);
+            else if (strcmp(paramName, "coalesce_window") == 0) {
+                int window = atoi(paramValue);
+                if (window >= 0 && window <= MAX_COALESCE_WINDOW) coalesce_window = window;
+            }
             else {
                 const char* lastUnderscore = strrchr(paramName, '_');
                 if (lastUnderscore == NULL) continue;
@@ -1157,8 +1113,18 @@ void setup() {
                     if (strcmp(settingNameBuf, "server_name") == 0) safeStrcpy(targets[serverIndex].server_name, paramValue, sizeof(targets[serverIndex].server_name));
                     else if (strcmp(settingNameBuf, "weburl") == 0) safeStrcpy(targets[serverIndex].weburl, paramValue, sizeof(targets[serverIndex].weburl));
                     else if (strcmp(settingNameBuf, "check_interval") == 0) targets[serverIndex].check_interval_seconds = atoi(paramValue);
+                    else if (strcmp(settingNameBuf, "retry_interval") == 0) targets[serverIndex].retry_interval_seconds = atoi(paramValue);
+                    else if (strcmp(settingNameBuf, "max_check_interval") == 0) targets[serverIndex].max_check_interval_seconds = atoi(paramValue);
+                    else if (strcmp(settingNameBuf, "parent") == 0) {
+                        int parent = atoi(paramValue);
+                        if (parent >= -1 && parent < NUM_TARGETS && parent != serverIndex) targets[serverIndex].parent_id = parent;
+                    }
                     else if (strcmp(settingNameBuf, "failure_threshold") == 0) targets[serverIndex].failure_threshold = atoi(paramValue);
                     else if (strcmp(settingNameBuf, "recovery_threshold") == 0) targets[serverIndex].recovery_threshold = atoi(paramValue);
+                    else if (strcmp(settingNameBuf, "latency_threshold") == 0) targets[serverIndex].latency_threshold_ms = atoi(paramValue);
+                    else if (strcmp(settingNameBuf, "latency_deviations") == 0) targets[serverIndex].latency_deviations = atoi(paramValue);
+                    else if (strcmp(settingNameBuf, "latency_slow_checks") == 0) targets[serverIndex].latency_slow_checks = atoi(paramValue);
+                    else if (strcmp(settingNameBuf, "latency_recovery_checks") == 0) targets[serverIndex].latency_recovery_checks = atoi(paramValue);
                     else if (strcmp(settingNameBuf, "online_message") == 0) safeStrcpy(targets[serverIndex].online_message, paramValue, sizeof(targets[serverIndex].online_message));
                     else if (strcmp(settingNameBuf, "offline_message") == 0) safeStrcpy(targets[serverIndex].offline_message, paramValue, sizeof(targets[serverIndex].offline_message));
                     else if (strcmp(settingNameBuf, "discord_webhook") == 0) safeStrcpy(targets[serverIndex].discord_webhook_url, paramValue, sizeof(targets[serverIndex].discord_webhook_url));
@@ -1177,40 +1143,30 @@ void setup() {
             }
         }
         saveConfig();
+        saveUptimeStats();
+        alertQueueFlush();
         request->send(200, "text/plain", "OK");
         delay(1000);
         ESP.restart();
     });
 
+    // GET /api/groups/summary - Per-group up/down counts and latency
+    // (registered before /api/groups, which would also match this path)
+    server->on("/api/groups/summary", HTTP_GET, [](AsyncWebServerRequest *request) {
+        LatencyScope latency(endpointLatency[ENDPOINT_GROUPS_SUMMARY]);
+        HeapScope heapScope(HEAP_API);
+        ApiResponse * response = newApiResponse(request, false, GROUPS_SUMMARY_JSON_CAPACITY);
+        buildGroupsSummaryJson(response->getRoot());
+
+        response->setLength();
+        request->send(response);
+    });
+
     // GET /api/groups - Get list of unique groups
     server->on("/api/groups", HTTP_GET, [](AsyncWebServerRequest *request) {
-        AsyncJsonResponse * response = new AsyncJsonResponse();
-        JsonArray groups = response->getRoot().to<JsonArray>();
-
-        // Collect unique group names
-        String uniqueGroups[NUM_TARGETS];
-        int groupCount = 0;
-
-        for (int i = 0; i < NUM_TARGETS; i++) {
-            if (!targets[i].enabled) continue;
-
-            String groupName = String(targets[i].group_name);
-            bool found = false;
-            for (int j = 0; j < groupCount; j++) {
-                if (uniqueGroups[j] == groupName) {
-                    found = true;
-                    break;
-                }
-            }
-            if (!found && groupCount < NUM_TARGETS) {
-                uniqueGroups[groupCount++] = groupName;
-            }
-        }
-
-        // Add to JSON array
-        for (int i = 0; i < groupCount; i++) {
-            groups.add(uniqueGroups[i]);
-        }
+        LatencyScope latency(endpointLatency[ENDPOINT_GROUPS]);
+        ApiResponse * response = newApiResponse(request, false, DYNAMIC_JSON_DOCUMENT_SIZE);
+        buildGroupsJson(response->getRoot().to<JsonArray>());
 
         response->setLength();
         request->send(response);
@@ -1219,33 +1175,19 @@ void setup() {
     // POST /api/server/add - Add new server
     server->on("/api/server/add", HTTP_POST, [](AsyncWebServerRequest *request) {}, NULL,
         [](AsyncWebServerRequest *request, uint8_t *data, size_t len, size_t index, size_t total) {
-            if (index == 0) {
+            LatencyScope latency(endpointLatency[ENDPOINT_SERVER_ADD]);
+            char* body = collectBody(request, data, len, index, total);
+            if (body) {
+                HeapScope heapScope(HEAP_API);
                 DynamicJsonDocument json(1024);
-                if (deserializeJson(json, (char*)data) == DeserializationError::Ok) {
-                    // Find first available slot
+                if (deserializeJson(json, body, total) == DeserializationError::Ok) {
                     int slot = -1;
-                    for (int i = 0; i < NUM_TARGETS; i++) {
-                        if (!targets[i].enabled && strlen(targets[i].weburl) <= 1) {
-                            slot = i;
-                            break;
-                        }
-                    }
-
-                    if (slot >= 0) {
-                        safeStrcpy(targets[slot].server_name, json["name"] | "", sizeof(targets[slot].server_name));
-                        safeStrcpy(targets[slot].group_name, json["group"] | "Default", sizeof(targets[slot].group_name));
-                        safeStrcpy(targets[slot].weburl, json["url"] | "0", sizeof(targets[slot].weburl));
-                        targets[slot].enabled = true;
-                        targets[slot].check_interval_seconds = json["check_interval"] | 60;
-                        targets[slot].failure_threshold = json["failure_threshold"] | 3;
-                        targets[slot].recovery_threshold = json["recovery_threshold"] | 2;
-                        safeStrcpy(targets[slot].online_message, json["online_message"] | "{NAME} is back online!", sizeof(targets[slot].online_message));
-                        safeStrcpy(targets[slot].offline_message, json["offline_message"] | "{NAME} is down!", sizeof(targets[slot].offline_message));
-
+                    const char* error = addTargetFromJson(json.as<JsonObjectConst>(), &slot);
+                    if (!error) {
                         saveConfig();
                         request->send(200, "application/json", "{\"success\":true,\"id\":" + String(slot) + "}");
                     } else {
-                        request->send(400, "application/json", "{\"success\":false,\"error\":\"No available slots\"}");
+                        request->send(400, "application/json", "{\"success\":false,\"error\":\"" + String(error) + "\"}");
                     }
                 } else {
                     request->send(400, "application/json", "{\"success\":false,\"error\":\"Invalid JSON\"}");
@@ -1256,17 +1198,18 @@ void setup() {
     // POST /api/server/delete - Delete (disable) server
     server->on("/api/server/delete", HTTP_POST, [](AsyncWebServerRequest *request) {}, NULL,
         [](AsyncWebServerRequest *request, uint8_t *data, size_t len, size_t index, size_t total) {
-            if (index == 0) {
+            LatencyScope latency(endpointLatency[ENDPOINT_SERVER_DELETE]);
+            char* body = collectBody(request, data, len, index, total);
+            if (body) {
+                HeapScope heapScope(HEAP_API);
                 DynamicJsonDocument json(256);
-                if (deserializeJson(json, (char*)data) == DeserializationError::Ok) {
-                    int id = json["id"] | -1;
-                    if (id >= 0 && id < NUM_TARGETS) {
-                        targets[id].enabled = false;
-                        strcpy(targets[id].weburl, "0");
+                if (deserializeJson(json, body, total) == DeserializationError::Ok) {
+                    const char* error = deleteTarget(json["id"] | -1);
+                    if (!error) {
                         saveConfig();
                         request->send(200, "application/json", "{\"success\":true}");
                     } else {
-                        request->send(400, "application/json", "{\"success\":false,\"error\":\"Invalid server ID\"}");
+                        request->send(400, "application/json", "{\"success\":false,\"error\":\"" + String(error) + "\"}");
                     }
                 } else {
                     request->send(400, "application/json", "{\"success\":false,\"error\":\"Invalid JSON\"}");
@@ -1277,34 +1220,51 @@ void setup() {
     // POST /api/server/update - Update server configuration
     server->on("/api/server/update", HTTP_POST, [](AsyncWebServerRequest *request) {}, NULL,
         [](AsyncWebServerRequest *request, uint8_t *data, size_t len, size_t index, size_t total) {
-            if (index == 0) {
+            LatencyScope latency(endpointLatency[ENDPOINT_SERVER_UPDATE]);
+            char* body = collectBody(request, data, len, index, total);
+            if (body) {
+                HeapScope heapScope(HEAP_API);
                 DynamicJsonDocument json(2048);
-                if (deserializeJson(json, (char*)data) == DeserializationError::Ok) {
-                    int id = json["id"] | -1;
-                    if (id >= 0 && id < NUM_TARGETS) {
-                        if (json.containsKey("name")) safeStrcpy(targets[id].server_name, json["name"], sizeof(targets[id].server_name));
-                        if (json.containsKey("group")) safeStrcpy(targets[id].group_name, json["group"], sizeof(targets[id].group_name));
-                        if (json.containsKey("url")) safeStrcpy(targets[id].weburl, json["url"], sizeof(targets[id].weburl));
-                        if (json.containsKey("enabled")) targets[id].enabled = json["enabled"];
-                        if (json.containsKey("check_interval")) targets[id].check_interval_seconds = json["check_interval"];
-                        if (json.containsKey("failure_threshold")) targets[id].failure_threshold = json["failure_threshold"];
-                        if (json.containsKey("recovery_threshold")) targets[id].recovery_threshold = json["recovery_threshold"];
-                        if (json.containsKey("online_message")) safeStrcpy(targets[id].online_message, json["online_message"], sizeof(targets[id].online_message));
-                        if (json.containsKey("offline_message")) safeStrcpy(targets[id].offline_message, json["offline_message"], sizeof(targets[id].offline_message));
-                        if (json.containsKey("discord_webhook")) safeStrcpy(targets[id].discord_webhook_url, json["discord_webhook"], sizeof(targets[id].discord_webhook_url));
-                        if (json.containsKey("ntfy_url")) safeStrcpy(targets[id].ntfy_url, json["ntfy_url"], sizeof(targets[id].ntfy_url));
-                        if (json.containsKey("ntfy_priority")) safeStrcpy(targets[id].ntfy_priority, json["ntfy_priority"], sizeof(targets[id].ntfy_priority));
-                        if (json.containsKey("telegram_bot_token")) safeStrcpy(targets[id].telegram_bot_token, json["telegram_bot_token"], sizeof(targets[id].telegram_bot_token));
-                        if (json.containsKey("telegram_chat_id_1")) safeStrcpy(targets[id].telegram_chat_id_1, json["telegram_chat_id_1"], sizeof(targets[id].telegram_chat_id_1));
-                        if (json.containsKey("telegram_chat_id_2")) safeStrcpy(targets[id].telegram_chat_id_2, json["telegram_chat_id_2"], sizeof(targets[id].telegram_chat_id_2));
-                        if (json.containsKey("telegram_chat_id_3")) safeStrcpy(targets[id].telegram_chat_id_3, json["telegram_chat_id_3"], sizeof(targets[id].telegram_chat_id_3));
-                        if (json.containsKey("http_get_url_on")) safeStrcpy(targets[id].http_get_url_on, json["http_get_url_on"], sizeof(targets[id].http_get_url_on));
-                        if (json.containsKey("http_get_url_off")) safeStrcpy(targets[id].http_get_url_off, json["http_get_url_off"], sizeof(targets[id].http_get_url_off));
+                if (deserializeJson(json, body, total) == DeserializationError::Ok) {
+                    const char* error = updateTargetFromJson(json.as<JsonObjectConst>());
+                    if (!error) {
+                        saveConfig();
+                        request->send(200, "application/json", "{\"success\":true}");
+                    } else {
+                        request->send(400, "application/json", "{\"success\":false,\"error\":\"" + String(error) + "\"}");
+                    }
+                } else {
+                    request->send(400, "application/json", "{\"success\":false,\"error\":\"Invalid JSON\"}");
+                }
+            }
+        });
+
+    // GET /api/federation - Peers, notifier election and per-target votes
+    server->on("/api/federation", HTTP_GET, [](AsyncWebServerRequest *request) {
+        LatencyScope latency(endpointLatency[ENDPOINT_FEDERATION]);
+        HeapScope heapScope(HEAP_API);
+        ApiResponse * response = newApiResponse(request, false, FEDERATION_JSON_CAPACITY);
+        buildFederationJson(response->getRoot());
+
+        response->setLength();
+        request->send(response);
+    });
 
+    // POST /api/federation - Set node id, port, quorum and peers (applied by the next loop pass)
+    server->on("/api/federation", HTTP_POST, [](AsyncWebServerRequest *request) {}, NULL,
+        [](AsyncWebServerRequest *request, uint8_t *data, size_t len, size_t index, size_t total) {
+            LatencyScope latency(endpointLatency[ENDPOINT_FEDERATION_UPDATE]);
+            char* body = collectBody(request, data, len, index, total);
+            if (body) {
+                HeapScope heapScope(HEAP_API);
+                DynamicJsonDocument json(1024);
+                if (deserializeJson(json, body, total) == DeserializationError::Ok) {
+                    const char* error = setFederationFromJson(json.as<JsonObjectConst>());
+                    if (!error) {
                         saveConfig();
                         request->send(200, "application/json", "{\"success\":true}");
                     } else {
-                        request->send(400, "application/json", "{\"success\":false,\"error\":\"Invalid server ID\"}");
+                        request->send(400, "application/json", "{\"success\":false,\"error\":\"" + String(error) + "\"}");
                     }
                 } else {
                     request->send(400, "application/json", "{\"success\":false,\"error\":\"Invalid JSON\"}");
@@ -1312,22 +1272,106 @@ void setup() {
             }
         });
 
+    // GET /api/metrics/push - Batches sent, backlog on flash, last collector status
+    server->on("/api/metrics/push", HTTP_GET, [](AsyncWebServerRequest *request) {
+        LatencyScope latency(endpointLatency[ENDPOINT_METRICS_PUSH]);
+        ApiResponse * response = newApiResponse(request, false, 1024);
+        buildMetricsPushJson(response->getRoot());
+
+        response->setLength();
+        request->send(response);
+    });
+
+    // POST /api/metrics/push - Set the line protocol endpoint, interval and batch size
+    server->on("/api/metrics/push", HTTP_POST, [](AsyncWebServerRequest *request) {}, NULL,
+        [](AsyncWebServerRequest *request, uint8_t *data, size_t len, size_t index, size_t total) {
+            LatencyScope latency(endpointLatency[ENDPOINT_METRICS_PUSH_UPDATE]);
+            char* body = collectBody(request, data, len, index, total);
+            if (body) {
+                HeapScope heapScope(HEAP_API);
+                DynamicJsonDocument json(1024);
+                if (deserializeJson(json, body, total) == DeserializationError::Ok) {
+                    const char* error = setMetricsPushFromJson(json.as<JsonObjectConst>());
+                    if (!error) {
+                        saveConfig();
+                        request->send(200, "application/json", "{\"success\":true}");
+                    } else {
+                        request->send(400, "application/json", "{\"success\":false,\"error\":\"" + String(error) + "\"}");
+                    }
+                } else {
+                    request->send(400, "application/json", "{\"success\":false,\"error\":\"Invalid JSON\"}");
+                }
+            }
+        });
+
+    // GET /api/alerts/queue - Alerts waiting for a channel to come back, and replay counters
+    server->on("/api/alerts/queue", HTTP_GET, [](AsyncWebServerRequest *request) {
+        LatencyScope latency(endpointLatency[ENDPOINT_ALERT_QUEUE]);
+        ApiResponse * response = newApiResponse(request, false, ALERT_QUEUE_JSON_CAPACITY);
+        buildAlertQueueJson(response->getRoot());
+
+        response->setLength();
+        request->send(response);
+    });
+
+    // POST /api/targets/batch - Apply a streamed array of add/update/delete operations, then save once.
+    // Operations are applied as they are parsed, so when the array turns out malformed the ones
+    // before the error stay applied and are saved: the answer is then 200 with applied/failed and
+    // "error" (resend from element applied + failed), and 400 only when nothing was applied
+    server->on("/api/targets/batch", HTTP_POST, [](AsyncWebServerRequest *request) {}, NULL,
+        [](AsyncWebServerRequest *request, uint8_t *data, size_t len, size_t index, size_t total) {
+            LatencyScope latency(endpointLatency[ENDPOINT_TARGETS_BATCH]);
+            HeapScope heapScope(HEAP_API);
+            if (index == 0) {
+                request->_tempObject = malloc(sizeof(TargetBatch));
+                if (!request->_tempObject) {
+                    request->send(500, "application/json", "{\"success\":false,\"error\":\"Out of memory\"}");
+                    return;
+                }
+                batchBegin(*(TargetBatch*)request->_tempObject);
+            }
+            TargetBatch* batch = (TargetBatch*)request->_tempObject;
+            if (!batch) return;
+
+            batchFeed(*batch, (const char*)data, len);
+            if (index + len < total) return;
+
+            const char* error = batchFinish(*batch);
+            if (batch->applied > 0) saveConfig();
+            AsyncJsonResponse * response = new AsyncJsonResponse(false, 1024 + 16 * NUM_TARGETS);
+            buildBatchResultJson(*batch, response->getRoot());
+            response->setCode(error && batch->applied == 0 ? 400 : 200);
+            response->setLength();
+            request->send(response);
+        });
+
+    // GET /api/targets/export - Stream every configured target as a batch-compatible array
+    server->on("/api/targets/export", HTTP_GET, [](AsyncWebServerRequest *request) {
+        LatencyScope latency(endpointLatency[ENDPOINT_TARGETS_EXPORT]);
+        TargetExportCursor cursor;
+        exportBegin(cursor);
+        AsyncWebServerResponse* response = request->beginChunkedResponse("application/json",
+            [cursor](uint8_t *buffer, size_t maxLen, size_t index) mutable -> size_t {
+                LatencyScope latency(endpointLatency[ENDPOINT_TARGETS_EXPORT]);
+                return writeTargetExportChunk(cursor, buffer, maxLen);
+            });
+        response->addHeader("Content-Disposition", "attachment; filename=\"targets.json\"");
+        request->send(response);
+    });
+
     // POST /api/group/rename - Rename a group across all servers
     server->on("/api/group/rename", HTTP_POST, [](AsyncWebServerRequest *request) {}, NULL,
         [](AsyncWebServerRequest *request, uint8_t *data, size_t len, size_t index, size_t total) {
-            if (index == 0) {
+            LatencyScope latency(endpointLatency[ENDPOINT_GROUP_RENAME]);
+            char* body = collectBody(request, data, len, index, total);
+            if (body) {
+                HeapScope heapScope(HEAP_API);
                 DynamicJsonDocument json(256);
-                if (deserializeJson(json, (char*)data) == DeserializationError::Ok) {
+                if (deserializeJson(json, body, total) == DeserializationError::Ok) {
                     const char* oldName = json["old_name"];
                     const char* newName = json["new_name"];
                     if (oldName && newName) {
-                        int updated = 0;
-                        for (int i = 0; i < NUM_TARGETS; i++) {
-                            if (strcmp(targets[i].group_name, oldName) == 0) {
-                                safeStrcpy(targets[i].group_name, newName, sizeof(targets[i].group_name));
-                                updated++;
-                            }
-                        }
+                        int updated = renameGroup(oldName, newName);
                         saveConfig();
                         request->send(200, "application/json", "{\"success\":true,\"updated\":" + String(updated) + "}");
                     } else {
@@ -1339,25 +1383,95 @@ void setup() {
             }
         });
 
+    // GET /api/ota - Pull OTA progress: state, bytes, throughput, error
+    server->on("/api/ota", HTTP_GET, [](AsyncWebServerRequest *request) {
+        LatencyScope latency(endpointLatency[ENDPOINT_OTA]);
+        ApiResponse * response = newApiResponse(request, false, 1024);
+        buildOtaJson(response->getRoot());
+
+        response->setLength();
+        request->send(response);
+    });
+
+    // POST /api/ota/cancel - Abandon a running pull OTA
+    // (registered before POST /api/ota, which would also match this path)
+    server->on("/api/ota/cancel", HTTP_POST, [](AsyncWebServerRequest *request) {
+        LatencyScope latency(endpointLatency[ENDPOINT_OTA_CANCEL]);
+        if (cancelOta()) {
+            request->send(200, "application/json", "{\"success\":true}");
+        } else {
+            request->send(400, "application/json", "{\"success\":false,\"error\":\"No update in progress\"}");
+        }
+    });
+
+    // POST /api/ota - Fetch, verify and install firmware from a manifest URL while monitoring continues
+    server->on("/api/ota", HTTP_POST, [](AsyncWebServerRequest *request) {}, NULL,
+        [](AsyncWebServerRequest *request, uint8_t *data, size_t len, size_t index, size_t total) {
+            LatencyScope latency(endpointLatency[ENDPOINT_OTA_START]);
+            char* body = collectBody(request, data, len, index, total);
+            if (body) {
+                HeapScope heapScope(HEAP_API);
+                DynamicJsonDocument json(1024);
+                if (otaInProgress() || otaPushActive()) {
+                    request->send(409, "application/json", "{\"success\":false,\"error\":\"Update already in progress\"}");
+                } else if (deserializeJson(json, body, total) == DeserializationError::Ok) {
+                    const char* error = startOtaFromJson(json.as<JsonObjectConst>());
+                    if (!error) {
+                        request->send(200, "application/json", "{\"success\":true}");
+                    } else {
+                        request->send(400, "application/json", "{\"success\":false,\"error\":\"" + String(error) + "\"}");
+                    }
+                } else {
+                    request->send(400, "application/json", "{\"success\":false,\"error\":\"Invalid JSON\"}");
+                }
+            }
+        });
+
     server->on("/update", HTTP_GET, [](AsyncWebServerRequest *request) {
         request->send(200, "text/html", FPSTR(UPDATE_HTML));
     });
     
+    // Upload that holds the update partition (see otaPushBegin()); others get 409
+    static AsyncWebServerRequest* firmwareUpload = nullptr;
+
     server->on("/updatefirmware", HTTP_POST, 
         [](AsyncWebServerRequest *request) {
-            request->send(200, "text/plain", (Update.hasError()) ? "FAIL" : "OK");
+            if (request != firmwareUpload) {
+                request->send(409, "text/plain", "Update already in progress");
+                return;
+            }
+            bool failed = Update.hasError();
+            if (failed) {
+                firmwareUpload = nullptr;
+                otaPushEnd();
+            }
+            request->send(200, "text/plain", failed ? "FAIL" : "OK");
         }, 
         [](AsyncWebServerRequest *request, String filename, size_t index, uint8_t *data, size_t len, bool final) {
             if (!index) {
+                if (!otaPushBegin()) {
+                    web_log_printf("Update refused: another update is in progress");
+                    return;
+                }
+                firmwareUpload = request;
+                request->onDisconnect([request]() {
+                    if (firmwareUpload != request) return;
+                    if (Update.isRunning()) Update.abort();
+                    firmwareUpload = nullptr;
+                    otaPushEnd();
+                });
                 web_log_printf("Update Start: %s", filename.c_str());
                 if (!Update.begin(UPDATE_SIZE_UNKNOWN)) Update.printError(Serial);
             }
+            if (request != firmwareUpload) return;
             if (len) {
                 if (Update.write(data, len) != len) Update.printError(Serial);
             }
             if (final) {
                 if (Update.end(true)) {
                     web_log_printf("Update Success: %u bytes", index + len);
+                    saveUptimeStats();
+                    alertQueueFlush();
                     // Config migration handled by setup() on next boot
                     delay(1000);
                     ESP.restart();
@@ -1378,114 +1492,14 @@ void setup() {
 
     server->begin();
     web_log_printf("Web server started on port 80");
+    federationBegin();
     web_log_printf("==========================================");
+    webLogFlush();
 }
 
 
-void loop() {
-    manageWifiConnection();
-
-    // Heap monitoring for diagnostics (every 60 seconds)
-    static unsigned long lastHeapCheck = 0;
-    if (millis() - lastHeapCheck > 60000) {
-        uint32_t freeHeap = ESP.getFreeHeap();
-        uint32_t minHeap = ESP.getMinFreeHeap();
-        uint32_t maxBlock = ESP.getMaxAllocHeap();
-        int fragmentation = 100 - ((maxBlock * 100) / freeHeap);
-        web_log_printf("Heap - Free: %lu, Min: %lu, MaxBlock: %lu, Frag: %d%%",
-            freeHeap, minHeap, maxBlock, fragmentation);
-        lastHeapCheck = millis();
-    }
-
-    if (WiFi.status() == WL_CONNECTED) {
-        // Time-distributed check: Check ONE server per loop iteration
-        // This reduces peak memory usage and prevents heap exhaustion
-        int checks_attempted = 0;
-
-        // Find next enabled server that's due for a check
-        while (checks_attempted < NUM_TARGETS) {
-            int i = current_check_index;
-
-            // Skip disabled servers
-            if (!targets[i].enabled || strcmp(targets[i].weburl, "0") == 0 || strlen(targets[i].weburl) < 10) {
-                httpCode[i] = 0;
-                current_check_index = (current_check_index + 1) % NUM_TARGETS;
-                checks_attempted++;
-                continue;
-            }
-
-            // Check if enough time has elapsed since last check (skip if not ready)
-            // Allow immediate check on first boot (when last_check_time[i] == 0)
-            if (last_check_time[i] > 0 && millis() - last_check_time[i] < (targets[i].check_interval_seconds * 1000)) {
-                current_check_index = (current_check_index + 1) % NUM_TARGETS;
-                checks_attempted++;
-                continue;
-            }
-
-            // Perform the check
-            last_check_time[i] = millis();
-
-            HTTPClient http;
-            http.setFollowRedirects(HTTPC_STRICT_FOLLOW_REDIRECTS);
-            http.setTimeout(5000);  // 5 second timeout to prevent blocking AsyncWebServer
-            http.begin(targets[i].weburl);
-            unsigned long singleStartTime = millis();
-            int currentHttpCode = http.GET();
-            unsigned long singleEndTime = millis();
-            http.end();
-
-            pingTime[i] = singleEndTime - singleStartTime;
-            httpCode[i] = currentHttpCode;
-            updatePingStats(i);
-
-            bool isOnline = (httpCode[i] >= 200 && httpCode[i] < 400);
-
-            if (isOnline) {
-                failure_count[i] = 0;
-                success_count[i]++;
-                if (confirmed_online_state[i] == false && success_count[i] >= targets[i].recovery_threshold) {
-                    confirmed_online_state[i] = true;
-
-                    String message = targets[i].online_message;
-                    message.replace("{NAME}", targets[i].server_name);
-                    message.replace("{URL}", targets[i].weburl);
-
-                    char timeBuf[30], logEntry[64];
-                    getFormattedTime(timeBuf, sizeof(timeBuf));
-                    snprintf(logEntry, sizeof(logEntry), "on;%s\n", timeBuf);
-
-                    sendNotifications(i, message.c_str());
-                    sendCustomHttpRequest(targets[i].http_get_url_on);
-                    prependToLog(targetLogMessages[i], logEntry, TARGET_LOG_SIZE);
-                }
-            } else {
-                success_count[i] = 0;
-                failure_count[i]++;
-                if (confirmed_online_state[i] == true && failure_count[i] >= targets[i].failure_threshold) {
-                    confirmed_online_state[i] = false;
-
-                    String message = targets[i].offline_message;
-                    message.replace("{NAME}", targets[i].server_name);
-                    message.replace("{URL}", targets[i].weburl);
-                    message.replace("{CODE}", String(httpCode[i]));
-
-                    char timeBuf[30], logEntry[64];
-                    getFormattedTime(timeBuf, sizeof(timeBuf));
-                    snprintf(logEntry, sizeof(logEntry), "off;%s\n", timeBuf);
-
-                    sendNotifications(i, message.c_str());
-                    sendCustomHttpRequest(targets[i].http_get_url_off);
-                    prependToLog(targetLogMessages[i], logEntry, TARGET_LOG_SIZE);
-                }
-            }
-            web_log_printf("[Server %d] URL: %s, Status: %d, Ping: %lu ms, Fails: %d, Successes: %d",
-                i + 1, targets[i].weburl, httpCode[i], pingTime[i], failure_count[i], success_count[i]);
-
-            // Move to next server and break out of while loop
-            current_check_index = (current_check_index + 1) % NUM_TARGETS;
-            break;  // Only check one server per loop iteration
-        }
-    }
 
+void loop() {
+    monitorLoop();
     delay(100);  // Small delay before next loop iteration
 }
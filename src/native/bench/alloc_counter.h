@@ -0,0 +1,13 @@
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+
+// Process-wide heap allocation counters, fed by malloc/calloc/realloc
+// interposers in alloc_counter.cpp (glibc only).
+struct AllocSnapshot {
+    uint64_t allocations;
+    uint64_t bytes;
+};
+
+AllocSnapshot alloc_snapshot();
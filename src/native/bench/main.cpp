@@ -0,0 +1,493 @@
+// Host-side microbenchmarks for the firmware hot paths.
+//
+// Measures time, heap allocations and allocated bytes per operation for the
+// /api/status, /api/groups/summary and /metrics serializers, bulk export/import,
+// line protocol batches for the metrics push, config load/save, log helpers,
+// message templating and the latency baseline, plus the status snapshot
+// hit rate under simulated dashboard polling. The slot count is a build
+// flag, so each of the native_bench* environments covers one size (20, 100,
+// 500 targets).
+//
+//   pio run -e native_bench && .pio/build/native_bench/program --output bench.json
+//
+// Results are emitted as JSON so runs from different commits can be diffed
+// (see scripts/run_benchmarks.sh and scripts/compare_benchmarks.py).
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include <string>
+#include <vector>
+
+#include <ArduinoJson.h>
+
+#include "../hal/hal_posix.h"
+#include "alloc_counter.h"
+#include "api_encoding.h"
+#include "group_index.h"
+#include "latency_baseline.h"
+#include "metrics.h"
+#include "metrics_push.h"
+#include "monitor_config.h"
+#include "monitor_hal.h"
+#include "monitor_state.h"
+#include "notifications.h"
+#include "ota_pull.h"
+#include "sha256.h"
+#include "status_api.h"
+#include "status_snapshot.h"
+#include "target_bulk.h"
+#include "text_util.h"
+#include "web_log.h"
+
+// Keeps results observable so the compiler cannot drop the work
+static volatile size_t sink;
+
+static uint64_t nowNs() {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ULL + ts.tv_nsec;
+}
+
+// --- Fixtures ---
+
+static const char* SAMPLE_MESSAGE = "🚨 Production API Gateway OUTAGE: https://api.example.com/v1/health?probe=esp32 (Code: -11) & retrying";
+static char logScratch[TARGET_LOG_SIZE];
+static std::vector<char> serializeBuffer;
+
+// Fill every slot with realistic, fully populated configuration and state
+static void populateTargets() {
+    for (int i = 0; i < NUM_TARGETS; i++) {
+        TargetConfig& t = targets[i];
+        snprintf(t.server_name, sizeof(t.server_name), "Server %d", i + 1);
+        snprintf(t.group_name, sizeof(t.group_name), "Group %d", i % 8);
+        snprintf(t.weburl, sizeof(t.weburl), "http://10.0.%d.%d:8080/health", i / 250, i % 250 + 1);
+        snprintf(t.discord_webhook_url, sizeof(t.discord_webhook_url), "https://discord.com/api/webhooks/1234567890/abcdefghijklmnopqrstuvwxyz%d", i);
+        snprintf(t.ntfy_url, sizeof(t.ntfy_url), "https://ntfy.sh/uptime-monitor-%d", i);
+        strcpy(t.ntfy_priority, "high");
+        strcpy(t.telegram_bot_token, "123456789:AAHdqTcvCH1vGWJxfSeofSAs0K5PALDsaw");
+        strcpy(t.telegram_chat_id_1, "-1001234567890");
+        strcpy(t.telegram_chat_id_2, "0");
+        strcpy(t.telegram_chat_id_3, "0");
+        strcpy(t.http_get_url_on, "0");
+        strcpy(t.http_get_url_off, "0");
+        safeStrcpy(t.online_message, "✅ {NAME} is back online: {URL}", sizeof(t.online_message));
+        safeStrcpy(t.offline_message, "🚨 {NAME} OUTAGE: {URL} (Code: {CODE})", sizeof(t.offline_message));
+        t.check_interval_seconds = 60;
+        t.failure_threshold = 3;
+        t.recovery_threshold = 2;
+        t.parent_id = -1;
+        t.enabled = true;
+        compileMessageTemplates(i);
+
+        httpCode[i] = (i % 7 == 0) ? -11 : 200;
+        confirmed_online_state[i] = i % 7 != 0;
+        local_down[i] = !confirmed_online_state[i];
+        pingTime[i] = 40 + i % 200;
+        minpingTime[i] = 20;
+        maxpingTime[i] = 900;
+        total_checks[i] = 10000 + i;
+        total_failures[i] = i;
+
+        targetLogMessages[i][0] = '\0';
+        for (int e = 0; e < 10; e++) {
+            prependToLog(targetLogMessages[i], (e % 2) ? "on;2025-11-17 08:31:08\n" : "off;2025-11-17 08:29:41\n", TARGET_LOG_SIZE);
+        }
+    }
+    groupIndexRebuild();
+}
+
+static void setupSerializeBuffer() {
+    serializeBuffer.resize(4096UL * NUM_TARGETS);
+}
+
+static void setupSavedConfig() {
+    saveConfig();
+}
+
+static void setupFullLog() {
+    memset(logScratch, 'x', sizeof(logScratch) - 1);
+    logScratch[sizeof(logScratch) - 1] = '\0';
+}
+
+// --- Benchmarks ---
+
+// Same work as the /api/status handler: build the document, measure, serialize
+static void benchStatusSerialize() {
+    DynamicJsonDocument doc(STATUS_JSON_CAPACITY);
+    buildStatusJson(doc.to<JsonObject>());
+    size_t len = measureJson(doc);
+    sink = len + serializeJson(doc, serializeBuffer.data(), serializeBuffer.size());
+}
+
+// Writes into serializeBuffer (the ArduinoJson char* overload is JSON only)
+struct BufferWriter {
+    size_t pos;
+    size_t write(uint8_t c) { serializeBuffer[pos++] = c; return 1; }
+    size_t write(const uint8_t* s, size_t n) { memcpy(&serializeBuffer[pos], s, n); pos += n; return n; }
+};
+
+// /api/status negotiated to CBOR / MessagePack: same document, binary encoder
+static void benchStatusEncoded(ApiFormat format) {
+    DynamicJsonDocument doc(STATUS_JSON_CAPACITY);
+    buildStatusJson(doc.to<JsonObject>());
+    size_t len = measureApiDocument(doc.as<JsonVariantConst>(), format);
+    BufferWriter writer = {0};
+    sink = len + serializeApiDocument(doc.as<JsonVariantConst>(), format, writer);
+}
+
+static void benchStatusCbor() {
+    benchStatusEncoded(API_FORMAT_CBOR);
+}
+
+static void benchStatusMsgPack() {
+    benchStatusEncoded(API_FORMAT_MSGPACK);
+}
+
+// Unfiltered poll while nothing changed: copy the shared snapshot out
+static void benchStatusSnapshotHit() {
+    std::shared_ptr<const StatusSnapshot> snapshot = statusSnapshot(API_FORMAT_JSON);
+    memcpy(serializeBuffer.data(), snapshot->data, snapshot->length);
+    sink = snapshot->length;
+}
+
+// First poll after a check result: rebuild the snapshot
+static void benchStatusSnapshotRebuild() {
+    statusChanged();
+    sink = statusSnapshot(API_FORMAT_JSON)->length;
+}
+
+// Wallboard query: names and codes of the confirmed-offline targets
+static StatusFilter downFilter;
+
+static void setupDownFilter() {
+    setupSerializeBuffer();
+    parseStatusFilter(downFilter, nullptr, "down", nullptr, "http_code,config.server_name");
+}
+
+static void benchStatusFiltered() {
+    DynamicJsonDocument doc(statusJsonCapacity(downFilter));
+    buildStatusJson(doc.to<JsonObject>(), downFilter);
+    size_t len = measureJson(doc);
+    sink = len + serializeJson(doc, serializeBuffer.data(), serializeBuffer.size());
+}
+
+static void benchGroupsSerialize() {
+    DynamicJsonDocument doc(1024 + 64UL * NUM_TARGETS);
+    buildGroupsJson(doc.to<JsonArray>());
+    sink = serializeJson(doc, serializeBuffer.data(), serializeBuffer.size());
+}
+
+// Every member was checked since the last request, so all aggregates are
+// recomputed (the worst case for /api/groups/summary)
+static void benchGroupsSummary() {
+    for (int i = 0; i < NUM_TARGETS; i++) groupIndexNoteResult(i, false);
+    DynamicJsonDocument doc(GROUPS_SUMMARY_JSON_CAPACITY);
+    buildGroupsSummaryJson(doc.to<JsonObject>());
+    sink = serializeJson(doc, serializeBuffer.data(), serializeBuffer.size());
+}
+
+// Full /metrics scrape in TCP-sized chunks
+static void benchMetricsScrape() {
+    MetricsCursor cursor;
+    metricsBegin(cursor);
+    size_t total = 0, n;
+    while ((n = writeMetricsChunk(cursor, (uint8_t*)serializeBuffer.data(), 1436)) > 0) total += n;
+    sink = total;
+}
+
+// Full /api/targets/export stream in TCP-sized chunks
+static void benchTargetsExport() {
+    TargetExportCursor cursor;
+    exportBegin(cursor);
+    size_t total = 0, n;
+    while ((n = writeTargetExportChunk(cursor, (uint8_t*)serializeBuffer.data(), 1436)) > 0) total += n;
+    sink = total;
+}
+
+// The export re-imported through /api/targets/batch in TCP-sized segments
+// (parse and apply only; the handler's single saveConfig() is config_save)
+static std::vector<char> batchBody;
+static TargetBatch batch;
+
+static void setupBatchBody() {
+    TargetExportCursor cursor;
+    exportBegin(cursor);
+    uint8_t chunk[1436];
+    size_t n;
+    batchBody.clear();
+    while ((n = writeTargetExportChunk(cursor, chunk, sizeof(chunk))) > 0) batchBody.insert(batchBody.end(), chunk, chunk + n);
+}
+
+static void benchTargetsBatch() {
+    batchBegin(batch);
+    for (size_t pos = 0; pos < batchBody.size(); pos += 1436) {
+        size_t n = batchBody.size() - pos < 1436 ? batchBody.size() - pos : 1436;
+        batchFeed(batch, batchBody.data() + pos, n);
+    }
+    batchFinish(batch);
+    sink = batch.applied;
+}
+
+// One line protocol line per target, as a metrics push batch is formatted
+static void benchMetricsPushFormat() {
+    size_t total = 0;
+    for (int i = 0; i < NUM_TARGETS; i++) {
+        total += formatPushLine(serializeBuffer.data(), METRICS_PUSH_LINE_SIZE, i, httpCode[i], pingTime[i], 1763370000);
+    }
+    sink = total;
+}
+
+// One pull OTA chunk through the streaming SHA-256
+static void benchSha256Chunk() {
+    static uint8_t chunk[OTA_CHUNK_SIZE];
+    Sha256 ctx;
+    uint8_t digest[32];
+    sha256Begin(ctx);
+    sha256Update(ctx, chunk, sizeof(chunk));
+    sha256Finish(ctx, digest);
+    sink = digest[0];
+}
+
+static void benchConfigSave() {
+    saveConfig();
+}
+
+static void benchConfigLoad() {
+    loadConfig();
+}
+
+static void benchUrlEncode() {
+    char encoded[512];
+    urlEncode(encoded, SAMPLE_MESSAGE, sizeof(encoded));
+    sink = encoded[0];
+}
+
+static void benchPrependToLog() {
+    prependToLog(logScratch, "off;2025-11-17 08:31:08\n", sizeof(logScratch));
+    sink = logScratch[0];
+}
+
+// Caller's cost: the line is queued; every WEB_LOG_QUEUE_DEPTH-th call finds
+// the queue full and flushes it (wall-clock stamp, console, /api/logs buffer)
+static void benchWebLogPrintf() {
+    web_log_printf("[Server %d] URL: %s, Status: %d, Ping: %lu ms, Fails: %d, Successes: %d",
+        1, targets[0].weburl, httpCode[0], pingTime[0], failure_count[0], success_count[0]);
+    sink = serialLogBufferPos;
+}
+
+static void benchMessageTemplate() {
+    char message[NOTIFICATION_MESSAGE_SIZE];
+    sink = renderNotificationMessage(message, sizeof(message), 0, ALERT_OFFLINE, ESCAPE_NONE);
+}
+
+// Discord payload rendering, escaped for a JSON string
+static void benchMessageTemplateJson() {
+    char message[2 * NOTIFICATION_MESSAGE_SIZE];
+    sink = renderNotificationMessage(message, sizeof(message), 0, ALERT_OFFLINE, ESCAPE_JSON);
+}
+
+static void setupRichTemplate() {
+    safeStrcpy(targets[0].offline_message, "🚨 {NAME} ({GROUP}) \"DOWN\" since {DOWNTIME}: {URL} code {CODE}, {LATENCY} ms at {TIME}", sizeof(targets[0].offline_message));
+    compileMessageTemplates(0);
+}
+
+// Per-check cost of the latency baseline: judge against the limit, learn
+static void benchLatencyBaseline() {
+    static uint32_t ms = 80;
+    ms = ms * 1103515245u + 12345u;
+    uint32_t sample = 60 + (ms >> 16) % 50;
+    sink = latencySlowLimitMs(0) < sample;
+    latencyBaselineUpdate(latencyBaselines[0], sample);
+}
+
+static void setupLatencyBaseline() {
+    targets[0].latency_threshold_ms = 500;
+    targets[0].latency_deviations = 4;
+}
+
+struct Benchmark {
+    const char* name;
+    void (*setup)();
+    void (*run)();
+};
+
+static const Benchmark BENCHMARKS[] = {
+    {"status_serialize", setupSerializeBuffer, benchStatusSerialize},
+    {"status_cbor", setupSerializeBuffer, benchStatusCbor},
+    {"status_msgpack", setupSerializeBuffer, benchStatusMsgPack},
+    {"status_filtered", setupDownFilter, benchStatusFiltered},
+    {"status_snapshot_hit", setupSerializeBuffer, benchStatusSnapshotHit},
+    {"status_snapshot_rebuild", nullptr, benchStatusSnapshotRebuild},
+    {"groups_serialize", setupSerializeBuffer, benchGroupsSerialize},
+    {"groups_summary", setupSerializeBuffer, benchGroupsSummary},
+    {"metrics_scrape", setupSerializeBuffer, benchMetricsScrape},
+    {"targets_export", setupSerializeBuffer, benchTargetsExport},
+    {"targets_batch", setupBatchBody, benchTargetsBatch},
+    {"metrics_push_format", setupSerializeBuffer, benchMetricsPushFormat},
+    {"sha256_chunk", nullptr, benchSha256Chunk},
+    {"config_save", nullptr, benchConfigSave},
+    {"config_load", setupSavedConfig, benchConfigLoad},
+    {"url_encode", nullptr, benchUrlEncode},
+    {"prepend_to_log", setupFullLog, benchPrependToLog},
+    {"web_log_printf", nullptr, benchWebLogPrintf},
+    {"message_template", nullptr, benchMessageTemplate},
+    {"message_template_json", setupRichTemplate, benchMessageTemplateJson},
+    {"latency_baseline", setupLatencyBaseline, benchLatencyBaseline},
+};
+
+// --- Snapshot hit rate ---
+// Not timed: ten simulated minutes of checks (every slot at its 60 s
+// interval) and dashboards polling the unfiltered /api/status every 5 s.
+// Counts how many polls reuse the shared snapshot, next to the rebuilds a
+// snapshot invalidated by every check result would need.
+
+struct HitRate {
+    int dashboards;
+    uint32_t polls;
+    uint32_t builds;
+    uint32_t builds_on_every_check;
+};
+
+static uint32_t snapshotBuilds() {
+    DynamicJsonDocument doc(1024);
+    buildStatusSnapshotJson(doc.to<JsonObject>());
+    return doc["builds"];
+}
+
+static HitRate measureSnapshotHitRate(int dashboards) {
+    const uint32_t STEP_MS = 10, DURATION_MS = 600000, POLL_MS = 5000;
+    uint32_t checkGapMs = 60000 / NUM_TARGETS;
+    checkGapMs = checkGapMs < STEP_MS ? STEP_MS : checkGapMs - checkGapMs % STEP_MS;
+    HitRate r = {dashboards, 0, 0, 0};
+    statusChanged();
+    statusSnapshot(API_FORMAT_JSON);
+    uint32_t buildsBefore = snapshotBuilds();
+    bool checkedSincePoll = false;
+    int next = 0;
+    for (uint32_t t = STEP_MS; t <= DURATION_MS; t += STEP_MS) {
+        hal_posix_advance_clock(STEP_MS);
+        if (t % checkGapMs == 0) {
+            processCheckResult(next, httpCode[next], 40 + next % 200 + t % 7);
+            next = (next + 1) % NUM_TARGETS;
+            checkedSincePoll = true;
+        }
+        for (int d = 0; d < dashboards; d++) {
+            uint32_t offset = (POLL_MS / dashboards * d) / STEP_MS * STEP_MS;
+            if (t % POLL_MS != offset) continue;
+            sink = statusSnapshot(API_FORMAT_JSON)->length;
+            r.polls++;
+            if (checkedSincePoll) r.builds_on_every_check++;
+            checkedSincePoll = false;
+        }
+    }
+    r.builds = snapshotBuilds() - buildsBefore;
+    return r;
+}
+
+struct Result {
+    const char* name;
+    uint64_t iterations;
+    double ns_per_op;
+    double allocs_per_op;
+    double bytes_per_op;
+};
+
+// Run in growing batches until minTimeNs has elapsed
+static Result runBenchmark(const Benchmark& b, uint64_t minTimeNs) {
+    if (b.setup) b.setup();
+    for (int i = 0; i < 3; i++) b.run();  // Warm-up
+
+    uint64_t iterations = 0, elapsed = 0, batch = 1;
+    AllocSnapshot before = alloc_snapshot();
+    while (elapsed < minTimeNs) {
+        uint64_t start = nowNs();
+        for (uint64_t i = 0; i < batch; i++) b.run();
+        elapsed += nowNs() - start;
+        iterations += batch;
+        if (batch < (1u << 20)) batch *= 2;
+    }
+    AllocSnapshot after = alloc_snapshot();
+
+    Result r;
+    r.name = b.name;
+    r.iterations = iterations;
+    r.ns_per_op = (double)elapsed / iterations;
+    r.allocs_per_op = (double)(after.allocations - before.allocations) / iterations;
+    r.bytes_per_op = (double)(after.bytes - before.bytes) / iterations;
+    return r;
+}
+
+static void usage(const char* argv0) {
+    fprintf(stderr,
+        "Usage: %s [--filter SUBSTRING] [--min-time-ms MS] [--label TEXT] [--output FILE]\n"
+        "  --filter       run only benchmarks whose name contains SUBSTRING\n"
+        "  --min-time-ms  minimum measuring time per benchmark (default 500)\n"
+        "  --label        free-form label stored in the results (e.g. a commit hash)\n"
+        "  --output       write JSON results to FILE instead of stdout\n", argv0);
+}
+
+int main(int argc, char** argv) {
+    const char* filter = nullptr;
+    const char* label = "";
+    const char* outputPath = nullptr;
+    uint64_t minTimeMs = 500;
+
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "--filter") == 0 && i + 1 < argc) filter = argv[++i];
+        else if (strcmp(argv[i], "--min-time-ms") == 0 && i + 1 < argc) minTimeMs = strtoull(argv[++i], nullptr, 10);
+        else if (strcmp(argv[i], "--label") == 0 && i + 1 < argc) label = argv[++i];
+        else if (strcmp(argv[i], "--output") == 0 && i + 1 < argc) outputPath = argv[++i];
+        else {
+            usage(argv[0]);
+            return 2;
+        }
+    }
+
+    hal_posix_set_console_enabled(false);
+    populateTargets();
+
+    std::vector<Result> results;
+    for (size_t i = 0; i < sizeof(BENCHMARKS) / sizeof(BENCHMARKS[0]); i++) {
+        if (filter && !strstr(BENCHMARKS[i].name, filter)) continue;
+        Result r = runBenchmark(BENCHMARKS[i], minTimeMs * 1000000ULL);
+        fprintf(stderr, "%-22s %4d targets %12.0f ns/op %8.1f allocs/op %10.0f B/op\n",
+            r.name, NUM_TARGETS, r.ns_per_op, r.allocs_per_op, r.bytes_per_op);
+        results.push_back(r);
+    }
+
+    std::vector<HitRate> hitRates;
+    if (!filter || strstr("status_snapshot_hit_rate", filter)) {
+        const int DASHBOARDS[] = {1, 3};
+        for (int d : DASHBOARDS) {
+            HitRate h = measureSnapshotHitRate(d);
+            fprintf(stderr, "%-22s %4d targets %d dashboard(s): %u polls, %u builds (%.0f%% hits), %u if every check rebuilt\n",
+                "status_snapshot_hit_rate", NUM_TARGETS, h.dashboards, h.polls, h.builds,
+                100.0 * (h.polls - h.builds) / h.polls, h.builds_on_every_check);
+            hitRates.push_back(h);
+        }
+    }
+
+    FILE* out = outputPath ? fopen(outputPath, "w") : stdout;
+    if (!out) {
+        fprintf(stderr, "Cannot write %s\n", outputPath);
+        return 1;
+    }
+    fprintf(out, "{\"label\":\"%s\",\"num_targets\":%d,\"benchmarks\":[", label, NUM_TARGETS);
+    for (size_t i = 0; i < results.size(); i++) {
+        const Result& r = results[i];
+        fprintf(out, "%s\n  {\"name\":\"%s\",\"iterations\":%llu,\"ns_per_op\":%.1f,\"allocs_per_op\":%.2f,\"bytes_per_op\":%.1f}",
+            i ? "," : "", r.name, (unsigned long long)r.iterations, r.ns_per_op, r.allocs_per_op, r.bytes_per_op);
+    }
+    fprintf(out, "\n],\"status_snapshot_hit_rate\":[");
+    for (size_t i = 0; i < hitRates.size(); i++) {
+        const HitRate& h = hitRates[i];
+        fprintf(out, "%s\n  {\"dashboards\":%d,\"polls\":%u,\"builds\":%u,\"builds_on_every_check\":%u}",
+            i ? "," : "", h.dashboards, h.polls, h.builds, h.builds_on_every_check);
+    }
+    fprintf(out, "\n]}\n");
+    if (out != stdout) fclose(out);
+    return 0;
+}
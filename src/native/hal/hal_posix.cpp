@@ -0,0 +1,634 @@
+// Linux implementation of the platform abstraction layer (monitor_hal.h).
+// HTTP runs over plain POSIX sockets (http:// only, no TLS), files live in an
+// in-memory map, and the clock is CLOCK_MONOTONIC.
+
+#include "monitor_hal.h"
+#include "hal_posix.h"
+
+#include <errno.h>
+#include <fcntl.h>
+#include <netdb.h>
+#include <poll.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <strings.h>
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+#include <map>
+#include <mutex>
+#include <string>
+
+// --- Clock ---
+
+static uint64_t monotonicMs() {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000 + ts.tv_nsec / 1000000;
+}
+
+static const uint64_t bootMs = monotonicMs();
+static uint64_t skippedMs = 0;
+static long localOffsetSec = 0;
+
+void hal_posix_advance_clock(uint32_t ms) {
+    skippedMs += ms;
+}
+
+uint32_t hal_millis() {
+    return (uint32_t)(monotonicMs() - bootMs + skippedMs);
+}
+
+void hal_delay(uint32_t ms) {
+    usleep(ms * 1000);
+}
+
+void hal_configure_time(long gmtOffsetSec, const char* ntpServer) {
+    (void)ntpServer;  // The host clock is assumed to be NTP-synced already
+    localOffsetSec = gmtOffsetSec;
+}
+
+bool hal_local_time(struct tm* timeinfo) {
+    time_t now = time(nullptr) + localOffsetSec;
+    return gmtime_r(&now, timeinfo) != nullptr;
+}
+
+// No portable cycle counter; a nanosecond clock has the same shape (1000 "cycles" per us)
+uint32_t hal_cycle_count() {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint32_t)((uint64_t)ts.tv_sec * 1000000000ULL + ts.tv_nsec);
+}
+
+uint32_t hal_cycles_per_us() {
+    return 1000;
+}
+
+uint32_t hal_random() {
+    uint32_t value = 0;
+    int fd = open("/dev/urandom", O_RDONLY);
+    if (fd >= 0) {
+        if (read(fd, &value, sizeof(value)) != (ssize_t)sizeof(value)) value = 0;
+        close(fd);
+    }
+    return value ? value : hal_cycle_count() ^ (uint32_t)getpid();
+}
+
+// --- Console ---
+
+static bool consoleEnabled = true;
+
+void hal_posix_set_console_enabled(bool enabled) {
+    consoleEnabled = enabled;
+}
+
+void hal_console_write(const char* text) {
+    if (!consoleEnabled) return;
+    fputs(text, stdout);
+    fflush(stdout);
+}
+
+// --- Network ---
+
+static bool networkConnected = true;
+
+void hal_posix_set_network_connected(bool connected) {
+    networkConnected = connected;
+}
+
+bool hal_network_connected() {
+    return networkConnected;
+}
+
+void hal_network_reconnect() {
+}
+
+int hal_network_rssi() {
+    return 0;
+}
+
+void hal_network_ssid(char* buf, size_t size) {
+    snprintf(buf, size, "native");
+}
+
+// --- Memory ---
+
+void hal_heap_stats(HalHeapStats* stats) {
+    memset(stats, 0, sizeof(*stats));
+}
+
+uint32_t hal_stack_min_free_bytes() {
+    return 0;
+}
+
+// --- HTTP client ---
+
+struct ParsedUrl {
+    char host[128];
+    char port[8];
+    const char* path;
+};
+
+static bool parseUrl(const char* url, ParsedUrl* out) {
+    if (strncmp(url, "http://", 7) != 0) return false;  // No TLS on the host build
+    const char* host = url + 7;
+    const char* hostEnd = host + strcspn(host, ":/?");
+    size_t hostLen = hostEnd - host;
+    if (hostLen == 0 || hostLen >= sizeof(out->host)) return false;
+    memcpy(out->host, host, hostLen);
+    out->host[hostLen] = '\0';
+
+    const char* rest = hostEnd;
+    if (*rest == ':') {
+        size_t portLen = strcspn(rest + 1, "/?");
+        if (portLen == 0 || portLen >= sizeof(out->port)) return false;
+        memcpy(out->port, rest + 1, portLen);
+        out->port[portLen] = '\0';
+        rest += 1 + portLen;
+    } else {
+        strcpy(out->port, "80");
+    }
+    out->path = *rest ? rest : "/";
+    return true;
+}
+
+static int waitFor(int fd, short events, uint64_t deadline) {
+    uint64_t now = monotonicMs();
+    if (now >= deadline) return 0;
+    struct pollfd pfd = {fd, events, 0};
+    int rc;
+    do {
+        rc = poll(&pfd, 1, (int)(deadline - now));
+    } while (rc < 0 && errno == EINTR);
+    return rc;
+}
+
+static int connectWithDeadline(const ParsedUrl& url, uint64_t deadline) {
+    struct addrinfo hints;
+    memset(&hints, 0, sizeof(hints));
+    hints.ai_family = AF_UNSPEC;
+    hints.ai_socktype = SOCK_STREAM;
+    struct addrinfo* res = nullptr;
+    if (getaddrinfo(url.host, url.port, &hints, &res) != 0) return -1;
+
+    int fd = -1;
+    for (struct addrinfo* ai = res; ai && fd < 0; ai = ai->ai_next) {
+        fd = socket(ai->ai_family, ai->ai_socktype | SOCK_NONBLOCK | SOCK_CLOEXEC, ai->ai_protocol);
+        if (fd < 0) continue;
+        if (connect(fd, ai->ai_addr, ai->ai_addrlen) == 0) break;
+        if (errno == EINPROGRESS && waitFor(fd, POLLOUT, deadline) > 0) {
+            int err = 0;
+            socklen_t len = sizeof(err);
+            if (getsockopt(fd, SOL_SOCKET, SO_ERROR, &err, &len) == 0 && err == 0) break;
+        }
+        close(fd);
+        fd = -1;
+    }
+    freeaddrinfo(res);
+    return fd;
+}
+
+static bool sendAll(int fd, const char* data, size_t len, uint64_t deadline) {
+    while (len > 0) {
+        ssize_t n = send(fd, data, len, MSG_NOSIGNAL);
+        if (n > 0) {
+            data += n;
+            len -= n;
+        } else if (n < 0 && (errno == EAGAIN || errno == EINTR)) {
+            if (waitFor(fd, POLLOUT, deadline) <= 0) return false;
+        } else {
+            return false;
+        }
+    }
+    return true;
+}
+
+// Numeric header (seconds, possibly fractional) of a response head; -1 when absent
+static double headerNumber(const char* resp, const char* name) {
+    size_t nameLen = strlen(name);
+    for (const char* line = strstr(resp, "\r\n"); line; line = strstr(line + 2, "\r\n")) {
+        if (strncasecmp(line + 2, name, nameLen) == 0) return atof(line + 2 + nameLen);
+    }
+    return -1;
+}
+
+// One request/response exchange. Reads only the status line and headers;
+// the body is discarded by closing the connection (we send Connection: close).
+static int performRequest(const HalHttpRequest& request, const char* urlStr, char* location, size_t locationSize) {
+    ParsedUrl url;
+    if (!parseUrl(urlStr, &url)) return HAL_HTTP_ERROR_CONNECTION_REFUSED;
+
+    uint64_t deadline = monotonicMs() + request.timeout_ms;
+    int fd = connectWithDeadline(url, deadline);
+    if (fd < 0) return HAL_HTTP_ERROR_CONNECTION_REFUSED;
+
+    char head[2048];
+    int headLen = snprintf(head, sizeof(head),
+        "%s %s HTTP/1.1\r\nHost: %s\r\nUser-Agent: ESP32HTTPClient\r\nConnection: close\r\n",
+        request.method, url.path, url.host);
+    if (request.content_type) {
+        headLen += snprintf(head + headLen, sizeof(head) - headLen, "Content-Type: %s\r\n", request.content_type);
+    }
+    if (request.header_name) {
+        headLen += snprintf(head + headLen, sizeof(head) - headLen, "%s: %s\r\n", request.header_name, request.header_value);
+    }
+    headLen += snprintf(head + headLen, sizeof(head) - headLen, "Content-Length: %u\r\n\r\n", (unsigned)request.body_len);
+    if (headLen >= (int)sizeof(head) ||
+        !sendAll(fd, head, headLen, deadline) ||
+        (request.body_len && !sendAll(fd, request.body, request.body_len, deadline))) {
+        close(fd);
+        return HAL_HTTP_ERROR_SEND_FAILED;
+    }
+
+    // Read until the end of the headers
+    char resp[2048];
+    size_t used = 0;
+    char* headerEnd = nullptr;
+    while (!headerEnd && used < sizeof(resp) - 1) {
+        ssize_t n = recv(fd, resp + used, sizeof(resp) - 1 - used, 0);
+        if (n > 0) {
+            used += n;
+            resp[used] = '\0';
+            headerEnd = strstr(resp, "\r\n\r\n");
+        } else if (n == 0) {
+            break;
+        } else if (errno == EAGAIN || errno == EINTR) {
+            if (waitFor(fd, POLLIN, deadline) <= 0) {
+                close(fd);
+                return HAL_HTTP_ERROR_READ_TIMEOUT;
+            }
+        } else {
+            break;
+        }
+    }
+    close(fd);
+
+    int code = 0;
+    if (used == 0 || sscanf(resp, "HTTP/%*d.%*d %d", &code) != 1) return HAL_HTTP_ERROR_CONNECTION_LOST;
+
+    if (request.retry_after_ms) {
+        double seconds = headerNumber(resp, "Retry-After:");
+        if (seconds < 0 && headerNumber(resp, "X-RateLimit-Remaining:") == 0) {
+            seconds = headerNumber(resp, "X-RateLimit-Reset-After:");
+        }
+        if (seconds > 86400) seconds = 86400;
+        *request.retry_after_ms = seconds > 0 ? (uint32_t)(seconds * 1000) : 0;
+    }
+
+    if (location) {
+        location[0] = '\0';
+        for (char* line = strstr(resp, "\r\n"); line && line + 2 < resp + used; line = strstr(line + 2, "\r\n")) {
+            if (strncasecmp(line + 2, "Location:", 9) == 0) {
+                const char* value = line + 11;
+                while (*value == ' ') value++;
+                size_t len = strcspn(value, "\r\n");
+                if (len >= locationSize) len = locationSize - 1;
+                memcpy(location, value, len);
+                location[len] = '\0';
+                break;
+            }
+        }
+    }
+    return code;
+}
+
+static bool uplinkDown = false;
+
+void hal_posix_set_uplink_down(bool down) {
+    uplinkDown = down;
+}
+
+int hal_http_request(const HalHttpRequest& request) {
+    if (uplinkDown) return HAL_HTTP_ERROR_CONNECTION_REFUSED;
+    char url[768];  // Telegram URLs carry the encoded message
+    snprintf(url, sizeof(url), "%s", request.url);
+
+    // Mirror HTTPC_STRICT_FOLLOW_REDIRECTS: only GET follows 301/302/303/307/308
+    for (int redirects = 0; ; redirects++) {
+        char location[sizeof(url)];
+        int code = performRequest(request, url, location, sizeof(location));
+        bool isRedirect = code == 301 || code == 302 || code == 303 || code == 307 || code == 308;
+        if (!request.follow_redirects || !isRedirect || strcmp(request.method, "GET") != 0 ||
+            location[0] == '\0' || redirects >= 10) {
+            return code;
+        }
+        if (location[0] == '/') {
+            // Relative redirect: keep scheme/host/port of the current URL
+            ParsedUrl current;
+            if (!parseUrl(url, &current)) return code;
+            char next[sizeof(url)];
+            int len = snprintf(next, sizeof(next), "http://%s:%s%s", current.host, current.port, location);
+            if (len < 0 || (size_t)len >= sizeof(next)) return code;  // Cut short, it would lead elsewhere
+            memcpy(url, next, len + 1);
+        } else {
+            snprintf(url, sizeof(url), "%s", location);
+        }
+    }
+}
+
+// --- Streaming download ---
+
+struct HalDownload {
+    int fd;
+    std::string pending;  // Body bytes that arrived with the headers
+    int32_t remaining;    // -1 = until the server closes the connection
+};
+
+HalDownload* hal_download_open(const char* urlStr, uint32_t timeout_ms, int* status, int32_t* length) {
+    *status = HAL_HTTP_ERROR_CONNECTION_REFUSED;
+    ParsedUrl url;
+    if (uplinkDown || !parseUrl(urlStr, &url)) return nullptr;
+    uint64_t deadline = monotonicMs() + timeout_ms;
+    int fd = connectWithDeadline(url, deadline);
+    if (fd < 0) return nullptr;
+
+    // HTTP/1.0, so the body is never chunked
+    char head[512];
+    int headLen = snprintf(head, sizeof(head), "GET %s HTTP/1.0\r\nHost: %s\r\nUser-Agent: ESP32HTTPClient\r\n\r\n",
+                           url.path, url.host);
+    if (headLen >= (int)sizeof(head) || !sendAll(fd, head, headLen, deadline)) {
+        close(fd);
+        *status = HAL_HTTP_ERROR_SEND_FAILED;
+        return nullptr;
+    }
+
+    std::string resp;
+    size_t headerEnd = std::string::npos;
+    char buf[1024];
+    while (headerEnd == std::string::npos && resp.size() < 8192) {
+        ssize_t n = recv(fd, buf, sizeof(buf), 0);
+        if (n > 0) {
+            resp.append(buf, n);
+            headerEnd = resp.find("\r\n\r\n");
+        } else if (n < 0 && (errno == EAGAIN || errno == EINTR)) {
+            if (waitFor(fd, POLLIN, deadline) <= 0) {
+                close(fd);
+                *status = HAL_HTTP_ERROR_READ_TIMEOUT;
+                return nullptr;
+            }
+        } else {
+            break;
+        }
+    }
+    int code = 0;
+    if (headerEnd == std::string::npos || sscanf(resp.c_str(), "HTTP/%*d.%*d %d", &code) != 1) {
+        close(fd);
+        *status = HAL_HTTP_ERROR_CONNECTION_LOST;
+        return nullptr;
+    }
+    *status = code;
+    if (code != 200) {
+        close(fd);
+        return nullptr;
+    }
+
+    *length = -1;
+    for (size_t line = resp.find("\r\n"); line < headerEnd; line = resp.find("\r\n", line + 2)) {
+        if (strncasecmp(resp.c_str() + line + 2, "Content-Length:", 15) == 0) {
+            *length = atol(resp.c_str() + line + 17);
+            break;
+        }
+    }
+    HalDownload* download = new HalDownload();
+    download->fd = fd;
+    download->pending = resp.substr(headerEnd + 4);
+    download->remaining = *length;
+    return download;
+}
+
+int hal_download_read(HalDownload* download, uint8_t* buf, size_t size) {
+    if (download->remaining == 0) return -1;
+    if (download->remaining > 0 && size > (size_t)download->remaining) size = download->remaining;
+    ssize_t n;
+    if (!download->pending.empty()) {
+        n = download->pending.size() < size ? download->pending.size() : size;
+        memcpy(buf, download->pending.data(), n);
+        download->pending.erase(0, n);
+    } else {
+        n = recv(download->fd, buf, size, MSG_DONTWAIT);
+        if (n < 0 && (errno == EAGAIN || errno == EINTR)) return 0;
+        if (n <= 0) return -1;
+    }
+    if (download->remaining > 0) download->remaining -= n;
+    return n;
+}
+
+void hal_download_close(HalDownload* download) {
+    close(download->fd);
+    delete download;
+}
+
+// --- Firmware update ---
+
+static std::string updateImage;
+static bool updateOpen = false;
+static bool restartRequested = false;
+
+bool hal_update_begin(uint32_t size) {
+    if (updateOpen) return false;
+    updateImage.clear();
+    updateImage.reserve(size);
+    updateOpen = true;
+    return true;
+}
+
+bool hal_update_write(const uint8_t* data, size_t len) {
+    if (!updateOpen) return false;
+    updateImage.append((const char*)data, len);
+    return true;
+}
+
+bool hal_update_end() {
+    if (!updateOpen) return false;
+    updateOpen = false;
+    HalFile* file = hal_fs_open("/ota_firmware.bin", "w");
+    hal_fs_write(file, updateImage.data(), updateImage.size());
+    hal_fs_close(file);
+    updateImage.clear();
+    return true;
+}
+
+void hal_update_abort() {
+    updateOpen = false;
+    updateImage.clear();
+}
+
+void hal_restart() {
+    hal_console_write("[hal] Restart requested\n");
+    restartRequested = true;
+}
+
+bool hal_posix_restart_requested() {
+    return restartRequested;
+}
+
+// --- UDP ---
+
+static int udpFd = -1;
+
+bool hal_udp_begin(uint16_t port) {
+    hal_udp_end();
+    int fd = socket(AF_INET, SOCK_DGRAM, 0);
+    if (fd < 0) return false;
+    int one = 1;
+    setsockopt(fd, SOL_SOCKET, SO_REUSEADDR, &one, sizeof(one));
+    struct sockaddr_in addr;
+    memset(&addr, 0, sizeof(addr));
+    addr.sin_family = AF_INET;
+    addr.sin_addr.s_addr = htonl(INADDR_ANY);
+    addr.sin_port = htons(port);
+    if (bind(fd, (struct sockaddr*)&addr, sizeof(addr)) != 0) {
+        close(fd);
+        return false;
+    }
+    fcntl(fd, F_SETFL, fcntl(fd, F_GETFL) | O_NONBLOCK);
+    udpFd = fd;
+    return true;
+}
+
+void hal_udp_end() {
+    if (udpFd >= 0) close(udpFd);
+    udpFd = -1;
+}
+
+bool hal_udp_send(const char* host, uint16_t port, const uint8_t* data, size_t len) {
+    if (udpFd < 0) return false;
+    struct addrinfo hints;
+    memset(&hints, 0, sizeof(hints));
+    hints.ai_family = AF_INET;
+    hints.ai_socktype = SOCK_DGRAM;
+    char service[8];
+    snprintf(service, sizeof(service), "%u", port);
+    struct addrinfo* res = nullptr;
+    if (getaddrinfo(host, service, &hints, &res) != 0 || !res) return false;
+    bool sent = sendto(udpFd, data, len, 0, res->ai_addr, res->ai_addrlen) == (ssize_t)len;
+    freeaddrinfo(res);
+    return sent;
+}
+
+bool hal_resolve_ipv4(const char* host, char* ip, size_t size) {
+    struct addrinfo hints;
+    memset(&hints, 0, sizeof(hints));
+    hints.ai_family = AF_INET;
+    struct addrinfo* res = nullptr;
+    if (getaddrinfo(host, nullptr, &hints, &res) != 0 || !res) return false;
+    bool ok = inet_ntop(AF_INET, &((struct sockaddr_in*)res->ai_addr)->sin_addr, ip, size) != nullptr;
+    freeaddrinfo(res);
+    return ok;
+}
+
+size_t hal_udp_receive(uint8_t* buf, size_t size, char* from, size_t fromSize) {
+    if (udpFd < 0) return 0;
+    struct sockaddr_in addr;
+    socklen_t addrLen = sizeof(addr);
+    ssize_t n = recvfrom(udpFd, buf, size, 0, (struct sockaddr*)&addr, &addrLen);
+    if (n <= 0) return 0;
+    char ip[INET_ADDRSTRLEN];
+    inet_ntop(AF_INET, &addr.sin_addr, ip, sizeof(ip));
+    snprintf(from, fromSize, "%s:%u", ip, ntohs(addr.sin_port));
+    return n;
+}
+
+// --- Filesystem (in memory) ---
+
+struct HalFile {
+    std::string path;
+    std::string data;
+    size_t pos;
+    bool writing;
+};
+
+static std::map<std::string, std::string> files;
+static std::mutex filesMutex;
+
+HalFile* hal_fs_open(const char* path, const char* mode) {
+    std::lock_guard<std::mutex> lock(filesMutex);
+    bool writing = mode[0] == 'w' || mode[0] == 'a';
+    std::map<std::string, std::string>::iterator it = files.find(path);
+    if (!writing && it == files.end()) return nullptr;
+
+    HalFile* file = new HalFile();
+    file->path = path;
+    file->pos = 0;
+    file->writing = writing;
+    if (mode[0] != 'w' && it != files.end()) file->data = it->second;  // Read, or append to the existing content
+    return file;
+}
+
+size_t hal_fs_read(HalFile* file, void* buf, size_t len) {
+    size_t available = file->data.size() - file->pos;
+    if (len > available) len = available;
+    memcpy(buf, file->data.data() + file->pos, len);
+    file->pos += len;
+    return len;
+}
+
+size_t hal_fs_write(HalFile* file, const void* buf, size_t len) {
+    file->data.append((const char*)buf, len);
+    return len;
+}
+
+size_t hal_fs_size(HalFile* file) {
+    return file->data.size();
+}
+
+void hal_fs_close(HalFile* file) {
+    if (file->writing) {
+        std::lock_guard<std::mutex> lock(filesMutex);
+        files[file->path].swap(file->data);
+    }
+    delete file;
+}
+
+bool hal_fs_exists(const char* path) {
+    std::lock_guard<std::mutex> lock(filesMutex);
+    return files.count(path) > 0;
+}
+
+bool hal_fs_remove(const char* path) {
+    std::lock_guard<std::mutex> lock(filesMutex);
+    return files.erase(path) > 0;
+}
+
+bool hal_posix_fs_import(const char* path, const char* hostPath) {
+    FILE* f = fopen(hostPath, "rb");
+    if (!f) return false;
+    std::string data;
+    char buf[4096];
+    size_t n;
+    while ((n = fread(buf, 1, sizeof(buf), f)) > 0) data.append(buf, n);
+    fclose(f);
+
+    std::lock_guard<std::mutex> lock(filesMutex);
+    files[path].swap(data);
+    return true;
+}
+
+bool hal_posix_fs_export(const char* path, const char* hostPath) {
+    std::string data;
+    {
+        std::lock_guard<std::mutex> lock(filesMutex);
+        std::map<std::string, std::string>::iterator it = files.find(path);
+        if (it == files.end()) return false;
+        data = it->second;
+    }
+    FILE* f = fopen(hostPath, "wb");
+    if (!f) return false;
+    bool ok = fwrite(data.data(), 1, data.size(), f) == data.size();
+    return fclose(f) == 0 && ok;
+}
+
+// --- Persistent config version ---
+
+static int storedConfigVersion = 0;
+
+int hal_stored_config_version() {
+    return storedConfigVersion;
+}
+
+void hal_store_config_version(int version) {
+    storedConfigVersion = version;
+}
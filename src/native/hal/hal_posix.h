@@ -0,0 +1,26 @@
+#pragma once
+
+#include <stdint.h>
+
+// Linux-only extras of the POSIX platform layer (hal_posix.cpp).
+// The in-memory filesystem starts empty; these move files between it and disk.
+
+bool hal_posix_fs_import(const char* path, const char* hostPath);
+bool hal_posix_fs_export(const char* path, const char* hostPath);
+
+// Silence console output (benchmarks measure formatting, not terminal I/O)
+void hal_posix_set_console_enabled(bool enabled);
+
+// Pretend the network is up or down (default: up)
+void hal_posix_set_network_connected(bool connected);
+
+// Fail every outgoing HTTP request with "connection refused", as if this
+// host's uplink were broken (default: off). UDP is not affected.
+void hal_posix_set_uplink_down(bool down);
+
+// Move hal_millis() forward, as if ms had passed (tests of timeouts)
+void hal_posix_advance_clock(uint32_t ms);
+
+// Set by hal_restart(): the host build has no reboot, the caller just stops.
+// hal_update_end() leaves the image in the in-memory file /ota_firmware.bin.
+bool hal_posix_restart_requested();
@@ -0,0 +1,122 @@
+#include "local_http_server.h"
+
+#include <errno.h>
+#include <netinet/in.h>
+#include <poll.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+#include "monitor_hal.h"
+
+LocalHttpServer::~LocalHttpServer() {
+    stop();
+}
+
+bool LocalHttpServer::start(LocalHttpHandler handler) {
+    handler_ = handler;
+    listenFd_ = socket(AF_INET, SOCK_STREAM | SOCK_CLOEXEC, 0);
+    if (listenFd_ < 0) return false;
+
+    struct sockaddr_in addr;
+    memset(&addr, 0, sizeof(addr));
+    addr.sin_family = AF_INET;
+    addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    addr.sin_port = 0;  // Ephemeral
+    socklen_t len = sizeof(addr);
+    if (bind(listenFd_, (struct sockaddr*)&addr, sizeof(addr)) != 0 ||
+        listen(listenFd_, 64) != 0 ||
+        getsockname(listenFd_, (struct sockaddr*)&addr, &len) != 0) {
+        close(listenFd_);
+        listenFd_ = -1;
+        return false;
+    }
+    port_ = ntohs(addr.sin_port);
+    acceptThread_ = std::thread(&LocalHttpServer::acceptLoop, this);
+    return true;
+}
+
+void LocalHttpServer::stop() {
+    if (listenFd_ < 0) return;
+    stopping_ = true;
+    acceptThread_.join();
+    close(listenFd_);
+    listenFd_ = -1;
+    while (active_ > 0) hal_delay(10);
+}
+
+void LocalHttpServer::acceptLoop() {
+    while (!stopping_) {
+        struct pollfd pfd = {listenFd_, POLLIN, 0};
+        if (poll(&pfd, 1, 100) <= 0) continue;
+        int fd = accept4(listenFd_, nullptr, nullptr, SOCK_CLOEXEC);
+        if (fd < 0) continue;
+        active_++;
+        std::thread(&LocalHttpServer::serve, this, fd).detach();
+    }
+}
+
+void LocalHttpServer::serve(int fd) {
+    // Read headers, then Content-Length bytes of body
+    std::string data;
+    size_t headerEnd = std::string::npos;
+    size_t bodyLen = 0;
+    char buf[2048];
+    while (!stopping_) {
+        struct pollfd pfd = {fd, POLLIN, 0};
+        if (poll(&pfd, 1, 100) == 0) continue;
+        ssize_t n = recv(fd, buf, sizeof(buf), 0);
+        if (n <= 0) break;
+        data.append(buf, n);
+        if (headerEnd == std::string::npos) {
+            headerEnd = data.find("\r\n\r\n");
+            if (headerEnd == std::string::npos) continue;
+            const char* cl = strcasestr(data.c_str(), "\r\nContent-Length:");
+            if (cl && cl < data.c_str() + headerEnd) bodyLen = strtoul(cl + 17, nullptr, 10);
+        }
+        if (data.size() >= headerEnd + 4 + bodyLen) break;
+    }
+
+    if (headerEnd != std::string::npos && !stopping_) {
+        LocalHttpRequest request;
+        request.received_ms = hal_millis();
+        size_t methodEnd = data.find(' ');
+        size_t pathEnd = data.find(' ', methodEnd + 1);
+        request.method = data.substr(0, methodEnd);
+        request.path = data.substr(methodEnd + 1, pathEnd - methodEnd - 1);
+        request.body = data.substr(headerEnd + 4, bodyLen);
+        handler_(fd, request);
+    }
+    close(fd);
+    active_--;
+}
+
+void LocalHttpServer::sendResponse(int fd, int status) {
+    char response[128];
+    int len = snprintf(response, sizeof(response),
+        "HTTP/1.1 %d Stand-In\r\nContent-Type: text/plain\r\nContent-Length: 2\r\nConnection: close\r\n\r\nok", status);
+    send(fd, response, len, MSG_NOSIGNAL);
+}
+
+void LocalHttpServer::armReset(int fd) {
+    struct linger lin = {1, 0};
+    setsockopt(fd, SOL_SOCKET, SO_LINGER, &lin, sizeof(lin));
+}
+
+void LocalHttpServer::sleepUnlessStopping(uint32_t ms) const {
+    uint32_t start = hal_millis();
+    while (!stopping_ && hal_millis() - start < ms) {
+        uint32_t left = ms - (hal_millis() - start);
+        hal_delay(left < 50 ? left : 50);
+    }
+}
+
+void LocalHttpServer::hang(int fd) const {
+    char buf[256];
+    while (!stopping_) {
+        struct pollfd pfd = {fd, POLLIN, 0};
+        if (poll(&pfd, 1, 100) > 0 && recv(fd, buf, sizeof(buf), 0) <= 0) return;  // Client closed
+    }
+}
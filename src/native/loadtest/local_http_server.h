@@ -0,0 +1,53 @@
+#pragma once
+
+#include <stdint.h>
+
+#include <atomic>
+#include <functional>
+#include <string>
+#include <thread>
+
+// One request as seen by a local server
+struct LocalHttpRequest {
+    std::string method;
+    std::string path;  // Including the query string
+    std::string body;
+    uint32_t received_ms;  // hal_millis() once the request was read
+};
+
+// Handles one request on fd. The connection is closed after return.
+typedef std::function<void(int fd, const LocalHttpRequest& request)> LocalHttpHandler;
+
+// Minimal HTTP/1.1 server on 127.0.0.1 with an ephemeral port and one thread
+// per connection, used to stand in for monitored targets and notification APIs.
+class LocalHttpServer {
+public:
+    ~LocalHttpServer();
+
+    bool start(LocalHttpHandler handler);
+    // Closes the listener and waits until in-flight connections have finished
+    void stop();
+
+    uint16_t port() const { return port_; }
+    bool stopping() const { return stopping_; }
+
+    // --- Helpers for handlers ---
+    static void sendResponse(int fd, int status);
+    // Abort the connection with a TCP RST when fd is closed
+    static void armReset(int fd);
+    // Sleep up to ms, returning early once the server is stopping
+    void sleepUnlessStopping(uint32_t ms) const;
+    // Keep the connection open without answering until the client gives up
+    void hang(int fd) const;
+
+private:
+    void acceptLoop();
+    void serve(int fd);
+
+    LocalHttpHandler handler_;
+    int listenFd_ = -1;
+    uint16_t port_ = 0;
+    std::atomic<bool> stopping_{false};
+    std::atomic<int> active_{0};
+    std::thread acceptThread_;
+};
@@ -0,0 +1,533 @@
+// Load-test harness: runs the monitor core against local stand-in targets.
+//
+// Every target gets its own HTTP server on 127.0.0.1 that follows a scripted
+// timeline of responses (status codes, latency, TCP resets, hangs). All
+// notification channels (Discord, ntfy, Telegram, custom on/off URLs) point at
+// a local sink that records when each call arrives. The report covers:
+//   - achieved checks per second and the result mix
+//   - scheduling lag: how late each check started versus its adaptive interval
+//   - detection time for every scripted outage/recovery versus the nominal
+//     one interval plus (threshold - 1) fast retries
+//   - notification delay from detection to arrival at the sink, per channel
+//
+//   pio run -e native_loadtest && .pio/build/native_loadtest/program --duration 180
+//
+// Scenario file format (one target per line, '#' starts a comment):
+//   NAME INTERVAL_S FAILURE_THRESHOLD RECOVERY_THRESHOLD PHASE...
+// where PHASE is KIND[/LATENCY_MS][@START_S] and KIND is an HTTP status code,
+// "ok" (200), "reset" (TCP RST) or "hang" (accept, never answer). Example:
+//   api 10 3 2 ok/40 503@60 ok@120
+//   db  30 2 2 ok/15 hang@90 ok@150
+// A "parent=NAME" token makes the target depend on an earlier line.
+
+#include <signal.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <algorithm>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+#include "../hal/hal_posix.h"
+#include "group_index.h"
+#include "local_http_server.h"
+#include "monitor_config.h"
+#include "monitor_hal.h"
+#include "monitor_state.h"
+#include "notifications.h"
+#include "scheduler.h"
+
+static volatile sig_atomic_t running = 1;
+
+static void handleSignal(int) {
+    running = 0;
+}
+
+// --- Scenario ---
+
+struct Phase {
+    enum Kind { RESPOND, RESET, HANG };
+    Kind kind;
+    int status;
+    uint32_t latency_ms;
+    uint32_t start_ms;
+};
+
+struct StandIn {
+    std::string name;
+    uint16_t interval_s;
+    uint8_t failure_threshold;
+    uint8_t recovery_threshold;
+    int parent;                 // Index into the scenario, -1 = none
+    std::vector<Phase> phases;  // Sorted by start_ms
+    LocalHttpServer server;
+};
+
+static uint32_t harnessStart = 0;
+static uint16_t retryInterval = DEFAULT_RETRY_INTERVAL;
+static uint16_t maxInterval = 0;  // 0 = same as the target's interval (no back-off)
+
+static bool isHealthy(const Phase& p) {
+    return p.kind == Phase::RESPOND && isOnlineCode(p.status) && p.latency_ms < 5000;
+}
+
+static const Phase& phaseAt(const StandIn& s, uint32_t ms) {
+    size_t i = 0;
+    while (i + 1 < s.phases.size() && s.phases[i + 1].start_ms <= ms) i++;
+    return s.phases[i];
+}
+
+static bool parsePhase(const char* token, Phase* out) {
+    char kind[16];
+    unsigned latency = 0, start = 0;
+    const char* p = token;
+    size_t kindLen = strcspn(p, "/@");
+    if (kindLen == 0 || kindLen >= sizeof(kind)) return false;
+    memcpy(kind, p, kindLen);
+    kind[kindLen] = '\0';
+    p += kindLen;
+    while (*p) {
+        char sep = *p++;
+        unsigned value = strtoul(p, (char**)&p, 10);
+        if (sep == '/') latency = value;
+        else if (sep == '@') start = value;
+        else return false;
+    }
+
+    out->latency_ms = latency;
+    out->start_ms = start * 1000;
+    out->status = 0;
+    if (strcmp(kind, "reset") == 0) out->kind = Phase::RESET;
+    else if (strcmp(kind, "hang") == 0) out->kind = Phase::HANG;
+    else if (strcmp(kind, "ok") == 0) { out->kind = Phase::RESPOND; out->status = 200; }
+    else if (atoi(kind) >= 100 && atoi(kind) < 600) { out->kind = Phase::RESPOND; out->status = atoi(kind); }
+    else return false;
+    return true;
+}
+
+static bool loadScenario(const char* path, std::vector<std::unique_ptr<StandIn> >& out) {
+    FILE* f = fopen(path, "r");
+    if (!f) return false;
+    char line[512];
+    int lineNo = 0;
+    bool ok = true;
+    while (ok && fgets(line, sizeof(line), f)) {
+        lineNo++;
+        char* hash = strchr(line, '#');
+        if (hash) *hash = '\0';
+
+        std::vector<char*> tokens;
+        for (char* tok = strtok(line, " \t\r\n"); tok; tok = strtok(nullptr, " \t\r\n")) tokens.push_back(tok);
+        if (tokens.empty()) continue;
+        if (tokens.size() < 5) {
+            fprintf(stderr, "%s:%d: expected NAME INTERVAL_S FAILURE_THRESHOLD RECOVERY_THRESHOLD PHASE...\n", path, lineNo);
+            ok = false;
+            break;
+        }
+
+        std::unique_ptr<StandIn> s(new StandIn());
+        s->name = tokens[0];
+        s->interval_s = atoi(tokens[1]);
+        s->failure_threshold = atoi(tokens[2]);
+        s->recovery_threshold = atoi(tokens[3]);
+        s->parent = -1;
+        for (size_t t = 4; t < tokens.size(); t++) {
+            if (strncmp(tokens[t], "parent=", 7) == 0) {
+                for (size_t p = 0; p < out.size(); p++) {
+                    if (out[p]->name == tokens[t] + 7) s->parent = p;
+                }
+                if (s->parent < 0) {
+                    fprintf(stderr, "%s:%d: unknown parent '%s'\n", path, lineNo, tokens[t] + 7);
+                    ok = false;
+                    break;
+                }
+                continue;
+            }
+            Phase phase;
+            if (!parsePhase(tokens[t], &phase)) {
+                fprintf(stderr, "%s:%d: bad phase '%s'\n", path, lineNo, tokens[t]);
+                ok = false;
+                break;
+            }
+            s->phases.push_back(phase);
+        }
+        std::stable_sort(s->phases.begin(), s->phases.end(),
+            [](const Phase& a, const Phase& b) { return a.start_ms < b.start_ms; });
+        out.push_back(std::move(s));
+    }
+    fclose(f);
+    return ok;
+}
+
+// Mix of the failure modes seen in production; outages run from 60s to 120s
+static void buildDefaultScenario(int count, uint16_t interval, std::vector<std::unique_ptr<StandIn> >& out) {
+    static const char* const SCRIPTS[] = {
+        "ok/20",
+        "ok/1500",
+        "ok/20 503@60 ok@120",
+        "ok/20 500@30 ok@45 500@60 ok@75 500@90 ok@105",  // Flapping faster than detection
+        "ok/20 reset@60 ok/20@120",
+        "ok/20 hang@60 ok/20@120",
+    };
+    static const char* const NAMES[] = {"steady", "slow", "outage", "flapping", "reset", "hang"};
+    const int kinds = sizeof(SCRIPTS) / sizeof(SCRIPTS[0]);
+
+    for (int i = 0; i < count; i++) {
+        std::unique_ptr<StandIn> s(new StandIn());
+        char name[32];
+        snprintf(name, sizeof(name), "%s-%d", NAMES[i % kinds], i + 1);
+        s->name = name;
+        s->interval_s = interval;
+        s->failure_threshold = 3;
+        s->recovery_threshold = 2;
+        s->parent = -1;
+
+        char script[128];
+        snprintf(script, sizeof(script), "%s", SCRIPTS[i % kinds]);
+        for (char* tok = strtok(script, " "); tok; tok = strtok(nullptr, " ")) {
+            Phase phase;
+            parsePhase(tok, &phase);
+            s->phases.push_back(phase);
+        }
+        out.push_back(std::move(s));
+    }
+}
+
+static void serveStandIn(StandIn* s, int fd) {
+    const Phase& phase = phaseAt(*s, hal_millis() - harnessStart);
+    switch (phase.kind) {
+        case Phase::RESPOND:
+            s->server.sleepUnlessStopping(phase.latency_ms);
+            LocalHttpServer::sendResponse(fd, phase.status);
+            break;
+        case Phase::RESET:
+            s->server.sleepUnlessStopping(phase.latency_ms);
+            LocalHttpServer::armReset(fd);
+            break;
+        case Phase::HANG:
+            s->server.hang(fd);
+            break;
+    }
+}
+
+// --- Notification sink ---
+
+enum Channel { CH_DISCORD, CH_NTFY, CH_TELEGRAM, CH_ACTION, CHANNEL_COUNT };
+static const char* const CHANNEL_NAMES[CHANNEL_COUNT] = {"discord", "ntfy", "telegram", "action"};
+
+struct SinkRecord {
+    int target;
+    Channel channel;
+    uint32_t received_ms;
+};
+
+static std::mutex sinkMutex;
+static std::vector<SinkRecord> sinkRecords;
+static uint32_t sinkLatencyMs = 0;
+static LocalHttpServer sink;
+
+static void serveSink(int fd, const LocalHttpRequest& request) {
+    SinkRecord record;
+    record.received_ms = request.received_ms;
+    const char* path = request.path.c_str();
+    if (sscanf(path, "/discord/%d", &record.target) == 1) record.channel = CH_DISCORD;
+    else if (sscanf(path, "/ntfy/%d", &record.target) == 1) record.channel = CH_NTFY;
+    else if (sscanf(path, "/telegram/botloadtest-bot-%d", &record.target) == 1) record.channel = CH_TELEGRAM;
+    else if (sscanf(path, "/action/on/%d", &record.target) == 1 ||
+             sscanf(path, "/action/off/%d", &record.target) == 1) record.channel = CH_ACTION;
+    else record.target = -1;
+
+    if (record.target >= 0) {
+        std::lock_guard<std::mutex> lock(sinkMutex);
+        sinkRecords.push_back(record);
+    }
+    sink.sleepUnlessStopping(sinkLatencyMs);
+    LocalHttpServer::sendResponse(fd, 200);
+}
+
+static void configureTarget(int i, const StandIn& s) {
+    TargetConfig& t = targets[i];
+    uint16_t sinkPort = sink.port();
+    snprintf(t.server_name, sizeof(t.server_name), "%s", s.name.c_str());
+    snprintf(t.group_name, sizeof(t.group_name), "Load Test");
+    snprintf(t.weburl, sizeof(t.weburl), "http://127.0.0.1:%u/health", s.server.port());
+    snprintf(t.discord_webhook_url, sizeof(t.discord_webhook_url), "http://127.0.0.1:%u/discord/%d", sinkPort, i);
+    snprintf(t.ntfy_url, sizeof(t.ntfy_url), "http://127.0.0.1:%u/ntfy/%d", sinkPort, i);
+    snprintf(t.ntfy_priority, sizeof(t.ntfy_priority), "high");
+    snprintf(t.telegram_bot_token, sizeof(t.telegram_bot_token), "loadtest-bot-%d", i);
+    snprintf(t.telegram_chat_id_1, sizeof(t.telegram_chat_id_1), "1001");
+    snprintf(t.telegram_chat_id_2, sizeof(t.telegram_chat_id_2), "0");
+    snprintf(t.telegram_chat_id_3, sizeof(t.telegram_chat_id_3), "0");
+    snprintf(t.http_get_url_on, sizeof(t.http_get_url_on), "http://127.0.0.1:%u/action/on/%d", sinkPort, i);
+    snprintf(t.http_get_url_off, sizeof(t.http_get_url_off), "http://127.0.0.1:%u/action/off/%d", sinkPort, i);
+    snprintf(t.online_message, sizeof(t.online_message), "{NAME} is back online");
+    snprintf(t.offline_message, sizeof(t.offline_message), "{NAME} is down (Code: {CODE})");
+    t.check_interval_seconds = s.interval_s;
+    t.retry_interval_seconds = retryInterval;
+    t.max_check_interval_seconds = maxInterval ? maxInterval : s.interval_s;
+    t.failure_threshold = s.failure_threshold;
+    t.recovery_threshold = s.recovery_threshold;
+    t.parent_id = s.parent;
+    t.enabled = true;
+    compileMessageTemplates(i);
+    groupIndexUpdate(i);
+}
+
+// --- Measurements ---
+
+struct Transition {
+    int target;
+    bool online;             // Direction of the confirmed change
+    uint32_t scripted_ms;    // When the stand-in changed behaviour (harness time)
+    uint32_t detected_ms;    // End of the probe that confirmed the change
+    uint32_t notified_ms[CHANNEL_COUNT];  // First sink arrival per channel (0 = none)
+};
+
+struct Summary {
+    double mean, p50, p95, max;
+};
+
+static Summary summarize(std::vector<long> values) {
+    Summary s = {0, 0, 0, 0};
+    if (values.empty()) return s;
+    std::sort(values.begin(), values.end());
+    double total = 0;
+    for (size_t i = 0; i < values.size(); i++) total += values[i];
+    s.mean = total / values.size();
+    s.p50 = values[values.size() / 2];
+    s.p95 = values[(values.size() * 95) / 100 < values.size() ? (values.size() * 95) / 100 : values.size() - 1];
+    s.max = values.back();
+    return s;
+}
+
+// Most recent scripted health change towards `online` at or before ms
+static uint32_t scriptedChangeBefore(const StandIn& s, bool online, uint32_t ms) {
+    uint32_t found = 0;
+    bool healthy = true;  // Monitor assumes online at boot
+    for (size_t i = 0; i < s.phases.size() && s.phases[i].start_ms <= ms; i++) {
+        bool h = isHealthy(s.phases[i]);
+        if (h != healthy && h == online) found = s.phases[i].start_ms;
+        healthy = h;
+    }
+    return found;
+}
+
+// One full interval until the first probe sees the change, then fast retries
+static long nominalDetectMs(int i, uint8_t threshold) {
+    uint16_t interval = targets[i].check_interval_seconds;
+    uint16_t retry = targets[i].retry_interval_seconds;
+    if (retry == 0 || retry > interval) retry = interval;
+    return (interval + (long)(threshold > 0 ? threshold - 1 : 0) * retry) * 1000L;
+}
+
+static void usage(const char* argv0) {
+    fprintf(stderr,
+        "Usage: %s [--scenario FILE] [--targets N] [--interval SECONDS] [--duration SECONDS]\n"
+        "          [--retry-interval SECONDS] [--max-interval SECONDS]\n"
+        "          [--sink-latency-ms MS] [--output FILE] [--verbose]\n"
+        "  --scenario FILE      scripted targets (default: built-in mix of steady, slow,\n"
+        "                       outage, flapping, reset and hanging targets)\n"
+        "  --targets N          targets in the built-in scenario (default: all %d slots)\n"
+        "  --interval SECONDS   check interval for the built-in scenario (default 10)\n"
+        "  --retry-interval SECONDS  re-probe interval while a change is unconfirmed\n"
+        "                       (default %u, 0 = check interval)\n"
+        "  --max-interval SECONDS    back-off ceiling for stable targets (default: none)\n"
+        "  --duration SECONDS   run time (default 180)\n"
+        "  --sink-latency-ms MS delay before the notification sink answers (default 0)\n"
+        "  --output FILE        also write the report as JSON\n"
+        "  --verbose            show the monitor log\n", argv0, NUM_TARGETS, (unsigned)DEFAULT_RETRY_INTERVAL);
+}
+
+int main(int argc, char** argv) {
+    const char* scenarioPath = nullptr;
+    const char* outputPath = nullptr;
+    int targetCount = NUM_TARGETS;
+    uint16_t interval = 10;
+    uint32_t durationSec = 180;
+    bool verbose = false;
+
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "--scenario") == 0 && i + 1 < argc) scenarioPath = argv[++i];
+        else if (strcmp(argv[i], "--targets") == 0 && i + 1 < argc) targetCount = atoi(argv[++i]);
+        else if (strcmp(argv[i], "--interval") == 0 && i + 1 < argc) interval = atoi(argv[++i]);
+        else if (strcmp(argv[i], "--retry-interval") == 0 && i + 1 < argc) retryInterval = atoi(argv[++i]);
+        else if (strcmp(argv[i], "--max-interval") == 0 && i + 1 < argc) maxInterval = atoi(argv[++i]);
+        else if (strcmp(argv[i], "--duration") == 0 && i + 1 < argc) durationSec = atol(argv[++i]);
+        else if (strcmp(argv[i], "--sink-latency-ms") == 0 && i + 1 < argc) sinkLatencyMs = atol(argv[++i]);
+        else if (strcmp(argv[i], "--output") == 0 && i + 1 < argc) outputPath = argv[++i];
+        else if (strcmp(argv[i], "--verbose") == 0) verbose = true;
+        else {
+            usage(argv[0]);
+            return 2;
+        }
+    }
+
+    std::vector<std::unique_ptr<StandIn> > standIns;
+    if (scenarioPath) {
+        if (!loadScenario(scenarioPath, standIns)) return 1;
+    } else {
+        buildDefaultScenario(std::min(std::max(targetCount, 1), NUM_TARGETS), interval, standIns);
+    }
+    if (standIns.empty() || (int)standIns.size() > NUM_TARGETS) {
+        fprintf(stderr, "Scenario needs 1..%d targets, got %d\n", NUM_TARGETS, (int)standIns.size());
+        return 1;
+    }
+
+    signal(SIGINT, handleSignal);
+    signal(SIGTERM, handleSignal);
+    hal_posix_set_console_enabled(verbose);
+
+    if (!sink.start(serveSink)) {
+        fprintf(stderr, "Cannot start notification sink\n");
+        return 1;
+    }
+    char telegramBase[64];
+    snprintf(telegramBase, sizeof(telegramBase), "http://127.0.0.1:%u/telegram", sink.port());
+    telegramApiBase = telegramBase;
+
+    for (size_t i = 0; i < standIns.size(); i++) {
+        StandIn* s = standIns[i].get();
+        if (!s->server.start([s](int fd, const LocalHttpRequest&) { serveStandIn(s, fd); })) {
+            fprintf(stderr, "Cannot start stand-in server for %s\n", s->name.c_str());
+            return 1;
+        }
+        configureTarget(i, *s);
+    }
+    for (int i = standIns.size(); i < NUM_TARGETS; i++) targets[i].enabled = false;
+
+    fprintf(stderr, "Load test: %d targets for %us (notification sink on port %u)\n",
+        (int)standIns.size(), (unsigned)durationSec, sink.port());
+
+    // Drive the same loop as the firmware and observe the shared state
+    harnessStart = hal_millis();
+    std::vector<unsigned long> lastStart(NUM_TARGETS, 0);
+    std::vector<long> dueAfterMs(NUM_TARGETS, 0);  // Longest interval in force since the previous check
+    std::vector<bool> lastConfirmed(confirmed_online_state, confirmed_online_state + NUM_TARGETS);
+    std::vector<long> lagMs, loopMs;
+    std::map<int, int> codeCounts;
+    std::vector<Transition> transitions;
+    long checks = 0;
+
+    while (running && hal_millis() - harnessStart < durationSec * 1000UL) {
+        for (size_t i = 0; i < standIns.size(); i++) {
+            dueAfterMs[i] = std::max(dueAfterMs[i], effectiveCheckInterval(i) * 1000L);
+        }
+        uint32_t loopStart = hal_millis();
+        monitorLoop();
+        loopMs.push_back(hal_millis() - loopStart);
+
+        for (size_t i = 0; i < standIns.size(); i++) {
+            if (last_check_time[i] != lastStart[i]) {
+                checks++;
+                codeCounts[httpCode[i]]++;
+                if (lastStart[i] != 0) {
+                    long actual = (long)(last_check_time[i] - lastStart[i]);
+                    lagMs.push_back(std::max(actual - dueAfterMs[i], 0L));
+                }
+                lastStart[i] = last_check_time[i];
+                dueAfterMs[i] = effectiveCheckInterval(i) * 1000L;
+            }
+            if (confirmed_online_state[i] != lastConfirmed[i]) {
+                Transition t;
+                t.target = i;
+                t.online = confirmed_online_state[i];
+                t.detected_ms = last_check_time[i] + pingTime[i] - harnessStart;
+                t.scripted_ms = scriptedChangeBefore(*standIns[i], t.online, t.detected_ms);
+                memset(t.notified_ms, 0, sizeof(t.notified_ms));
+                transitions.push_back(t);
+                lastConfirmed[i] = confirmed_online_state[i];
+            }
+        }
+        hal_delay(100);  // Same pacing as the firmware loop()
+    }
+    uint32_t elapsedMs = hal_millis() - harnessStart;
+
+    for (size_t i = 0; i < standIns.size(); i++) standIns[i]->server.stop();
+    sink.stop();
+
+    // Attribute each sink arrival to the latest transition detected before it
+    for (size_t r = 0; r < sinkRecords.size(); r++) {
+        const SinkRecord& rec = sinkRecords[r];
+        uint32_t at = rec.received_ms - harnessStart;
+        Transition* match = nullptr;
+        for (size_t t = 0; t < transitions.size(); t++) {
+            if (transitions[t].target == rec.target && transitions[t].detected_ms <= at + 1) match = &transitions[t];
+        }
+        if (match && match->notified_ms[rec.channel] == 0) match->notified_ms[rec.channel] = at;
+    }
+
+    // --- Report ---
+    Summary lag = summarize(lagMs);
+    Summary loop = summarize(loopMs);
+    double checksPerSec = elapsedMs ? checks * 1000.0 / elapsedMs : 0;
+
+    printf("Checks: %ld in %.1fs (%.2f checks/s)\n", checks, elapsedMs / 1000.0, checksPerSec);
+    printf("Results:");
+    for (std::map<int, int>::const_iterator it = codeCounts.begin(); it != codeCounts.end(); ++it) {
+        printf(" %d=%d", it->first, it->second);
+    }
+    printf("\nScheduling lag vs effective interval (ms): mean %.0f  p50 %.0f  p95 %.0f  max %.0f\n",
+        lag.mean, lag.p50, lag.p95, lag.max);
+    printf("monitorLoop() duration (ms): mean %.1f  p50 %.0f  p95 %.0f  max %.0f\n",
+        loop.mean, loop.p50, loop.p95, loop.max);
+
+    printf("\n%-16s %-8s %9s %10s %12s", "target", "change", "at (s)", "detect ms", "nominal ms");
+    for (int c = 0; c < CHANNEL_COUNT; c++) printf(" %10s", CHANNEL_NAMES[c]);
+    printf("\n");
+    for (size_t t = 0; t < transitions.size(); t++) {
+        const Transition& tr = transitions[t];
+        const StandIn& s = *standIns[tr.target];
+        long nominal = nominalDetectMs(tr.target, tr.online ? s.recovery_threshold : s.failure_threshold);
+        printf("%-16s %-8s %9.1f %10ld %12ld", s.name.c_str(), tr.online ? "online" : "offline",
+            tr.scripted_ms / 1000.0, (long)(tr.detected_ms - tr.scripted_ms), nominal);
+        for (int c = 0; c < CHANNEL_COUNT; c++) {
+            if (tr.notified_ms[c]) printf(" %+10ld", (long)(tr.notified_ms[c] - tr.detected_ms));
+            else printf(" %10s", "-");
+        }
+        printf("\n");
+    }
+    printf("(detect ms: scripted change to confirming probe; channel columns: ms from detection to sink arrival)\n");
+
+    if (outputPath) {
+        FILE* out = fopen(outputPath, "w");
+        if (!out) {
+            fprintf(stderr, "Cannot write %s\n", outputPath);
+            return 1;
+        }
+        fprintf(out, "{\"targets\":%d,\"duration_ms\":%u,\"checks\":%ld,\"checks_per_second\":%.3f,\n",
+            (int)standIns.size(), (unsigned)elapsedMs, checks, checksPerSec);
+        fprintf(out, " \"scheduling_lag_ms\":{\"mean\":%.1f,\"p50\":%.0f,\"p95\":%.0f,\"max\":%.0f},\n",
+            lag.mean, lag.p50, lag.p95, lag.max);
+        fprintf(out, " \"loop_ms\":{\"mean\":%.1f,\"p50\":%.0f,\"p95\":%.0f,\"max\":%.0f},\n",
+            loop.mean, loop.p50, loop.p95, loop.max);
+        fprintf(out, " \"result_codes\":{");
+        for (std::map<int, int>::const_iterator it = codeCounts.begin(); it != codeCounts.end(); ++it) {
+            fprintf(out, "%s\"%d\":%d", it == codeCounts.begin() ? "" : ",", it->first, it->second);
+        }
+        fprintf(out, "},\n \"transitions\":[");
+        for (size_t t = 0; t < transitions.size(); t++) {
+            const Transition& tr = transitions[t];
+            const StandIn& s = *standIns[tr.target];
+            uint8_t threshold = tr.online ? s.recovery_threshold : s.failure_threshold;
+            fprintf(out, "%s\n  {\"target\":\"%s\",\"online\":%s,\"scripted_ms\":%u,\"detected_ms\":%u,"
+                "\"interval_s\":%u,\"threshold\":%u,\"nominal_ms\":%ld,\"notify_delay_ms\":{",
+                t ? "," : "", s.name.c_str(), tr.online ? "true" : "false", (unsigned)tr.scripted_ms,
+                (unsigned)tr.detected_ms, (unsigned)s.interval_s, (unsigned)threshold,
+                nominalDetectMs(tr.target, threshold));
+            bool first = true;
+            for (int c = 0; c < CHANNEL_COUNT; c++) {
+                if (!tr.notified_ms[c]) continue;
+                fprintf(out, "%s\"%s\":%ld", first ? "" : ",", CHANNEL_NAMES[c], (long)(tr.notified_ms[c] - tr.detected_ms));
+                first = false;
+            }
+            fprintf(out, "}}");
+        }
+        fprintf(out, "\n]}\n");
+        fclose(out);
+    }
+    return 0;
+}
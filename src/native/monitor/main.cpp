@@ -0,0 +1,296 @@
+// Host-native build of the uptime monitor: runs the same scheduler, state
+// machine and notification code as the firmware against POSIX sockets.
+//
+//   pio run -e native && .pio/build/native/program --config config.json --duration 60
+
+#include <signal.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <string>
+
+#include <ArduinoJson.h>
+
+#include "../hal/hal_posix.h"
+#include "alert_queue.h"
+#include "api_encoding.h"
+#include "diagnostics.h"
+#include "federation.h"
+#include "latency.h"
+#include "metrics_push.h"
+#include "monitor_config.h"
+#include "monitor_hal.h"
+#include "ota_pull.h"
+#include "scheduler.h"
+#include "status_api.h"
+#include "status_snapshot.h"
+#include "target_bulk.h"
+#include "uptime_stats.h"
+#include "web_log.h"
+
+static volatile sig_atomic_t running = 1;
+
+static void handleSignal(int) {
+    running = 0;
+}
+
+static void usage(const char* argv0) {
+    fprintf(stderr,
+        "Usage: %s [--config FILE] [--import FILE] [--duration SECONDS] [--print-status [--status-query QUERY]]\n"
+        "          [--print-diagnostics] [--print-latency] [--print-export] [--print-groups]\n"
+        "          [--node-id N [--federation-port PORT] [--peer HOST:PORT]... [--quorum Q]] [--uplink-down]\n"
+        "          [--print-federation] [--print-metrics-push] [--print-alert-queue]\n"
+        "          [--ota MANIFEST_URL [--ota-max-kbps N]] [--print-ota]\n"
+        "  --config FILE      config.json to load (same format as /config.json on the device)\n"
+        "  --import FILE      apply a /api/targets/batch body, fed in 536-byte segments\n"
+        "  --duration SECONDS stop after this many seconds (default: run until SIGINT)\n"
+        "  --print-status     print the /api/status JSON on exit\n"
+        "  --status-query Q   /api/status query string, e.g. 'state=down&fields=config.server_name'\n"
+        "  --status-format F  json (default), cbor or msgpack; binary formats are written raw\n"
+        "  --print-diagnostics print the /api/diagnostics JSON on exit\n"
+        "  --print-latency    print the /api/latency JSON (with buckets) on exit\n"
+        "  --print-export     print the /api/targets/export stream on exit\n"
+        "  --print-groups     print the /api/groups/summary JSON on exit\n"
+        "  --node-id N        join a federation as node N (overrides the config's \"federation\" object)\n"
+        "  --federation-port P UDP port to listen on (default 4210)\n"
+        "  --peer HOST:PORT   another node (repeat for each, up to 4)\n"
+        "  --quorum Q         vantage points that must see a target down (default: majority)\n"
+        "  --uplink-down      fail every outgoing HTTP request, as if this host's uplink were broken\n"
+        "  --print-federation print the /api/federation JSON on exit\n"
+        "  --print-metrics-push print the /api/metrics/push JSON on exit\n"
+        "  --print-alert-queue print the /api/alerts/queue JSON on exit\n"
+        "  --ota MANIFEST_URL pull, verify and \"install\" firmware as POST /api/ota would; stops at the restart\n"
+        "  --ota-max-kbps N   download rate limit for --ota (default: none)\n"
+        "  --print-ota        print the /api/ota JSON on exit\n", argv0);
+}
+
+// Feed a batch file through the same incremental parser as the web handler
+static bool importBatch(const char* path) {
+    FILE* f = fopen(path, "rb");
+    if (!f) return false;
+    static TargetBatch batch;
+    batchBegin(batch);
+    char segment[536];  // Typical TCP MSS, so operations straddle chunks
+    size_t n;
+    while ((n = fread(segment, 1, sizeof(segment), f)) > 0) batchFeed(batch, segment, n);
+    fclose(f);
+
+    batchFinish(batch);
+    if (batch.applied > 0) saveConfig();
+    DynamicJsonDocument doc(1024 + 16 * NUM_TARGETS);
+    buildBatchResultJson(batch, doc.to<JsonObject>());
+    std::string out;
+    serializeJson(doc, out);
+    fprintf(stderr, "%s\n", out.c_str());
+    return true;
+}
+
+struct StdoutWriter {
+    size_t write(uint8_t c) { return fwrite(&c, 1, 1, stdout); }
+    size_t write(const uint8_t* s, size_t n) { return fwrite(s, 1, n, stdout); }
+};
+
+// Split "group=A&state=down" into the /api/status parameters (no URL
+// decoding). Pieces are cut in place, so query must stay alive.
+static const char* statusFilterFromQuery(StatusFilter& filter, char* query) {
+    const char* params[4] = {nullptr, nullptr, nullptr, nullptr};
+    static const char* const NAMES[4] = {"group", "state", "ids", "fields"};
+    for (char* item = strtok(query, "&"); item; item = strtok(nullptr, "&")) {
+        char* value = strchr(item, '=');
+        if (!value) return "Malformed query";
+        *value++ = '\0';
+        for (int k = 0; k < 4; k++) {
+            if (strcmp(item, NAMES[k]) == 0) params[k] = value;
+        }
+    }
+    return parseStatusFilter(filter, params[0], params[1], params[2], params[3]);
+}
+
+int main(int argc, char** argv) {
+    const char* configPath = nullptr;
+    long durationSec = 0;
+    bool printStatus = false;
+    char* statusQuery = nullptr;
+    ApiFormat statusFormat = API_FORMAT_JSON;
+    bool printDiagnostics = false;
+    bool printLatency = false;
+    bool printExport = false;
+    bool printGroups = false;
+    bool printFederation = false;
+    bool printMetricsPush = false;
+    bool printAlertQueue = false;
+    bool printOta = false;
+    const char* otaManifest = nullptr;
+    int otaMaxKbps = 0;
+    const char* importPath = nullptr;
+    int nodeId = -1;
+    int federationPort = FEDERATION_DEFAULT_PORT;
+    int quorum = 0;
+    const char* peerList[FEDERATION_MAX_PEERS];
+    int peerCount = 0;
+
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "--config") == 0 && i + 1 < argc) configPath = argv[++i];
+        else if (strcmp(argv[i], "--import") == 0 && i + 1 < argc) importPath = argv[++i];
+        else if (strcmp(argv[i], "--duration") == 0 && i + 1 < argc) durationSec = atol(argv[++i]);
+        else if (strcmp(argv[i], "--print-status") == 0) printStatus = true;
+        else if (strcmp(argv[i], "--status-query") == 0 && i + 1 < argc) statusQuery = argv[++i];
+        else if (strcmp(argv[i], "--status-format") == 0 && i + 1 < argc) statusFormat = negotiateApiFormat(nullptr, argv[++i]);
+        else if (strcmp(argv[i], "--print-diagnostics") == 0) printDiagnostics = true;
+        else if (strcmp(argv[i], "--print-latency") == 0) printLatency = true;
+        else if (strcmp(argv[i], "--print-export") == 0) printExport = true;
+        else if (strcmp(argv[i], "--print-groups") == 0) printGroups = true;
+        else if (strcmp(argv[i], "--node-id") == 0 && i + 1 < argc) nodeId = atoi(argv[++i]);
+        else if (strcmp(argv[i], "--federation-port") == 0 && i + 1 < argc) federationPort = atoi(argv[++i]);
+        else if (strcmp(argv[i], "--peer") == 0 && i + 1 < argc && peerCount < FEDERATION_MAX_PEERS) peerList[peerCount++] = argv[++i];
+        else if (strcmp(argv[i], "--quorum") == 0 && i + 1 < argc) quorum = atoi(argv[++i]);
+        else if (strcmp(argv[i], "--uplink-down") == 0) hal_posix_set_uplink_down(true);
+        else if (strcmp(argv[i], "--print-federation") == 0) printFederation = true;
+        else if (strcmp(argv[i], "--print-metrics-push") == 0) printMetricsPush = true;
+        else if (strcmp(argv[i], "--print-alert-queue") == 0) printAlertQueue = true;
+        else if (strcmp(argv[i], "--ota") == 0 && i + 1 < argc) otaManifest = argv[++i];
+        else if (strcmp(argv[i], "--ota-max-kbps") == 0 && i + 1 < argc) otaMaxKbps = atoi(argv[++i]);
+        else if (strcmp(argv[i], "--print-ota") == 0) printOta = true;
+        else {
+            usage(argv[0]);
+            return 2;
+        }
+    }
+
+    StatusFilter statusFilter;
+    statusFilterAll(statusFilter);
+    const char* filterError = statusQuery ? statusFilterFromQuery(statusFilter, statusQuery) : nullptr;
+    if (filterError) {
+        fprintf(stderr, "--status-query: %s\n", filterError);
+        return 2;
+    }
+
+    signal(SIGINT, handleSignal);
+    signal(SIGTERM, handleSignal);
+
+    web_log_printf("Booting native monitor...");
+    if (configPath && !hal_posix_fs_import("/config.json", configPath)) {
+        fprintf(stderr, "Cannot read %s\n", configPath);
+        return 1;
+    }
+    loadConfig();
+    if (importPath && !importBatch(importPath)) {
+        fprintf(stderr, "Cannot read %s\n", importPath);
+        return 1;
+    }
+    loadUptimeStats();
+    metricsPushBegin();
+    alertQueueBegin();
+    hal_configure_time(gmtOffset_sec, ntpServer);
+    webLogSetUtcOffset(gmtOffset_sec);
+
+    // Federation flags go through the same validation as POST /api/federation
+    if (nodeId >= 0) {
+        DynamicJsonDocument doc(1024);
+        doc["node_id"] = nodeId;
+        doc["port"] = federationPort;
+        if (quorum > 0) doc["quorum"] = quorum;
+        JsonArray peersJson = doc.createNestedArray("peers");
+        for (int p = 0; p < peerCount; p++) peersJson.add(peerList[p]);
+        const char* error = setFederationFromJson(doc.as<JsonObjectConst>());
+        if (error) {
+            fprintf(stderr, "Federation: %s\n", error);
+            return 2;
+        }
+    }
+    federationBegin();
+
+    if (otaManifest) {
+        DynamicJsonDocument doc(512);
+        doc["manifest"] = otaManifest;
+        doc["max_kbps"] = otaMaxKbps;
+        const char* error = startOtaFromJson(doc.as<JsonObjectConst>());
+        if (error) {
+            fprintf(stderr, "OTA: %s\n", error);
+            return 2;
+        }
+    }
+
+    uint32_t start = hal_millis();
+    while (running && !hal_posix_restart_requested() &&
+           (durationSec == 0 || hal_millis() - start < durationSec * 1000UL)) {
+        monitorLoop();
+        hal_delay(100);  // Same pacing as the firmware loop()
+    }
+    webLogFlush();
+
+    if (printStatus && statusFormat != API_FORMAT_JSON && !statusQuery) {
+        // Same bytes the firmware serves to unfiltered polls
+        std::shared_ptr<const StatusSnapshot> snapshot = statusSnapshot(statusFormat);
+        fwrite(snapshot->data, 1, snapshot->length, stdout);
+    } else if (printStatus) {
+        DynamicJsonDocument doc(statusJsonCapacity(statusFilter));
+        buildStatusJson(doc.to<JsonObject>(), statusFilter);
+        if (statusFormat == API_FORMAT_JSON) {
+            std::string out;
+            serializeJsonPretty(doc, out);
+            puts(out.c_str());
+        } else {
+            StdoutWriter writer;
+            serializeApiDocument(doc.as<JsonVariantConst>(), statusFormat, writer);
+        }
+    }
+    if (printDiagnostics) {
+        DynamicJsonDocument doc(8192);
+        buildDiagnosticsJson(doc.to<JsonObject>());
+        std::string out;
+        serializeJsonPretty(doc, out);
+        puts(out.c_str());
+    }
+    if (printLatency) {
+        DynamicJsonDocument doc(latencyJsonCapacity(true));
+        buildLatencyJson(doc.to<JsonObject>(), true);
+        std::string out;
+        serializeJson(doc, out);
+        puts(out.c_str());
+    }
+    if (printExport) {
+        TargetExportCursor cursor;
+        exportBegin(cursor);
+        uint8_t chunk[256];
+        size_t n;
+        while ((n = writeTargetExportChunk(cursor, chunk, sizeof(chunk))) > 0) fwrite(chunk, 1, n, stdout);
+        putchar('\n');
+    }
+    if (printFederation) {
+        DynamicJsonDocument doc(FEDERATION_JSON_CAPACITY);
+        buildFederationJson(doc.to<JsonObject>());
+        std::string out;
+        serializeJsonPretty(doc, out);
+        puts(out.c_str());
+    }
+    if (printMetricsPush) {
+        DynamicJsonDocument doc(1024);
+        buildMetricsPushJson(doc.to<JsonObject>());
+        std::string out;
+        serializeJsonPretty(doc, out);
+        puts(out.c_str());
+    }
+    if (printAlertQueue) {
+        DynamicJsonDocument doc(ALERT_QUEUE_JSON_CAPACITY);
+        buildAlertQueueJson(doc.to<JsonObject>());
+        std::string out;
+        serializeJsonPretty(doc, out);
+        puts(out.c_str());
+    }
+    if (printOta) {
+        DynamicJsonDocument doc(1024);
+        buildOtaJson(doc.to<JsonObject>());
+        std::string out;
+        serializeJsonPretty(doc, out);
+        puts(out.c_str());
+    }
+    if (printGroups) {
+        DynamicJsonDocument doc(GROUPS_SUMMARY_JSON_CAPACITY);
+        buildGroupsSummaryJson(doc.to<JsonObject>());
+        std::string out;
+        serializeJsonPretty(doc, out);
+        puts(out.c_str());
+    }
+    return 0;
+}
@@ -0,0 +1,59 @@
+// Alert queue: changes reach /alerts.q in one write per save delay, and the
+// file still restores the queue.
+//
+//   pio test -e native_test -f test_alert_queue
+
+#include <unity.h>
+
+#include "../../src/native/hal/hal_posix.h"
+#include "alert_queue.h"
+#include "monitor_config.h"
+#include "monitor_hal.h"
+#include "notifications.h"
+#include "text_util.h"
+
+static const uint8_t ALL_CHANNELS = (1 << ALERT_CHANNEL_COUNT) - 1;
+
+void setUp() {
+    TargetConfig& t = targets[0];
+    safeStrcpy(t.weburl, "http://10.9.8.7/health", sizeof(t.weburl));
+    safeStrcpy(t.server_name, "Test", sizeof(t.server_name));
+    t.enabled = true;
+    compileMessageTemplates(0);
+    hal_posix_set_network_connected(false);  // Nothing is replayed
+    alertQueueClear();
+}
+
+void tearDown() {
+    alertQueueClear();
+}
+
+static void test_changes_are_saved_after_the_delay() {
+    alertQueuePush(0, ALERT_OFFLINE, ALL_CHANNELS, ALERT_QUEUE_BACK_OFF);
+    alertQueuePush(0, ALERT_DEGRADED, ALL_CHANNELS, ALERT_QUEUE_BACK_OFF);
+    alertQueuePoll();
+    TEST_ASSERT_FALSE(hal_fs_exists("/alerts.q"));
+
+    hal_posix_advance_clock(ALERT_QUEUE_SAVE_DELAY_MS);
+    alertQueuePoll();
+    TEST_ASSERT_TRUE(hal_fs_exists("/alerts.q"));
+
+    // What a reboot would pick up
+    alertQueueBegin();
+    TEST_ASSERT_EQUAL(2, alertQueuePending());
+}
+
+static void test_flush_writes_at_once() {
+    alertQueuePush(0, ALERT_OFFLINE, ALL_CHANNELS, ALERT_QUEUE_BACK_OFF);
+    TEST_ASSERT_FALSE(hal_fs_exists("/alerts.q"));
+    alertQueueFlush();
+    TEST_ASSERT_TRUE(hal_fs_exists("/alerts.q"));
+}
+
+int main(int argc, char** argv) {
+    hal_posix_set_console_enabled(false);
+    UNITY_BEGIN();
+    RUN_TEST(test_changes_are_saved_after_the_delay);
+    RUN_TEST(test_flush_writes_at_once);
+    return UNITY_END();
+}
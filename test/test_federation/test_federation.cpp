@@ -0,0 +1,177 @@
+// Federation: configuration changes are applied by the loop task, the quorum
+// falls back to the vantage points still alive, and only configured peers
+// are heard.
+//
+//   pio test -e native_test -f test_federation
+
+#include <string.h>
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+#include <ArduinoJson.h>
+#include <unity.h>
+
+#include "../../src/native/hal/hal_posix.h"
+#include "federation.h"
+#include "monitor_config.h"
+#include "monitor_state.h"
+#include "text_util.h"
+#include "web_log.h"
+
+static const uint16_t TEST_PORT = 47310;
+
+static const char* setConfig(uint8_t nodeId, uint8_t quorum) {
+    DynamicJsonDocument doc(512);
+    doc["node_id"] = nodeId;
+    doc["port"] = TEST_PORT;
+    doc["quorum"] = quorum;
+    JsonArray peers = doc.createNestedArray("peers");
+    peers.add("127.0.0.1:47311");  // Node 2
+    peers.add("127.0.0.1:47312");  // Node 3
+    return setFederationFromJson(doc.as<JsonObjectConst>());
+}
+
+static const char* TARGET_URL = "http://10.9.8.7/health";
+
+// A full snapshot with one vote (2 = down, 1 = up) for TARGET_URL, sent
+// from fromPort (configured peers send from 47310 + node id)
+static void sendSnapshotFrom(uint16_t fromPort, uint8_t nodeId, uint8_t vote) {
+    uint32_t key = hashString(TARGET_URL);
+    uint8_t packet[13] = {'U', 'M', 'F', '1', nodeId, 1, 0, 1,
+        (uint8_t)(key >> 24), (uint8_t)(key >> 16), (uint8_t)(key >> 8), (uint8_t)key, vote};
+    int fd = socket(AF_INET, SOCK_DGRAM, 0);
+    struct sockaddr_in from;
+    memset(&from, 0, sizeof(from));
+    from.sin_family = AF_INET;
+    from.sin_port = htons(fromPort);
+    from.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    int reuse = 1;
+    setsockopt(fd, SOL_SOCKET, SO_REUSEADDR, &reuse, sizeof(reuse));
+    bind(fd, (struct sockaddr*)&from, sizeof(from));
+    struct sockaddr_in to;
+    memset(&to, 0, sizeof(to));
+    to.sin_family = AF_INET;
+    to.sin_port = htons(TEST_PORT);
+    to.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    sendto(fd, packet, sizeof(packet), 0, (struct sockaddr*)&to, sizeof(to));
+    close(fd);
+    usleep(10000);
+}
+
+static void sendPeerSnapshot(uint8_t nodeId, uint8_t vote) {
+    sendSnapshotFrom(TEST_PORT + nodeId - 1, nodeId, vote);
+}
+
+static void clearLog() {
+    webLogFlush();
+    serialLogBuffer[0] = '\0';
+    serialLogBufferPos = 0;
+}
+
+// Logged since the last clearLog()
+static bool logged(const char* text) {
+    webLogFlush();
+    return strstr(serialLogBuffer, text) != nullptr;
+}
+
+void setUp() {
+    TargetConfig& t = targets[0];
+    safeStrcpy(t.weburl, TARGET_URL, sizeof(t.weburl));
+    safeStrcpy(t.server_name, "Test", sizeof(t.server_name));
+    t.enabled = true;
+    t.failure_threshold = 1;
+    t.recovery_threshold = 1;
+    t.check_interval_seconds = 60;
+    t.parent_id = -1;
+    confirmed_online_state[0] = true;
+    local_down[0] = false;
+}
+
+void tearDown() {
+    setConfig(0, 1);
+    federationPoll();
+}
+
+// The API handler only stages the change; the next poll applies it
+static void test_config_applied_by_poll() {
+    TEST_ASSERT_NULL(setConfig(1, 2));
+    TEST_ASSERT_EQUAL(0, federation.node_id);
+
+    // Saving in the handler already stores the staged configuration
+    TEST_ASSERT_TRUE(federationConfigured());
+    DynamicJsonDocument saved(512);
+    federationConfigToJson(saved.to<JsonObject>());
+    TEST_ASSERT_EQUAL(1, saved["node_id"].as<int>());
+
+    // One hand-over at a time
+    TEST_ASSERT_NOT_NULL(setConfig(3, 2));
+
+    federationPoll();
+    TEST_ASSERT_EQUAL(1, federation.node_id);
+    TEST_ASSERT_EQUAL(2, federation.quorum);
+    TEST_ASSERT_NULL(setConfig(0, 1));
+}
+
+// Two of three nodes go silent: the survivor's own verdict confirms the
+// outage, and the quorum comes back with the peers
+static void test_quorum_falls_back_to_alive_peers() {
+    TEST_ASSERT_NULL(setConfig(1, 2));
+    federationPoll();
+    sendPeerSnapshot(2, 1);
+    sendPeerSnapshot(3, 1);
+    federationPoll();
+
+    // Outvoted while both peers see the target up
+    processCheckResult(0, -1, 5);
+    TEST_ASSERT_TRUE(local_down[0]);
+    TEST_ASSERT_TRUE(confirmed_online_state[0]);
+
+    clearLog();
+    hal_posix_advance_clock(FEDERATION_PEER_TIMEOUT_MS + 1000);
+    federationPoll();
+    TEST_ASSERT_FALSE(confirmed_online_state[0]);
+    TEST_ASSERT_TRUE(logged("quorum lowered from 2 to 1"));
+
+    // A peer returns and still sees the target up: two votes are needed again
+    clearLog();
+    sendPeerSnapshot(2, 1);
+    federationPoll();
+    TEST_ASSERT_TRUE(logged("Quorum back to 2"));
+    TEST_ASSERT_TRUE(confirmed_online_state[0]);
+
+    // and its down vote confirms the outage again
+    sendPeerSnapshot(2, 2);
+    federationPoll();
+    TEST_ASSERT_FALSE(confirmed_online_state[0]);
+}
+
+// A sender that is not a configured peer neither votes nor becomes the
+// notifier, whatever node id it claims
+static void test_unconfigured_sender_rejected() {
+    TEST_ASSERT_NULL(setConfig(2, 1));
+    federationPoll();
+    DynamicJsonDocument before(4096);
+    buildFederationJson(before.to<JsonObject>());
+
+    sendSnapshotFrom(47319, 1, 2);
+    federationPoll();
+    TEST_ASSERT_EQUAL(2, federationNotifier());
+    TEST_ASSERT_TRUE(federationIsNotifier());
+
+    DynamicJsonDocument after(4096);
+    buildFederationJson(after.to<JsonObject>());
+    TEST_ASSERT_EQUAL(before["packets"]["rejected"].as<int>() + 1, after["packets"]["rejected"].as<int>());
+    TEST_ASSERT_EQUAL(0, after["packets"]["received"].as<int>() - before["packets"]["received"].as<int>());
+    TEST_ASSERT_EQUAL(1, after["vantage_points"].as<int>());
+}
+
+int main(int argc, char** argv) {
+    hal_posix_set_console_enabled(false);
+    UNITY_BEGIN();
+    RUN_TEST(test_config_applied_by_poll);
+    RUN_TEST(test_quorum_falls_back_to_alive_peers);
+    RUN_TEST(test_unconfigured_sender_rejected);
+    return UNITY_END();
+}
@@ -0,0 +1,97 @@
+// Latency degraded state: a sustained regression stays degraded instead of
+// being learned as the new normal, a real recovery still clears it, and the
+// slow/normal check counts can differ from the outage thresholds.
+//
+//   pio test -e native_test -f test_latency
+
+#include <string.h>
+
+#include <ArduinoJson.h>
+#include <unity.h>
+
+#include "../../src/native/hal/hal_posix.h"
+#include "alert_queue.h"
+#include "latency_baseline.h"
+#include "monitor_config.h"
+#include "monitor_state.h"
+#include "notifications.h"
+#include "text_util.h"
+
+// Queued alerts of the given kind (the network is down, so all are queued)
+static int queued(const char* kind) {
+    DynamicJsonDocument doc(16384);
+    buildAlertQueueJson(doc.to<JsonObject>());
+    int n = 0;
+    for (JsonObjectConst alert : doc["alerts"].as<JsonArrayConst>()) {
+        if (strcmp(alert["kind"] | "", kind) == 0) n++;
+    }
+    return n;
+}
+
+static void check(int times, unsigned long ms) {
+    for (int k = 0; k < times; k++) processCheckResult(0, 200, ms + k % 3);
+}
+
+void setUp() {
+    TargetConfig& t = targets[0];
+    safeStrcpy(t.weburl, "http://10.9.8.7/health", sizeof(t.weburl));
+    safeStrcpy(t.server_name, "Test", sizeof(t.server_name));
+    safeStrcpy(t.ntfy_url, "http://10.9.8.7/alerts", sizeof(t.ntfy_url));
+    t.enabled = true;
+    t.failure_threshold = 2;
+    t.recovery_threshold = 2;
+    t.parent_id = -1;
+    t.latency_threshold_ms = 0;
+    t.latency_deviations = 4;
+    t.latency_slow_checks = 0;
+    t.latency_recovery_checks = 0;
+    compileMessageTemplates(0);
+    hal_posix_set_network_connected(false);
+    confirmed_online_state[0] = true;
+    resetLatencyState(0);
+    alertQueueClear();
+    check(LATENCY_WARMUP_SAMPLES + 10, 80);
+}
+
+void tearDown() {
+    alertQueueClear();
+}
+
+static void test_sustained_regression_stays_degraded() {
+    check(300, 400);
+    TEST_ASSERT_TRUE(degraded[0]);
+    TEST_ASSERT_EQUAL(1, queued("degraded"));
+    TEST_ASSERT_EQUAL(0, queued("latency_ok"));
+    TEST_ASSERT_NULL(strstr(targetLogMessages[0], "normal;"));
+    TEST_ASSERT_TRUE(latencyBaselines[0].mean_ms < 100);
+}
+
+static void test_recovery_clears_degraded() {
+    check(50, 400);
+    TEST_ASSERT_TRUE(degraded[0]);
+    check(2, 80);
+    TEST_ASSERT_FALSE(degraded[0]);
+    TEST_ASSERT_EQUAL(1, queued("latency_ok"));
+}
+
+static void test_own_check_counts() {
+    targets[0].latency_slow_checks = 5;
+    targets[0].latency_recovery_checks = 3;
+    check(4, 400);
+    TEST_ASSERT_FALSE(degraded[0]);
+    check(1, 400);
+    TEST_ASSERT_TRUE(degraded[0]);
+    check(2, 80);
+    TEST_ASSERT_TRUE(degraded[0]);
+    check(1, 80);
+    TEST_ASSERT_FALSE(degraded[0]);
+}
+
+int main(int argc, char** argv) {
+    hal_posix_set_console_enabled(false);
+    UNITY_BEGIN();
+    RUN_TEST(test_sustained_regression_stays_degraded);
+    RUN_TEST(test_recovery_clears_degraded);
+    RUN_TEST(test_own_check_counts);
+    return UNITY_END();
+}
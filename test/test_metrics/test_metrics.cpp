@@ -0,0 +1,130 @@
+// /metrics chunked writer: every slot is scraped to the end, and a line split
+// across chunks is never stitched from two renderings.
+//
+//   pio test -e native_test -f test_metrics
+
+#include <stdio.h>
+#include <string.h>
+
+#include <string>
+
+#include <unity.h>
+
+#include "../../src/native/hal/hal_posix.h"
+#include "metrics.h"
+#include "monitor_config.h"
+#include "monitor_state.h"
+
+static void populateTargets() {
+    for (int i = 0; i < NUM_TARGETS; i++) {
+        TargetConfig& t = targets[i];
+        snprintf(t.server_name, sizeof(t.server_name), "Server \"%d\"", i + 1);
+        snprintf(t.group_name, sizeof(t.group_name), "Group %d", i % 8);
+        t.enabled = i % 5 != 4;
+        httpCode[i] = 200;
+        pingTime[i] = 40 + i % 200;
+    }
+}
+
+// Scrape in chunks of chunkSize; between chunks mutate() may change state
+static std::string scrape(size_t chunkSize, void (*mutate)(int chunk), int* chunks) {
+    MetricsCursor cursor;
+    metricsBegin(cursor);
+    std::string out;
+    uint8_t buf[2048];
+    size_t n;
+    int calls = 0;
+    while ((n = writeMetricsChunk(cursor, buf, chunkSize)) > 0) {
+        out.append((const char*)buf, n);
+        if (mutate) mutate(calls);
+        // Far more calls than any scrape needs: the writer is stuck
+        if (++calls > 200000) break;
+    }
+    if (chunks) *chunks = calls;
+    return out;
+}
+
+static int countLines(const std::string& text, const char* prefix) {
+    int count = 0;
+    size_t len = strlen(prefix);
+    for (size_t pos = 0; pos < text.size();) {
+        size_t end = text.find('\n', pos);
+        if (end == std::string::npos) break;
+        if (text.compare(pos, len, prefix) == 0) count++;
+        pos = end + 1;
+    }
+    return count;
+}
+
+void setUp() {
+    populateTargets();
+}
+
+void tearDown() {}
+
+static void test_scrape_reaches_every_slot() {
+    int chunks = 0;
+    std::string out = scrape(1436, nullptr, &chunks);
+    TEST_ASSERT_TRUE(chunks < 200000);
+    TEST_ASSERT_TRUE(out.size() > 0 && out[out.size() - 1] == '\n');
+
+    int enabled = 0, lastEnabled = 0;
+    for (int i = 0; i < NUM_TARGETS; i++) {
+        enabled += targets[i].enabled;
+        if (targets[i].enabled) lastEnabled = i;
+    }
+    TEST_ASSERT_EQUAL(enabled, countLines(out, "uptime_monitor_target_up{"));
+    char last[64];
+    snprintf(last, sizeof(last), "uptime_monitor_target_up{id=\"%d\"", lastEnabled);
+    TEST_ASSERT_TRUE(out.find(last) != std::string::npos);
+    TEST_ASSERT_EQUAL(1, countLines(out, "uptime_monitor_probes_coalesced_total "));
+}
+
+// Chunks that hold whole lines end on a line boundary
+static void test_chunks_end_on_line_boundaries() {
+    MetricsCursor cursor;
+    metricsBegin(cursor);
+    uint8_t buf[512];
+    size_t n;
+    while ((n = writeMetricsChunk(cursor, buf, sizeof(buf))) > 0) {
+        TEST_ASSERT_EQUAL('\n', buf[n - 1]);
+    }
+}
+
+// Same output whatever the chunk size, including chunks shorter than a line
+static void test_output_independent_of_chunk_size() {
+    std::string reference = scrape(1436, nullptr, nullptr);
+    TEST_ASSERT_TRUE(scrape(97, nullptr, nullptr) == reference);
+    TEST_ASSERT_TRUE(scrape(7, nullptr, nullptr) == reference);
+}
+
+static void flipCodes(int chunk) {
+    for (int i = 0; i < NUM_TARGETS; i++) httpCode[i] = (chunk % 2) ? 200 : -11;
+    targets[chunk % NUM_TARGETS].enabled = false;
+}
+
+// State changing between chunks shorter than a line: each sample still
+// carries one value and ends in a newline
+static void test_split_lines_are_not_rerendered() {
+    std::string out = scrape(16, flipCodes, nullptr);
+    const char* family = "uptime_monitor_target_http_code{";
+    for (size_t pos = 0; pos < out.size();) {
+        size_t end = out.find('\n', pos);
+        TEST_ASSERT_TRUE(end != std::string::npos);
+        std::string line = out.substr(pos, end - pos);
+        pos = end + 1;
+        if (line.compare(0, strlen(family), family) != 0) continue;
+        std::string value = line.substr(line.rfind("} ") + 2);
+        TEST_ASSERT_TRUE_MESSAGE(value == "200" || value == "-11", line.c_str());
+    }
+}
+
+int main(int argc, char** argv) {
+    hal_posix_set_console_enabled(false);
+    UNITY_BEGIN();
+    RUN_TEST(test_scrape_reaches_every_slot);
+    RUN_TEST(test_chunks_end_on_line_boundaries);
+    RUN_TEST(test_output_independent_of_chunk_size);
+    RUN_TEST(test_split_lines_are_not_rerendered);
+    return UNITY_END();
+}
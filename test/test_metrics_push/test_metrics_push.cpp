@@ -0,0 +1,82 @@
+// Metrics push: configuration changes are applied by the loop task, and the
+// backlog is bounded by its byte budget rather than by its segment count.
+//
+//   pio test -e native_test -f test_metrics_push
+
+#include <string.h>
+
+#include <ArduinoJson.h>
+#include <unity.h>
+
+#include "../../src/native/hal/hal_posix.h"
+#include "metrics_push.h"
+#include "monitor_hal.h"
+#include "monitor_state.h"
+
+static const char* setConfig(const char* url) {
+    DynamicJsonDocument doc(512);
+    doc["url"] = url;
+    doc["authorization"] = "Token abc";
+    doc["interval"] = 10;
+    doc["batch_size"] = 20;
+    return setMetricsPushFromJson(doc.as<JsonObjectConst>());
+}
+
+void setUp() {
+    hal_posix_set_network_connected(false);  // Nothing is posted
+}
+
+void tearDown() {
+    setConfig("0");
+    metricsPushPoll();
+    metricsPushClearBacklog();
+}
+
+// The API handler only stages the change; the next poll applies it
+static void test_config_applied_by_poll() {
+    TEST_ASSERT_NULL(setConfig("http://10.9.8.7:8086/write"));
+    TEST_ASSERT_EQUAL_STRING("0", metricsPush.url);
+
+    // Saving in the handler already stores the staged configuration
+    TEST_ASSERT_TRUE(metricsPushConfigured());
+    DynamicJsonDocument saved(512);
+    metricsPushConfigToJson(saved.to<JsonObject>());
+    TEST_ASSERT_EQUAL_STRING("http://10.9.8.7:8086/write", saved["url"].as<const char*>());
+
+    // One hand-over at a time
+    TEST_ASSERT_NOT_NULL(setConfig("http://10.9.8.8:8086/write"));
+
+    metricsPushPoll();
+    TEST_ASSERT_EQUAL_STRING("http://10.9.8.7:8086/write", metricsPush.url);
+    TEST_ASSERT_EQUAL_STRING("Token abc", metricsPush.authorization);
+    TEST_ASSERT_NULL(setConfig("0"));
+}
+
+// Batches far smaller than a segment share one, so the backlog fills its
+// whole byte budget instead of stopping at one batch per segment
+static void test_backlog_bounded_by_bytes() {
+    TEST_ASSERT_NULL(setConfig("http://10.9.8.7:8086/write"));
+    metricsPushPoll();
+    httpCode[0] = 200;
+    pingTime[0] = 42;
+    for (int batch = 0; batch < 400; batch++) {
+        for (int k = 0; k < 20; k++) metricsPushRecord(0);
+        metricsPushPoll();
+    }
+    DynamicJsonDocument doc(1024);
+    buildMetricsPushJson(doc.to<JsonObject>());
+    JsonObjectConst backlog = doc["backlog"];
+    uint32_t bytes = backlog["bytes"];
+    TEST_ASSERT_TRUE(bytes <= METRICS_PUSH_BACKLOG_MAX_BYTES);
+    TEST_ASSERT_TRUE(bytes > METRICS_PUSH_BACKLOG_MAX_BYTES - 2 * METRICS_PUSH_SEGMENT_BYTES);
+    TEST_ASSERT_TRUE(backlog["segments"].as<int>() <= METRICS_PUSH_BACKLOG_SEGMENTS);
+    TEST_ASSERT_EQUAL(400, doc["counters"]["batches_spilled"].as<int>());
+}
+
+int main(int argc, char** argv) {
+    hal_posix_set_console_enabled(false);
+    UNITY_BEGIN();
+    RUN_TEST(test_config_applied_by_poll);
+    RUN_TEST(test_backlog_bounded_by_bytes);
+    return UNITY_END();
+}